@@ -0,0 +1,43 @@
+//
+// AssetLoader.cpp - Background asset loading with dependency-aware handles
+//
+
+#include "AssetLoader.h"
+
+void AssetStateBase::Wait() const {
+    if (GetStatus() != Status::Pending)
+        return;
+
+    std::unique_lock lock(m_Mutex);
+    m_Completed.wait(lock, [this] { return GetStatus() != Status::Pending; });
+}
+
+void AssetStateBase::OnComplete(std::function<void()> continuation) {
+    {
+        std::lock_guard lock(m_Mutex);
+        if (GetStatus() == Status::Pending) {
+            m_Continuations.push_back(std::move(continuation));
+            return;
+        }
+    }
+    continuation();
+}
+
+void AssetStateBase::RethrowIfFailed() const {
+    if (GetStatus() == Status::Failed)
+        std::rethrow_exception(m_Error);
+}
+
+void AssetStateBase::Complete(const Status status, std::exception_ptr error) {
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Error = std::move(error);
+        m_Status.store(status, std::memory_order_release);
+        continuations.swap(m_Continuations);
+    }
+    m_Completed.notify_all();
+
+    for (auto& continuation : continuations)
+        continuation();
+}
@@ -0,0 +1,147 @@
+//
+// AssetLoader.h - Background asset loading with dependency-aware handles
+//
+
+#pragma once
+
+#include "JobSystem.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// Completion state shared between an AssetHandle and the job producing it.
+class AssetStateBase {
+public:
+    enum class Status : uint8_t { Pending, Ready, Failed };
+
+    Status GetStatus() const noexcept {
+        return m_Status.load(std::memory_order_acquire);
+    }
+
+    /// Blocks until the asset is ready or has failed.
+    void Wait() const;
+
+    /// Runs `continuation` once the asset completes, immediately if it already has. It may run
+    /// on a worker thread.
+    void OnComplete(std::function<void()> continuation);
+
+    /// Rethrows the load error if the asset failed.
+    void RethrowIfFailed() const;
+
+protected:
+    void Complete(Status status, std::exception_ptr error);
+
+private:
+    std::atomic<Status> m_Status {Status::Pending};
+    mutable std::mutex m_Mutex;
+    mutable std::condition_variable m_Completed;
+    std::vector<std::function<void()>> m_Continuations;
+    std::exception_ptr m_Error;
+};
+
+template<typename T>
+class AssetState final : public AssetStateBase {
+public:
+    void Resolve(T value) {
+        m_Value.emplace(std::move(value));
+        Complete(Status::Ready, nullptr);
+    }
+
+    void Reject(std::exception_ptr error) {
+        Complete(Status::Failed, std::move(error));
+    }
+
+    const T& GetValue() const {
+        Wait();
+        RethrowIfFailed();
+        return *m_Value;
+    }
+
+private:
+    std::optional<T> m_Value;
+};
+
+/// Shared reference to an asset that becomes ready later. Cheap to copy.
+template<typename T>
+class AssetHandle {
+public:
+    AssetHandle() = default;
+    explicit AssetHandle(std::shared_ptr<AssetState<T>> state) noexcept
+        : m_pState(std::move(state)) {}
+
+    bool IsValid() const noexcept {
+        return m_pState != nullptr;
+    }
+    bool IsReady() const noexcept {
+        return m_pState && m_pState->GetStatus() == AssetStateBase::Status::Ready;
+    }
+    bool HasFailed() const noexcept {
+        return m_pState && m_pState->GetStatus() == AssetStateBase::Status::Failed;
+    }
+    /// Ready or failed.
+    bool IsComplete() const noexcept {
+        return m_pState && m_pState->GetStatus() != AssetStateBase::Status::Pending;
+    }
+
+    /// Blocks until the asset completes; rethrows its load error if it failed.
+    const T& Get() const {
+        return m_pState->GetValue();
+    }
+
+    const std::shared_ptr<AssetState<T>>& GetState() const noexcept {
+        return m_pState;
+    }
+
+    void Reset() noexcept {
+        m_pState.reset();
+    }
+
+private:
+    std::shared_ptr<AssetState<T>> m_pState;
+};
+
+/// Schedules load functions on a JobSystem. A load that depends on other handles starts only
+/// after all of them are ready, receiving their values as arguments; if any dependency fails,
+/// the load fails with the same error without running.
+class AssetLoader {
+public:
+    explicit AssetLoader(JobSystem& jobs) noexcept : m_pJobs(&jobs) {}
+
+    template<typename TLoad, typename... TDeps>
+    auto Load(TLoad load, const AssetHandle<TDeps>&... deps) {
+        using T = std::decay_t<std::invoke_result_t<TLoad&, const TDeps&...>>;
+
+        auto state = std::make_shared<AssetState<T>>();
+        auto run   = std::make_shared<std::function<void()>>([state, load, deps...]() mutable {
+            try {
+                state->Resolve(load(deps.Get()...));
+            } catch (...) {
+                state->Reject(std::current_exception());
+            }
+        });
+
+        if constexpr (sizeof...(TDeps) == 0) {
+            m_pJobs->Submit([run] { (*run)(); });
+        } else {
+            auto pending = std::make_shared<std::atomic<size_t>>(sizeof...(TDeps));
+            auto onReady = [jobs = m_pJobs, pending, run] {
+                if (pending->fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    jobs->Submit([run] { (*run)(); });
+            };
+            (deps.GetState()->OnComplete(onReady), ...);
+        }
+
+        return AssetHandle<T>(std::move(state));
+    }
+
+private:
+    JobSystem* m_pJobs;
+};
@@ -0,0 +1,236 @@
+//
+// AssetPack.cpp - Single-file asset archive with a memory-mapped reader
+//
+
+#include "AssetPack.h"
+#include "Hash.h"
+#include "Lz.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+static_assert(std::endian::native == std::endian::little,
+              "Pack files are little-endian and read in place");
+
+namespace {
+    uint64_t AlignUp(const uint64_t value) noexcept {
+        return (value + kPackAlignment - 1) & ~(kPackAlignment - 1);
+    }
+
+    std::vector<std::byte> ReadFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            throw std::runtime_error("Failed to open " + path.string());
+
+        std::vector<std::byte> bytes(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(bytes.data()),
+                  static_cast<std::streamsize>(bytes.size()));
+        if (!file)
+            throw std::runtime_error("Failed to read " + path.string());
+        return bytes;
+    }
+}  // namespace
+
+void AssetPack::Open(const std::filesystem::path& path) {
+    Close();
+    m_File.Open(path);
+
+    const auto data = m_File.GetData();
+    if (data.size() < sizeof(PackHeader)) {
+        Close();
+        throw std::runtime_error("Asset pack is truncated: " + path.string());
+    }
+
+    PackHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    const uint64_t tocEnd = header.tocOffset + uint64_t {header.entryCount} * sizeof(PackEntry);
+    if (std::memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) != 0 ||
+        header.version != kPackVersion || header.fileSize != data.size() ||
+        header.tocOffset % kPackAlignment != 0 || tocEnd > header.namesOffset ||
+        header.namesOffset > data.size()) {
+        Close();
+        throw std::runtime_error("Invalid asset pack: " + path.string());
+    }
+
+    m_Entries = {reinterpret_cast<const PackEntry*>(data.data() + header.tocOffset),
+                 header.entryCount};
+
+    uint64_t namesEnd = header.namesOffset;
+    for (const auto& entry : m_Entries) {
+        namesEnd = std::max(namesEnd, header.namesOffset + entry.nameOffset + entry.nameLength);
+        if (entry.offset + entry.storedSize > data.size()) {
+            Close();
+            throw std::runtime_error("Asset pack entry out of bounds: " + path.string());
+        }
+    }
+    if (namesEnd > data.size()) {
+        Close();
+        throw std::runtime_error("Asset pack names out of bounds: " + path.string());
+    }
+
+    m_Names = {reinterpret_cast<const char*>(data.data() + header.namesOffset),
+               static_cast<size_t>(namesEnd - header.namesOffset)};
+}
+
+void AssetPack::Close() noexcept {
+    m_Entries = {};
+    m_Names   = {};
+    m_File.Close();
+}
+
+const PackEntry* AssetPack::Find(const std::string_view name) const noexcept {
+    const uint64_t hash = Hash::Fnv1a(name);
+
+    auto it = std::lower_bound(
+      m_Entries.begin(), m_Entries.end(), hash, [](const PackEntry& entry, const uint64_t h) {
+          return entry.nameHash < h;
+      });
+
+    for (; it != m_Entries.end() && it->nameHash == hash; ++it) {
+        if (GetName(*it) == name)
+            return &*it;
+    }
+    return nullptr;
+}
+
+std::span<const std::byte> AssetPack::View(const std::string_view name) const {
+    const PackEntry* entry = Find(name);
+    if (!entry)
+        return {};
+    if (entry->flags & kPackEntryCompressed)
+        throw std::logic_error("Asset pack entry is compressed and cannot be viewed in place");
+    return GetStoredBytes(*entry);
+}
+
+std::vector<std::byte> AssetPack::Read(const std::string_view name) const {
+    const PackEntry* entry = Find(name);
+    if (!entry)
+        throw std::runtime_error("Asset not found in pack: " + std::string(name));
+    return Read(*entry);
+}
+
+std::vector<std::byte> AssetPack::Read(const PackEntry& entry) const {
+    const auto stored = GetStoredBytes(entry);
+    if (!(entry.flags & kPackEntryCompressed))
+        return {stored.begin(), stored.end()};
+
+    std::vector<std::byte> bytes(static_cast<size_t>(entry.size));
+    if (!Lz::Decompress(stored, bytes))
+        throw std::runtime_error("Corrupt asset pack entry: " + std::string(GetName(entry)));
+    return bytes;
+}
+
+std::span<const std::byte> AssetPack::Load(const std::string_view name,
+                                           std::vector<std::byte>& scratch) const {
+    const PackEntry* entry = Find(name);
+    if (!entry)
+        throw std::runtime_error("Asset not found in pack: " + std::string(name));
+    if (!(entry->flags & kPackEntryCompressed))
+        return GetStoredBytes(*entry);
+
+    scratch = Read(*entry);
+    return scratch;
+}
+
+bool AssetPack::Verify(const PackEntry& entry) const {
+    if (!(entry.flags & kPackEntryCompressed))
+        return Hash::Fnv1a(GetStoredBytes(entry)) == entry.contentHash;
+
+    std::vector<std::byte> bytes(static_cast<size_t>(entry.size));
+    return Lz::Decompress(GetStoredBytes(entry), bytes) &&
+           Hash::Fnv1a(bytes) == entry.contentHash;
+}
+
+std::string_view AssetPack::GetName(const PackEntry& entry) const noexcept {
+    return m_Names.substr(entry.nameOffset, entry.nameLength);
+}
+
+std::span<const std::byte> AssetPack::GetStoredBytes(const PackEntry& entry) const noexcept {
+    return m_File.GetData().subspan(static_cast<size_t>(entry.offset),
+                                    static_cast<size_t>(entry.storedSize));
+}
+
+void WriteAssetPack(const std::filesystem::path& output,
+                    const std::span<const PackSource> sources) {
+    struct Pending {
+        std::string name;
+        std::vector<std::byte> stored;
+        PackEntry entry;
+    };
+
+    std::vector<Pending> pending;
+    pending.reserve(sources.size());
+
+    std::string names;
+    for (const auto& source : sources) {
+        auto& item = pending.emplace_back();
+        item.name  = source.path.filename().generic_string();
+        auto bytes = ReadFile(source.path);
+
+        item.entry             = {};
+        item.entry.nameHash    = Hash::Fnv1a(item.name);
+        item.entry.contentHash = Hash::Fnv1a(bytes);
+        item.entry.size        = bytes.size();
+        item.entry.nameOffset  = static_cast<uint32_t>(names.size());
+        item.entry.nameLength  = static_cast<uint16_t>(item.name.size());
+        names += item.name;
+
+        if (source.allowCompression && !bytes.empty()) {
+            std::vector<std::byte> packed(Lz::CompressBound(bytes.size()));
+            packed.resize(Lz::Compress(bytes, packed));
+            if (packed.size() <= bytes.size() - bytes.size() / 8) {
+                bytes = std::move(packed);
+                item.entry.flags |= kPackEntryCompressed;
+            }
+        }
+        item.entry.storedSize = bytes.size();
+        item.stored           = std::move(bytes);
+    }
+
+    std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+        return a.entry.nameHash < b.entry.nameHash;
+    });
+    for (size_t i = 1; i < pending.size(); ++i) {
+        if (pending[i].name == pending[i - 1].name)
+            throw std::invalid_argument("Duplicate asset name in pack: " + pending[i].name);
+    }
+
+    PackHeader header = {};
+    std::memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+    header.version     = kPackVersion;
+    header.entryCount  = static_cast<uint32_t>(pending.size());
+    header.tocOffset   = AlignUp(sizeof(PackHeader));
+    header.namesOffset = header.tocOffset + pending.size() * sizeof(PackEntry);
+
+    uint64_t offset = AlignUp(header.namesOffset + names.size());
+    for (auto& item : pending) {
+        item.entry.offset = offset;
+        offset            = AlignUp(offset + item.entry.storedSize);
+    }
+    header.fileSize = header.namesOffset + names.size();
+    if (!pending.empty())
+        header.fileSize = pending.back().entry.offset + pending.back().entry.storedSize;
+
+    std::vector<std::byte> image(static_cast<size_t>(header.fileSize));
+    std::memcpy(image.data(), &header, sizeof(header));
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const auto& item = pending[i];
+        std::memcpy(image.data() + header.tocOffset + i * sizeof(PackEntry),
+                    &item.entry,
+                    sizeof(PackEntry));
+        std::memcpy(image.data() + item.entry.offset, item.stored.data(), item.stored.size());
+    }
+    std::memcpy(image.data() + header.namesOffset, names.data(), names.size());
+
+    std::ofstream file(output, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(image.data()),
+               static_cast<std::streamsize>(image.size()));
+    if (!file)
+        throw std::runtime_error("Failed to write " + output.string());
+}
@@ -0,0 +1,104 @@
+//
+// AssetPack.h - Single-file asset archive with a memory-mapped reader
+//
+// Layout (all integers little-endian):
+//   PackHeader
+//   PackEntry[entryCount]        table of contents, sorted by name hash, kPackAlignment aligned
+//   char[]                       entry names, not null-terminated
+//   entry data                   each payload starts on a kPackAlignment boundary
+//
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+inline constexpr char kPackMagic[8]      = {'P', 'O', 'N', 'G', 'P', 'A', 'K', '\0'};
+inline constexpr uint32_t kPackVersion   = 1;
+inline constexpr uint64_t kPackAlignment = 64;
+
+enum PackEntryFlags : uint16_t {
+    kPackEntryCompressed = 0x1,
+};
+
+struct PackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint64_t tocOffset;
+    uint64_t namesOffset;
+    uint64_t fileSize;
+    uint64_t reserved;
+};
+static_assert(sizeof(PackHeader) == 48);
+
+struct PackEntry {
+    uint64_t nameHash;
+    uint64_t contentHash;  // FNV-1a of the uncompressed bytes
+    uint64_t offset;
+    uint64_t storedSize;
+    uint64_t size;
+    uint32_t nameOffset;
+    uint16_t nameLength;
+    uint16_t flags;
+};
+static_assert(sizeof(PackEntry) == 48);
+
+/// Read-only view over a mapped pack file. Uncompressed entries are handed out as spans straight
+/// into the mapping, so they stay valid until the pack is closed.
+class AssetPack {
+public:
+    /// Throws std::runtime_error if the file is missing or not a valid pack.
+    void Open(const std::filesystem::path& path);
+    void Close() noexcept;
+
+    bool IsOpen() const noexcept {
+        return m_File.IsOpen();
+    }
+
+    /// Returns nullptr if there is no entry with this name.
+    const PackEntry* Find(std::string_view name) const noexcept;
+
+    /// Zero-copy access to an uncompressed entry. Returns an empty span if the entry is missing
+    /// and throws std::logic_error if it is compressed.
+    std::span<const std::byte> View(std::string_view name) const;
+
+    /// Copies (and decompresses if needed) an entry. Throws std::runtime_error if it is missing or
+    /// corrupt.
+    std::vector<std::byte> Read(std::string_view name) const;
+    std::vector<std::byte> Read(const PackEntry& entry) const;
+
+    /// Returns the entry's bytes, viewing the mapping in place when the entry is stored
+    /// uncompressed and decompressing into `scratch` otherwise. Throws std::runtime_error if the
+    /// entry is missing or corrupt.
+    std::span<const std::byte> Load(std::string_view name, std::vector<std::byte>& scratch) const;
+
+    /// Re-hashes the entry payload and compares it against the stored content hash.
+    bool Verify(const PackEntry& entry) const;
+
+    std::string_view GetName(const PackEntry& entry) const noexcept;
+    std::span<const std::byte> GetStoredBytes(const PackEntry& entry) const noexcept;
+
+    std::span<const PackEntry> GetEntries() const noexcept {
+        return m_Entries;
+    }
+
+private:
+    MappedFile m_File;
+    std::span<const PackEntry> m_Entries;
+    std::string_view m_Names;
+};
+
+struct PackSource {
+    std::filesystem::path path;
+    bool allowCompression = true;
+};
+
+/// Writes a pack containing each source file, named by its file name. Entries that allow
+/// compression are stored compressed only if that saves at least an eighth of their size.
+void WriteAssetPack(const std::filesystem::path& output, std::span<const PackSource> sources);
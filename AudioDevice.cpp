@@ -0,0 +1,94 @@
+//
+// AudioDevice.cpp - WASAPI shared-mode output fed from an AudioRing
+//
+
+#include "pch.h"
+#include "AudioDevice.h"
+#include "AudioMixer.h"
+
+namespace {
+    // The device's buffer, in 100 ns units; the ring and mixer block sit on top of it
+    constexpr REFERENCE_TIME kBufferDuration = 200'000;
+}  // namespace
+
+AudioDevice::AudioDevice(AudioRing& ring, AudioThread& mixerThread, const uint32_t sampleRate)
+    : m_Ring(ring), m_MixerThread(mixerThread) {
+    ComPtr<IMMDeviceEnumerator> pEnumerator;
+    DX::ThrowIfFailed(::CoCreateInstance(
+      __uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, IID_PPV_ARGS(&pEnumerator)));
+    ComPtr<IMMDevice> pDevice;
+    DX::ThrowIfFailed(pEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &pDevice));
+    DX::ThrowIfFailed(pDevice->Activate(__uuidof(IAudioClient),
+                                        CLSCTX_ALL,
+                                        nullptr,
+                                        reinterpret_cast<void**>(m_pClient.GetAddressOf())));
+
+    WAVEFORMATEX format    = {};
+    format.wFormatTag      = WAVE_FORMAT_IEEE_FLOAT;
+    format.nChannels       = AudioMixer::kChannels;
+    format.nSamplesPerSec  = sampleRate;
+    format.wBitsPerSample  = 32;
+    format.nBlockAlign     = format.nChannels * sizeof(float);
+    format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+    DX::ThrowIfFailed(m_pClient->Initialize(AUDCLNT_SHAREMODE_SHARED,
+                                            AUDCLNT_STREAMFLAGS_EVENTCALLBACK |
+                                              AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM |
+                                              AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY,
+                                            kBufferDuration,
+                                            0,
+                                            &format,
+                                            nullptr));
+
+    m_Event = ::CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!m_Event)
+        throw std::system_error(static_cast<int>(::GetLastError()), std::system_category());
+    DX::ThrowIfFailed(m_pClient->SetEventHandle(m_Event));
+    DX::ThrowIfFailed(m_pClient->GetBufferSize(&m_BufferFrames));
+    DX::ThrowIfFailed(m_pClient->GetService(IID_PPV_ARGS(&m_pRenderClient)));
+
+    m_Thread = std::thread(&AudioDevice::Run, this);
+    DX::ThrowIfFailed(m_pClient->Start());
+}
+
+AudioDevice::~AudioDevice() {
+    m_Stopping.store(true, std::memory_order_relaxed);
+    if (m_Thread.joinable()) {
+        ::SetEvent(m_Event);
+        m_Thread.join();
+    }
+    if (m_pClient)
+        m_pClient->Stop();
+    if (m_Event)
+        ::CloseHandle(m_Event);
+}
+
+void AudioDevice::Run() noexcept {
+    // The interfaces were created in the multithreaded apartment, which this thread joins
+    std::ignore = ::CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+    while (!m_Stopping.load(std::memory_order_relaxed)) {
+        if (::WaitForSingleObject(m_Event, 200) != WAIT_OBJECT_0)
+            continue;
+
+        UINT32 padding = 0;
+        if (FAILED(m_pClient->GetCurrentPadding(&padding)))
+            break;
+        const UINT32 frames = m_BufferFrames - padding;
+        BYTE* pData         = nullptr;
+        if (frames == 0 || FAILED(m_pRenderClient->GetBuffer(frames, &pData)))
+            continue;
+
+        const auto out       = reinterpret_cast<float*>(pData);
+        const uint32_t count = frames * AudioMixer::kChannels;
+        const uint32_t read  = m_Ring.Read(out, count);
+        if (read < count) {
+            std::fill(out + read, out + count, 0.f);
+            m_Underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_pRenderClient->ReleaseBuffer(frames, 0);
+        m_MixerThread.Wake();
+    }
+
+    ::CoUninitialize();
+}
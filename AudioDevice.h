@@ -0,0 +1,48 @@
+//
+// AudioDevice.h - WASAPI shared-mode output fed from an AudioRing
+//
+
+#pragma once
+
+#include "AudioRing.h"
+
+#include <audioclient.h>
+#include <mmdeviceapi.h>
+
+#include <atomic>
+#include <thread>
+
+class AudioThread;
+
+/// Plays interleaved stereo float from a ring on the default render endpoint. A thread woken by
+/// the device every period copies whatever the ring holds, pads any shortfall with silence, and
+/// wakes the mixer thread to refill the ring.
+class AudioDevice {
+public:
+    /// Starts playback, converting from `sampleRate` if the device runs at another rate. Throws
+    /// DX::com_exception if there is no usable device.
+    AudioDevice(AudioRing& ring, AudioThread& mixerThread, uint32_t sampleRate);
+    /// Stops playback and joins the thread.
+    ~AudioDevice();
+
+    AudioDevice(AudioDevice const&)            = delete;
+    AudioDevice& operator=(AudioDevice const&) = delete;
+
+    /// Device periods the ring could not fill.
+    uint32_t GetUnderrunCount() const noexcept {
+        return m_Underruns.load(std::memory_order_relaxed);
+    }
+
+private:
+    void Run() noexcept;
+
+    AudioRing& m_Ring;
+    AudioThread& m_MixerThread;
+    ComPtr<IAudioClient> m_pClient;
+    ComPtr<IAudioRenderClient> m_pRenderClient;
+    HANDLE m_Event        = nullptr;
+    UINT32 m_BufferFrames = 0;
+    std::atomic<bool> m_Stopping {false};
+    std::atomic<uint32_t> m_Underruns {0};
+    std::thread m_Thread;
+};
@@ -0,0 +1,254 @@
+//
+// AudioMixer.cpp - Software voice mixer fed by a lock-free command queue
+//
+
+#include "AudioMixer.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // Gain changes are spread over this long
+    constexpr float kRampSeconds = 0.005f;
+
+    constexpr float kFractionScale = 1.f / 4294967296.f;  // 32.32 fraction to float
+    constexpr float kQuarterPi     = 0.78539816f;
+
+    float GetFraction(const uint64_t position) noexcept {
+        return static_cast<float>(static_cast<uint32_t>(position)) * kFractionScale;
+    }
+
+    float Interpolate(const float* samples, const uint64_t position) noexcept {
+        const auto index = static_cast<size_t>(position >> 32);
+        return samples[index] + (samples[index + 1] - samples[index]) * GetFraction(position);
+    }
+}  // namespace
+
+AudioClip MakeClip(const uint32_t sampleRate, std::vector<float> samples) {
+    if (sampleRate == 0)
+        throw std::invalid_argument("Audio clips need a sample rate");
+    samples.push_back(0.f);
+    return {sampleRate, std::move(samples)};
+}
+
+AudioMixer::AudioMixer(const uint32_t sampleRate, const uint32_t maxVoices)
+    : m_SampleRate(sampleRate),
+      m_RampFrames(static_cast<uint32_t>(static_cast<float>(sampleRate) * kRampSeconds) + 1),
+      m_Voices(maxVoices) {
+    if (sampleRate == 0 || maxVoices == 0)
+        throw std::invalid_argument("The mixer needs a sample rate and at least one voice");
+}
+
+uint32_t AudioMixer::Play(const AudioClip& clip,
+                          const float volume,
+                          const float pitch,
+                          const float pan) {
+    // Ids wrap, skipping 0; by the time one repeats its old voice is long gone
+    uint32_t id = m_NextId++;
+    if (id == 0)
+        id = m_NextId++;
+    Post({AudioCommandType::Play, id, &clip, volume, pitch, pan});
+    return id;
+}
+
+void AudioMixer::Stop(const uint32_t voice) {
+    Post({AudioCommandType::Stop, voice, nullptr, 0.f, 1.f, 0.f});
+}
+
+void AudioMixer::SetVolume(const uint32_t voice, const float volume) {
+    Post({AudioCommandType::SetVolume, voice, nullptr, volume, 1.f, 0.f});
+}
+
+void AudioMixer::StopAll() {
+    Post({AudioCommandType::StopAll, 0, nullptr, 0.f, 1.f, 0.f});
+}
+
+void AudioMixer::Post(const AudioCommand& command) {
+    if (!m_Commands.TryPush(command))
+        m_DroppedCommands.fetch_add(1, std::memory_order_relaxed);
+}
+
+AudioMixer::Voice* AudioMixer::FindVoice(const uint32_t id) noexcept {
+    for (Voice& voice : m_Voices) {
+        if (voice.pClip && voice.id == id)
+            return &voice;
+    }
+    return nullptr;
+}
+
+void AudioMixer::Apply(const AudioCommand& command) noexcept {
+    switch (command.type) {
+        case AudioCommandType::Play: {
+            if (!command.pClip || command.pClip->GetLength() == 0)
+                return;
+
+            // A free voice, or else the one with the fewest frames left
+            Voice* pVoice       = nullptr;
+            uint64_t fewestLeft = UINT64_MAX;
+            for (Voice& voice : m_Voices) {
+                if (!voice.pClip) {
+                    pVoice = &voice;
+                    m_ActiveCount++;
+                    break;
+                }
+                const uint64_t left =
+                  ((uint64_t {voice.pClip->GetLength()} << 32) - voice.position) / voice.step;
+                if (left < fewestLeft) {
+                    fewestLeft = left;
+                    pVoice     = &voice;
+                }
+            }
+
+            const double step = static_cast<double>(std::max(command.pitch, 0.f)) *
+                                command.pClip->sampleRate / m_SampleRate * 4294967296.0;
+            const float angle = (std::clamp(command.pan, -1.f, 1.f) + 1.f) * kQuarterPi;
+
+            pVoice->pClip      = command.pClip;
+            pVoice->id         = command.voice;
+            pVoice->position   = 0;
+            pVoice->step       = std::max<uint64_t>(1, static_cast<uint64_t>(step));
+            pVoice->panLeft    = std::cos(angle);
+            pVoice->panRight   = std::sin(angle);
+            pVoice->gain       = 0.f;
+            pVoice->targetGain = std::max(command.volume, 0.f);
+            pVoice->stopping   = false;
+            break;
+        }
+        case AudioCommandType::Stop:
+            if (Voice* pVoice = FindVoice(command.voice)) {
+                pVoice->targetGain = 0.f;
+                pVoice->stopping   = true;
+            }
+            break;
+        case AudioCommandType::SetVolume:
+            if (Voice* pVoice = FindVoice(command.voice); pVoice && !pVoice->stopping)
+                pVoice->targetGain = std::max(command.volume, 0.f);
+            break;
+        case AudioCommandType::StopAll:
+            for (Voice& voice : m_Voices) {
+                voice.targetGain = 0.f;
+                voice.stopping   = true;
+            }
+            break;
+    }
+}
+
+void AudioMixer::Mix(float* out, const uint32_t frames) noexcept {
+    AudioCommand command;
+    while (m_Commands.TryPop(command))
+        Apply(command);
+
+    const size_t count = size_t {frames} * kChannels;
+    std::fill(out, out + count, 0.f);
+    for (Voice& voice : m_Voices) {
+        if (voice.pClip)
+            MixVoice(voice, out, frames);
+    }
+
+    // Hard limit whatever the voices add up to
+    size_t i = 0;
+#if PONG_SSE2
+    const __m128 lo = _mm_set1_ps(-1.f);
+    const __m128 hi = _mm_set1_ps(1.f);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(out + i), lo), hi));
+#endif
+    for (; i < count; ++i)
+        out[i] = std::clamp(out[i], -1.f, 1.f);
+}
+
+void AudioMixer::MixVoice(Voice& voice, float* out, const uint32_t frames) noexcept {
+    const float* samples = voice.pClip->samples.data();
+    const uint64_t end   = uint64_t {voice.pClip->GetLength()} << 32;
+
+    // Every frame mixed starts inside the clip, so Interpolate never reads past the guard sample
+    const uint64_t framesLeft = (end - voice.position + voice.step - 1) / voice.step;
+    const auto n              = static_cast<uint32_t>(std::min<uint64_t>(frames, framesLeft));
+
+    // The gain moves towards its target by at most `rampStep` a frame, and stays between where
+    // it starts and the target
+    const float target   = voice.targetGain;
+    const float rampStep = (target > voice.gain ? 1.f : -1.f) / static_cast<float>(m_RampFrames);
+    const float lowGain  = std::min(voice.gain, target);
+    const float highGain = std::max(voice.gain, target);
+    float gain           = voice.gain;
+    uint64_t position    = voice.position;
+
+    uint32_t i = 0;
+#if PONG_SSE2
+    const __m128 panLeft  = _mm_set1_ps(voice.panLeft);
+    const __m128 panRight = _mm_set1_ps(voice.panRight);
+    const __m128 ramp     = _mm_mul_ps(_mm_set1_ps(rampStep), _mm_setr_ps(1.f, 2.f, 3.f, 4.f));
+    const __m128 low      = _mm_set1_ps(lowGain);
+    const __m128 high     = _mm_set1_ps(highGain);
+    for (; i + 4 <= n; i += 4) {
+        // SSE2 has no gather, so the two samples either side of each position are loaded one
+        // frame at a time and everything after that is four frames wide
+        alignas(16) float a[4], b[4], fraction[4];
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            const auto index = static_cast<size_t>(position >> 32);
+            a[lane]          = samples[index];
+            b[lane]          = samples[index + 1];
+            fraction[lane]   = GetFraction(position);
+            position += voice.step;
+        }
+        const __m128 s0    = _mm_load_ps(a);
+        const __m128 delta = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(b), s0), _mm_load_ps(fraction));
+        const __m128 s     = _mm_add_ps(s0, delta);
+
+        const __m128 g = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_set1_ps(gain), ramp), low), high);
+        gain           = std::clamp(gain + 4.f * rampStep, lowGain, highGain);
+
+        const __m128 v     = _mm_mul_ps(s, g);
+        const __m128 left  = _mm_mul_ps(v, panLeft);
+        const __m128 right = _mm_mul_ps(v, panRight);
+        float* frame       = out + size_t {i} * kChannels;
+        _mm_storeu_ps(frame, _mm_add_ps(_mm_loadu_ps(frame), _mm_unpacklo_ps(left, right)));
+        _mm_storeu_ps(frame + 4,
+                      _mm_add_ps(_mm_loadu_ps(frame + 4), _mm_unpackhi_ps(left, right)));
+    }
+#endif
+    for (; i < n; ++i) {
+        gain          = std::clamp(gain + rampStep, lowGain, highGain);
+        const float v = Interpolate(samples, position) * gain;
+        float* frame  = out + size_t {i} * kChannels;
+        frame[0] += v * voice.panLeft;
+        frame[1] += v * voice.panRight;
+        position += voice.step;
+    }
+
+    voice.position = position;
+    voice.gain     = gain;
+    if (n < frames || (voice.stopping && gain == 0.f)) {
+        voice.pClip = nullptr;
+        m_ActiveCount--;
+    }
+}
+
+AudioThread::AudioThread(AudioMixer& mixer, AudioRing& ring, const uint32_t blockFrames)
+    : m_Mixer(mixer), m_Ring(ring), m_Block(size_t {blockFrames} * AudioMixer::kChannels) {
+    if (m_Block.empty() || m_Block.size() > ring.GetCapacity())
+        throw std::invalid_argument("The mix block must be non-empty and fit in the ring");
+    m_Thread = std::thread(&AudioThread::Run, this);
+}
+
+AudioThread::~AudioThread() {
+    m_Stopping.store(true, std::memory_order_relaxed);
+    Wake();
+    m_Thread.join();
+}
+
+void AudioThread::Run() noexcept {
+    const auto frames = static_cast<uint32_t>(m_Block.size() / AudioMixer::kChannels);
+    const auto size   = static_cast<uint32_t>(m_Block.size());
+    while (!m_Stopping.load(std::memory_order_relaxed)) {
+        while (m_Ring.GetWritable() >= size) {
+            m_Mixer.Mix(m_Block.data(), frames);
+            m_Ring.Write(m_Block.data(), size);
+        }
+        if (m_Wake.try_acquire_for(std::chrono::milliseconds(1)))
+            m_WakePending.store(false, std::memory_order_release);
+    }
+}
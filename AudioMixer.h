@@ -0,0 +1,143 @@
+//
+// AudioMixer.h - Software voice mixer fed by a lock-free command queue
+//
+// The game thread posts play, stop and volume commands; the mixer applies them at the start of
+// each block it mixes, on its own thread, so neither side ever waits for the other. Voices are
+// resampled from their clip's rate and pitch with linear interpolation and mixed four frames at
+// a time with SSE2. Every gain change, including starting and stopping, is ramped over a few
+// milliseconds so it does not click.
+//
+
+#pragma once
+
+#include "AudioRing.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+/// A mono sound. `samples` ends with a silent guard sample so interpolation can always read one
+/// sample ahead; build clips with MakeClip.
+struct AudioClip {
+    uint32_t sampleRate = 0;
+    std::vector<float> samples;
+
+    uint32_t GetLength() const noexcept {
+        return samples.empty() ? 0 : static_cast<uint32_t>(samples.size() - 1);
+    }
+};
+
+/// A clip of `samples` at `sampleRate`, with the guard sample appended.
+AudioClip MakeClip(uint32_t sampleRate, std::vector<float> samples);
+
+enum class AudioCommandType : uint8_t { Play, Stop, SetVolume, StopAll };
+
+struct AudioCommand {
+    AudioCommandType type;
+    uint32_t voice;
+    const AudioClip* pClip;
+    float volume;
+    float pitch;  // playback rate; 2 is an octave up
+    float pan;    // -1 (left) to 1 (right)
+};
+
+/// Output is interleaved stereo float at the mixer's sample rate.
+class AudioMixer {
+public:
+    static constexpr uint32_t kChannels = 2;
+
+    AudioMixer(uint32_t sampleRate, uint32_t maxVoices);
+
+    AudioMixer(AudioMixer const&)            = delete;
+    AudioMixer& operator=(AudioMixer const&) = delete;
+
+    // Producer side: one thread (the game's) posts commands. They fail only when the command
+    // queue is full, in which case Play returns 0 and the others do nothing.
+
+    /// Starts playing `clip`, which must outlive the voice. Returns an id for Stop and
+    /// SetVolume. When every voice is busy the one closest to its end is replaced.
+    uint32_t Play(const AudioClip& clip, float volume = 1.f, float pitch = 1.f, float pan = 0.f);
+    /// Fades a voice out. Ids of voices that have already finished are ignored.
+    void Stop(uint32_t voice);
+    void SetVolume(uint32_t voice, float volume);
+    void StopAll();
+
+    // Consumer side: one thread (the mixer's) calls these.
+
+    /// Applies the queued commands and mixes the next `frames` frames into `out`, overwriting it.
+    void Mix(float* out, uint32_t frames) noexcept;
+
+    uint32_t GetActiveVoiceCount() const noexcept {
+        return m_ActiveCount;
+    }
+
+    uint32_t GetSampleRate() const noexcept {
+        return m_SampleRate;
+    }
+
+    /// Commands dropped because the queue was full; readable from any thread.
+    uint32_t GetDroppedCommandCount() const noexcept {
+        return m_DroppedCommands.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Voice {
+        const AudioClip* pClip = nullptr;  // null when free
+        uint32_t id;
+        uint64_t position;  // in clip samples, 32.32 fixed point
+        uint64_t step;      // position advance per output frame
+        float panLeft, panRight;
+        float gain;        // current, ramping towards target
+        float targetGain;  // 0 with `stopping` set frees the voice once reached
+        bool stopping;
+    };
+
+    void Post(const AudioCommand& command);
+    void Apply(const AudioCommand& command) noexcept;
+    Voice* FindVoice(uint32_t id) noexcept;
+    void MixVoice(Voice& voice, float* out, uint32_t frames) noexcept;
+
+    uint32_t m_SampleRate;
+    uint32_t m_RampFrames;
+    std::vector<Voice> m_Voices;
+    uint32_t m_ActiveCount = 0;
+    uint32_t m_NextId      = 1;  // producer side
+    std::atomic<uint32_t> m_DroppedCommands {0};
+
+    SpscQueue<AudioCommand, 256> m_Commands;
+};
+
+/// Keeps an AudioRing topped up from a mixer on a dedicated thread. The ring's consumer calls
+/// Wake after reading so the thread can refill it straight away; otherwise it polls every
+/// millisecond or so.
+class AudioThread {
+public:
+    /// Mixes `blockFrames` frames at a time whenever the ring has room for a whole block.
+    AudioThread(AudioMixer& mixer, AudioRing& ring, uint32_t blockFrames);
+    /// Stops and joins the thread.
+    ~AudioThread();
+
+    AudioThread(AudioThread const&)            = delete;
+    AudioThread& operator=(AudioThread const&) = delete;
+
+    /// Consumer side: call after reading from the ring. Wakes before the thread runs again
+    /// collapse into one, keeping the semaphore's count within its maximum of 1.
+    void Wake() noexcept {
+        if (!m_WakePending.exchange(true, std::memory_order_acq_rel))
+            m_Wake.release();
+    }
+
+private:
+    void Run() noexcept;
+
+    AudioMixer& m_Mixer;
+    AudioRing& m_Ring;
+    std::vector<float> m_Block;
+    std::binary_semaphore m_Wake {0};
+    std::atomic<bool> m_WakePending {false};  // set while m_Wake holds a token
+    std::atomic<bool> m_Stopping {false};
+    std::thread m_Thread;
+};
@@ -0,0 +1,78 @@
+//
+// AudioRing.h - Lock-free single-producer single-consumer ring of audio samples
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+/// Carries mixed samples from the mixer thread to whatever plays or records them, in bulk. Like
+/// SpscQueue, the indices are free-running and live on separate cache lines, but reads and
+/// writes move as many samples as fit in one go.
+class AudioRing {
+public:
+    /// Capacity is in samples and must be a power of two.
+    explicit AudioRing(const uint32_t capacity)
+        : m_Capacity(capacity), m_pSamples(std::make_unique<float[]>(capacity)) {
+        if (!capacity || (capacity & (capacity - 1)))
+            throw std::invalid_argument("Audio ring capacity must be a power of two");
+    }
+
+    AudioRing(AudioRing const&)            = delete;
+    AudioRing& operator=(AudioRing const&) = delete;
+
+    /// Producer side. Copies as many samples as fit and returns how many.
+    uint32_t Write(const float* samples, const uint32_t count) noexcept {
+        const uint32_t tail = m_Tail.load(std::memory_order_relaxed);
+        const uint32_t head = m_Head.load(std::memory_order_acquire);
+        const uint32_t n    = std::min(count, m_Capacity - (tail - head));
+        const uint32_t mask = m_Capacity - 1;
+        const uint32_t run  = std::min(n, m_Capacity - (tail & mask));
+        std::memcpy(m_pSamples.get() + (tail & mask), samples, run * sizeof(float));
+        std::memcpy(m_pSamples.get(), samples + run, (n - run) * sizeof(float));
+        m_Tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Consumer side. Copies out as many samples as are available and returns how many.
+    uint32_t Read(float* samples, const uint32_t count) noexcept {
+        const uint32_t head = m_Head.load(std::memory_order_relaxed);
+        const uint32_t tail = m_Tail.load(std::memory_order_acquire);
+        const uint32_t n    = std::min(count, tail - head);
+        const uint32_t mask = m_Capacity - 1;
+        const uint32_t run  = std::min(n, m_Capacity - (head & mask));
+        std::memcpy(samples, m_pSamples.get() + (head & mask), run * sizeof(float));
+        std::memcpy(samples + run, m_pSamples.get(), (n - run) * sizeof(float));
+        m_Head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Samples that can be written now; only exact on the producer side.
+    uint32_t GetWritable() const noexcept {
+        return m_Capacity - (m_Tail.load(std::memory_order_relaxed) -
+                             m_Head.load(std::memory_order_acquire));
+    }
+    /// Samples that can be read now; only exact on the consumer side.
+    uint32_t GetReadable() const noexcept {
+        return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_relaxed);
+    }
+
+    uint32_t GetCapacity() const noexcept {
+        return m_Capacity;
+    }
+
+private:
+    // Written by the consumer
+    alignas(64) std::atomic<uint32_t> m_Head {0};
+
+    // Written by the producer
+    alignas(64) std::atomic<uint32_t> m_Tail {0};
+
+    alignas(64) const uint32_t m_Capacity;
+    std::unique_ptr<float[]> m_pSamples;
+};
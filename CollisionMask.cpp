@@ -0,0 +1,153 @@
+//
+// CollisionMask.cpp - One-bit-per-pixel sprite shapes for pixel-accurate overlap tests
+//
+
+#include "CollisionMask.h"
+#include "Simd.h"
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace {
+#if PONG_SSE2
+    /// The words at p[0] and p[stride], as the low and high lanes.
+    __m128i Load2(const uint64_t* p, const size_t stride) noexcept {
+        return _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)),
+                                  _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + stride)));
+    }
+#endif
+}  // namespace
+
+CollisionMask::CollisionMask(const uint32_t width, const uint32_t height)
+    : m_Width(width),
+      m_Height(height),
+      m_WordsPerRow((width + 63) / 64),
+      m_Stride(m_WordsPerRow + 2),
+      m_Words(size_t {m_Stride} * height, 0) {}
+
+CollisionMask CollisionMask::FromTexture(const TextureData& texture,
+                                         const uint32_t width,
+                                         const uint32_t height,
+                                         const uint8_t threshold) {
+    if (texture.mipCount == 0 || texture.width == 0 || texture.height == 0)
+        throw std::invalid_argument("Cannot build a collision mask from an empty texture");
+
+    // Premultiplied BGRA8, so alpha is the fourth byte of each texel
+    const TextureMip& mip               = texture.mips[0];
+    const std::span<const std::byte> px = texture.GetMip(0);
+
+    CollisionMask mask(width, height);
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint32_t y0 = static_cast<uint32_t>(uint64_t {y} * mip.height / height);
+        const uint32_t y1 =
+          std::max(y0 + 1, static_cast<uint32_t>(uint64_t {y + 1} * mip.height / height));
+
+        for (uint32_t x = 0; x < width; ++x) {
+            const uint32_t x0 = static_cast<uint32_t>(uint64_t {x} * mip.width / width);
+            const uint32_t x1 =
+              std::max(x0 + 1, static_cast<uint32_t>(uint64_t {x + 1} * mip.width / width));
+
+            uint32_t sum = 0;
+            for (uint32_t sy = y0; sy < y1; ++sy) {
+                for (uint32_t sx = x0; sx < x1; ++sx)
+                    sum += static_cast<uint8_t>(px[size_t {sy} * mip.rowPitch + sx * 4 + 3]);
+            }
+            if (sum >= uint32_t {threshold} * (y1 - y0) * (x1 - x0))
+                mask.Set(x, y);
+        }
+    }
+
+    return mask;
+}
+
+bool CollisionMask::Overlaps(const CollisionMask& a,
+                             const int32_t ax,
+                             const int32_t ay,
+                             const CollisionMask& b,
+                             const int32_t bx,
+                             const int32_t by) noexcept {
+    return Intersect<false>(a, ax, ay, b, bx, by) != 0;
+}
+
+uint32_t CollisionMask::CountOverlap(const CollisionMask& a,
+                                     const int32_t ax,
+                                     const int32_t ay,
+                                     const CollisionMask& b,
+                                     const int32_t bx,
+                                     const int32_t by) noexcept {
+    return Intersect<true>(a, ax, ay, b, bx, by);
+}
+
+template<bool kCount>
+uint32_t CollisionMask::Intersect(const CollisionMask& a,
+                                  const int32_t ax,
+                                  const int32_t ay,
+                                  const CollisionMask& b,
+                                  const int32_t bx,
+                                  const int32_t by) noexcept {
+    const int32_t x0 = std::max(ax, bx);
+    const int32_t x1 = std::min(ax + static_cast<int32_t>(a.m_Width),
+                                bx + static_cast<int32_t>(b.m_Width));
+    const int32_t y0 = std::max(ay, by);
+    const int32_t y1 = std::min(ay + static_cast<int32_t>(a.m_Height),
+                                by + static_cast<int32_t>(b.m_Height));
+    if (x0 >= x1 || y0 >= y1)
+        return 0;
+
+    const auto rows       = static_cast<uint32_t>(y1 - y0);
+    const uint64_t* pRowA = a.GetRow(static_cast<uint32_t>(y0 - ay));
+    const uint64_t* pRowB = b.GetRow(static_cast<uint32_t>(y0 - by));
+    const auto firstWord  = static_cast<uint32_t>(x0 - ax) >> 6;
+    const auto lastWord   = static_cast<uint32_t>(x1 - 1 - ax) >> 6;
+    uint32_t count        = 0;
+
+    for (uint32_t word = firstWord; word <= lastWord; ++word) {
+        // This word of a holds b's bits from `start` on, which straddle b's words q and q + 1.
+        // Both lie within b's row or its padding, and bits outside b are zero, so no masking
+        // is needed.
+        const int32_t start = static_cast<int32_t>(word * 64) - (bx - ax);
+        const int32_t q     = start >> 6;
+        const auto shift    = static_cast<uint32_t>(start & 63);
+        const uint64_t* pA  = pRowA + word;
+        const uint64_t* pB  = pRowB + q;
+        uint32_t row        = 0;
+
+#if PONG_SSE2
+        // A 64-bit lane shift by 64 yields zero, so shift == 0 needs no special case
+        const __m128i right = _mm_cvtsi32_si128(static_cast<int>(shift));
+        const __m128i left  = _mm_cvtsi32_si128(static_cast<int>(64 - shift));
+        for (; row + 2 <= rows; row += 2) {
+            const __m128i wordsA = Load2(pA + size_t {row} * a.m_Stride, a.m_Stride);
+            const __m128i lo     = Load2(pB + size_t {row} * b.m_Stride, b.m_Stride);
+            const __m128i hi     = Load2(pB + size_t {row} * b.m_Stride + 1, b.m_Stride);
+            const __m128i wordsB =
+              _mm_or_si128(_mm_srl_epi64(lo, right), _mm_sll_epi64(hi, left));
+            const __m128i both = _mm_and_si128(wordsA, wordsB);
+
+            if constexpr (kCount) {
+                alignas(16) uint64_t lanes[2];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes), both);
+                count += static_cast<uint32_t>(std::popcount(lanes[0]) + std::popcount(lanes[1]));
+            } else if (_mm_movemask_epi8(_mm_cmpeq_epi8(both, _mm_setzero_si128())) != 0xFFFF) {
+                return 1;
+            }
+        }
+#endif
+
+        for (; row < rows; ++row) {
+            const uint64_t* pWordA = pA + size_t {row} * a.m_Stride;
+            const uint64_t* pWordB = pB + size_t {row} * b.m_Stride;
+            const uint64_t wordB   = (pWordB[0] >> shift) | (shift ? pWordB[1] << (64 - shift) : 0);
+            const uint64_t both    = pWordA[0] & wordB;
+
+            if constexpr (kCount)
+                count += static_cast<uint32_t>(std::popcount(both));
+            else if (both)
+                return 1;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,82 @@
+//
+// CollisionMask.h - One-bit-per-pixel sprite shapes for pixel-accurate overlap tests
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct TextureData;
+
+/// A sprite's solid pixels, 64 per word. Each row is stored between two zero words so a test
+/// can read the words either side of any overlap without bounds checks, and bits past the width
+/// are always clear.
+class CollisionMask {
+public:
+    CollisionMask() = default;
+    /// An empty mask.
+    CollisionMask(uint32_t width, uint32_t height);
+
+    /// Resamples the alpha of the texture's top mip to width x height: a pixel is solid when the
+    /// average alpha of the texels it covers reaches `threshold`.
+    static CollisionMask FromTexture(const TextureData& texture,
+                                     uint32_t width,
+                                     uint32_t height,
+                                     uint8_t threshold = 128);
+
+    uint32_t GetWidth() const noexcept {
+        return m_Width;
+    }
+    uint32_t GetHeight() const noexcept {
+        return m_Height;
+    }
+
+    bool Test(uint32_t x, uint32_t y) const noexcept {
+        return (GetRow(y)[x >> 6] >> (x & 63)) & 1;
+    }
+    void Set(uint32_t x, uint32_t y) noexcept {
+        GetRow(y)[x >> 6] |= uint64_t {1} << (x & 63);
+    }
+
+    /// True if any solid pixels coincide with `a`'s top-left corner at (ax, ay) and `b`'s at
+    /// (bx, by). Rows are ANDed two at a time with SSE2 where available.
+    static bool Overlaps(const CollisionMask& a,
+                         int32_t ax,
+                         int32_t ay,
+                         const CollisionMask& b,
+                         int32_t bx,
+                         int32_t by) noexcept;
+
+    /// The number of coinciding solid pixels, placed as for Overlaps.
+    static uint32_t CountOverlap(const CollisionMask& a,
+                                 int32_t ax,
+                                 int32_t ay,
+                                 const CollisionMask& b,
+                                 int32_t bx,
+                                 int32_t by) noexcept;
+
+private:
+    template<bool kCount>
+    static uint32_t Intersect(const CollisionMask& a,
+                              int32_t ax,
+                              int32_t ay,
+                              const CollisionMask& b,
+                              int32_t bx,
+                              int32_t by) noexcept;
+
+    /// The row's first data word; the padding words sit at [-1] and [m_WordsPerRow].
+    uint64_t* GetRow(const uint32_t y) noexcept {
+        return m_Words.data() + size_t {y} * m_Stride + 1;
+    }
+    const uint64_t* GetRow(const uint32_t y) const noexcept {
+        return m_Words.data() + size_t {y} * m_Stride + 1;
+    }
+
+    uint32_t m_Width       = 0;
+    uint32_t m_Height      = 0;
+    uint32_t m_WordsPerRow = 0;
+    uint32_t m_Stride      = 0;  // m_WordsPerRow plus the two padding words
+    std::vector<uint64_t> m_Words;
+};
@@ -0,0 +1,63 @@
+//
+// CommandLine.cpp - Program arguments as options, flags and positional arguments
+//
+
+#include "CommandLine.h"
+
+CommandLine::CommandLine(const int argc, const char* const* argv)
+    : CommandLine(argc > 1 ? std::vector<std::string>(argv + 1, argv + argc)
+                           : std::vector<std::string>()) {}
+
+CommandLine::CommandLine(std::vector<std::string> arguments) {
+    bool optionsEnded = false;
+    for (std::string& argument : arguments) {
+        if (optionsEnded || argument.size() < 3 || argument.compare(0, 2, "--") != 0) {
+            if (!optionsEnded && argument == "--")
+                optionsEnded = true;
+            else
+                m_Positional.push_back(std::move(argument));
+            continue;
+        }
+
+        const size_t equals = argument.find('=');
+        if (equals == std::string::npos)
+            m_Options.push_back({argument.substr(2), std::nullopt});
+        else
+            m_Options.push_back({argument.substr(2, equals - 2), argument.substr(equals + 1)});
+    }
+}
+
+bool CommandLine::HasFlag(const std::string_view name) {
+    const Option* pOption = Find(name);
+    if (pOption && pOption->value)
+        throw std::invalid_argument("--" + std::string(name) + " does not take a value");
+    return pOption != nullptr;
+}
+
+std::optional<std::string_view> CommandLine::GetValue(const std::string_view name) {
+    const Option* pOption = Find(name);
+    if (!pOption)
+        return std::nullopt;
+    if (!pOption->value)
+        throw std::invalid_argument("--" + std::string(name) + " needs a value, as --" +
+                                    std::string(name) + "=...");
+    return *pOption->value;
+}
+
+void CommandLine::CheckUnknown() const {
+    for (const Option& option : m_Options) {
+        if (!option.known)
+            throw std::invalid_argument("Unknown option --" + option.name);
+    }
+}
+
+const CommandLine::Option* CommandLine::Find(const std::string_view name) noexcept {
+    Option* pFound = nullptr;
+    for (Option& option : m_Options) {
+        if (option.name == name) {
+            option.known = true;
+            pFound       = &option;
+        }
+    }
+    return pFound;
+}
@@ -0,0 +1,73 @@
+//
+// CommandLine.h - Program arguments as options, flags and positional arguments
+//
+
+#pragma once
+
+#include <charconv>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Parsed program arguments: `--name=value` is an option, `--name` a flag and anything else is
+/// positional, as is everything after `--`. Arguments are UTF-8. Each lookup marks its name as
+/// known, so once a program has asked for everything it understands, CheckUnknown() can reject
+/// misspelt options instead of silently ignoring them. A repeated option takes its last value.
+class CommandLine {
+public:
+    CommandLine() = default;
+    /// Skips argv[0], the program name.
+    CommandLine(int argc, const char* const* argv);
+    explicit CommandLine(std::vector<std::string> arguments);
+
+    /// Throws std::invalid_argument if the flag was given a value.
+    bool HasFlag(std::string_view name);
+
+    /// Throws std::invalid_argument if the option was given without a value.
+    std::optional<std::string_view> GetValue(std::string_view name);
+
+    std::string GetString(const std::string_view name, const std::string_view fallback) {
+        return std::string(GetValue(name).value_or(fallback));
+    }
+
+    /// Throws std::invalid_argument if the value is not a number of type T.
+    template<typename T>
+    T GetNumber(std::string_view name, T fallback);
+
+    const std::vector<std::string>& GetPositional() const noexcept {
+        return m_Positional;
+    }
+
+    /// Throws std::invalid_argument naming the first option or flag that was never looked up.
+    void CheckUnknown() const;
+
+private:
+    struct Option {
+        std::string name;
+        std::optional<std::string> value;
+        bool known = false;
+    };
+
+    /// Marks every option called `name` as known and returns the last one, or nullptr.
+    const Option* Find(std::string_view name) noexcept;
+
+    std::vector<Option> m_Options;
+    std::vector<std::string> m_Positional;
+};
+
+template<typename T>
+T CommandLine::GetNumber(const std::string_view name, const T fallback) {
+    const auto value = GetValue(name);
+    if (!value)
+        return fallback;
+
+    T number {};
+    const char* const end   = value->data() + value->size();
+    const auto [last, error] = std::from_chars(value->data(), end, number);
+    if (error != std::errc() || last != end || value->empty())
+        throw std::invalid_argument("--" + std::string(name) + " expects a number, not '" +
+                                    std::string(*value) + "'");
+    return number;
+}
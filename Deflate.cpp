@@ -0,0 +1,467 @@
+//
+// Deflate.cpp - zlib stream (RFC 1950/1951) decoding and encoding
+//
+
+#include "Deflate.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    constexpr int kMaxBits      = 15;
+    constexpr int kMaxLitCodes  = 288;
+    constexpr int kMaxDistCodes = 30;
+
+    constexpr uint16_t kLengthBase[29] = {
+      3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+      31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+    };
+    constexpr uint8_t kLengthExtra[29] = {
+      0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+    };
+    constexpr uint16_t kDistBase[30] = {
+      1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+      193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+    };
+    constexpr uint8_t kDistExtra[30] = {
+      0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+      6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+    };
+    constexpr uint8_t kCodeLengthOrder[19] = {
+      16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+    };
+
+    [[noreturn]] void Fail(const char* what) {
+        throw std::runtime_error(what);
+    }
+
+    class BitReader {
+    public:
+        explicit BitReader(const std::span<const uint8_t> src) noexcept
+            : m_pData(src.data()), m_pEnd(src.data() + src.size()) {}
+
+        uint32_t Bits(const int count) {
+            while (m_BitCount < count) {
+                if (m_pData == m_pEnd)
+                    Fail("Deflate stream is truncated");
+                m_BitBuffer |= static_cast<uint32_t>(*m_pData++) << m_BitCount;
+                m_BitCount += 8;
+            }
+            const uint32_t value = m_BitBuffer & ((1u << count) - 1);
+            m_BitBuffer >>= count;
+            m_BitCount -= count;
+            return value;
+        }
+
+        // Drops the partial byte left over after a block header.
+        void AlignToByte() noexcept {
+            m_BitBuffer = 0;
+            m_BitCount  = 0;
+        }
+
+        const uint8_t* GetPosition() const noexcept {
+            return m_pData;
+        }
+        void Skip(const size_t bytes) {
+            if (static_cast<size_t>(m_pEnd - m_pData) < bytes)
+                Fail("Deflate stream is truncated");
+            m_pData += bytes;
+        }
+
+    private:
+        const uint8_t* m_pData;
+        const uint8_t* m_pEnd;
+        uint32_t m_BitBuffer = 0;
+        int m_BitCount       = 0;
+    };
+
+    // Canonical Huffman code, decoded one bit at a time by code length.
+    struct Huffman {
+        uint16_t count[kMaxBits + 1];
+        uint16_t symbol[kMaxLitCodes];
+    };
+
+    void BuildHuffman(Huffman& h, const uint8_t* lengths, const int n) {
+        std::fill(std::begin(h.count), std::end(h.count), uint16_t {0});
+        for (int i = 0; i < n; ++i)
+            h.count[lengths[i]]++;
+        h.count[0] = 0;
+
+        uint16_t offsets[kMaxBits + 1] = {};
+        for (int len = 1; len < kMaxBits; ++len)
+            offsets[len + 1] = static_cast<uint16_t>(offsets[len] + h.count[len]);
+
+        for (int i = 0; i < n; ++i) {
+            if (lengths[i])
+                h.symbol[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+        }
+    }
+
+    int Decode(BitReader& br, const Huffman& h) {
+        int code  = 0;
+        int first = 0;
+        int index = 0;
+        for (int len = 1; len <= kMaxBits; ++len) {
+            code |= static_cast<int>(br.Bits(1));
+            const int count = h.count[len];
+            if (code - count < first)
+                return h.symbol[index + (code - first)];
+            index += count;
+            first  = (first + count) << 1;
+            code <<= 1;
+        }
+        Fail("Invalid Huffman code in deflate stream");
+    }
+
+    void InflateCodes(BitReader& br,
+                      std::vector<uint8_t>& out,
+                      const Huffman& lit,
+                      const Huffman& dist) {
+        for (;;) {
+            const int symbol = Decode(br, lit);
+            if (symbol < 256) {
+                out.push_back(static_cast<uint8_t>(symbol));
+                continue;
+            }
+            if (symbol == 256)
+                return;
+
+            const int lengthIndex = symbol - 257;
+            if (lengthIndex >= 29)
+                Fail("Invalid length code in deflate stream");
+            const size_t length = kLengthBase[lengthIndex] + br.Bits(kLengthExtra[lengthIndex]);
+
+            const int distIndex = Decode(br, dist);
+            if (distIndex >= kMaxDistCodes)
+                Fail("Invalid distance code in deflate stream");
+            const size_t distance = kDistBase[distIndex] + br.Bits(kDistExtra[distIndex]);
+            if (distance > out.size())
+                Fail("Deflate distance reaches before start of output");
+
+            // Matches may overlap the bytes they produce, so copy forwards one at a time.
+            size_t from = out.size() - distance;
+            for (size_t i = 0; i < length; ++i)
+                out.push_back(out[from++]);
+        }
+    }
+
+    void InflateStored(BitReader& br, std::vector<uint8_t>& out) {
+        br.AlignToByte();
+        const uint8_t* p = br.GetPosition();
+        br.Skip(4);
+        const uint16_t len  = static_cast<uint16_t>(p[0] | p[1] << 8);
+        const uint16_t nlen = static_cast<uint16_t>(p[2] | p[3] << 8);
+        if (len != static_cast<uint16_t>(~nlen))
+            Fail("Corrupt stored block in deflate stream");
+
+        const uint8_t* data = br.GetPosition();
+        br.Skip(len);
+        out.insert(out.end(), data, data + len);
+    }
+
+    void InflateFixed(BitReader& br, std::vector<uint8_t>& out) {
+        static const auto s_Tables = [] {
+            std::pair<Huffman, Huffman> tables;
+            uint8_t lengths[kMaxLitCodes];
+            std::fill(lengths, lengths + 144, uint8_t {8});
+            std::fill(lengths + 144, lengths + 256, uint8_t {9});
+            std::fill(lengths + 256, lengths + 280, uint8_t {7});
+            std::fill(lengths + 280, lengths + 288, uint8_t {8});
+            BuildHuffman(tables.first, lengths, kMaxLitCodes);
+
+            std::fill(lengths, lengths + kMaxDistCodes, uint8_t {5});
+            BuildHuffman(tables.second, lengths, kMaxDistCodes);
+            return tables;
+        }();
+
+        InflateCodes(br, out, s_Tables.first, s_Tables.second);
+    }
+
+    void InflateDynamic(BitReader& br, std::vector<uint8_t>& out) {
+        const int litCount  = static_cast<int>(br.Bits(5)) + 257;
+        const int distCount = static_cast<int>(br.Bits(5)) + 1;
+        const int lenCount  = static_cast<int>(br.Bits(4)) + 4;
+        if (litCount > kMaxLitCodes || distCount > kMaxDistCodes)
+            Fail("Too many codes in dynamic deflate block");
+
+        uint8_t lengths[kMaxLitCodes + kMaxDistCodes] = {};
+        for (int i = 0; i < lenCount; ++i)
+            lengths[kCodeLengthOrder[i]] = static_cast<uint8_t>(br.Bits(3));
+
+        Huffman lenCode;
+        BuildHuffman(lenCode, lengths, 19);
+
+        int index = 0;
+        while (index < litCount + distCount) {
+            const int symbol = Decode(br, lenCode);
+            if (symbol < 16) {
+                lengths[index++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+
+            uint8_t value = 0;
+            int repeat    = 0;
+            if (symbol == 16) {
+                if (index == 0)
+                    Fail("Repeat with no previous length in deflate stream");
+                value  = lengths[index - 1];
+                repeat = 3 + static_cast<int>(br.Bits(2));
+            } else if (symbol == 17) {
+                repeat = 3 + static_cast<int>(br.Bits(3));
+            } else {
+                repeat = 11 + static_cast<int>(br.Bits(7));
+            }
+
+            if (index + repeat > litCount + distCount)
+                Fail("Code lengths overflow in deflate stream");
+            while (repeat--)
+                lengths[index++] = value;
+        }
+
+        if (lengths[256] == 0)
+            Fail("Dynamic deflate block has no end-of-block code");
+
+        Huffman lit;
+        Huffman dist;
+        BuildHuffman(lit, lengths, litCount);
+        BuildHuffman(dist, lengths + litCount, distCount);
+        InflateCodes(br, out, lit, dist);
+    }
+
+    constexpr uint32_t kWindowSize = 32768;
+    constexpr uint32_t kHashBits   = 15;
+    constexpr uint32_t kMinMatch   = 3;
+    constexpr uint32_t kMaxMatch   = 258;
+
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& out) noexcept : m_Out(out) {}
+
+        void Bits(const uint32_t value, const int count) {
+            m_BitBuffer |= uint64_t {value} << m_BitCount;
+            m_BitCount += count;
+            while (m_BitCount >= 8) {
+                m_Out.push_back(static_cast<uint8_t>(m_BitBuffer));
+                m_BitBuffer >>= 8;
+                m_BitCount -= 8;
+            }
+        }
+
+        // Pads the last partial byte with zero bits.
+        void Flush() {
+            if (m_BitCount > 0)
+                Bits(0, 8 - m_BitCount);
+        }
+
+    private:
+        std::vector<uint8_t>& m_Out;
+        uint64_t m_BitBuffer = 0;
+        int m_BitCount       = 0;
+    };
+
+    // Huffman codes are sent most significant bit first, into a stream filled from the bottom
+    struct Code {
+        uint16_t bits;  // already bit-reversed
+        uint8_t length;
+    };
+
+    constexpr uint16_t Reverse(uint32_t code, const int length) noexcept {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i, code >>= 1)
+            reversed = reversed << 1 | (code & 1);
+        return static_cast<uint16_t>(reversed);
+    }
+
+    constexpr std::array<Code, kMaxLitCodes> MakeFixedLitCodes() noexcept {
+        std::array<Code, kMaxLitCodes> codes {};
+        for (uint32_t s = 0; s < kMaxLitCodes; ++s) {
+            if (s < 144)
+                codes[s] = {Reverse(0x30 + s, 8), 8};
+            else if (s < 256)
+                codes[s] = {Reverse(0x190 + s - 144, 9), 9};
+            else if (s < 280)
+                codes[s] = {Reverse(s - 256, 7), 7};
+            else
+                codes[s] = {Reverse(0xC0 + s - 280, 8), 8};
+        }
+        return codes;
+    }
+
+    // Index into kLengthBase for each match length
+    constexpr std::array<uint8_t, kMaxMatch + 1> MakeLengthSymbols() noexcept {
+        std::array<uint8_t, kMaxMatch + 1> symbols {};
+        for (uint32_t length = kMinMatch; length <= kMaxMatch; ++length) {
+            uint8_t symbol = 28;
+            while (kLengthBase[symbol] > length)
+                --symbol;
+            symbols[length] = symbol;
+        }
+        return symbols;
+    }
+
+    // Index into kDistBase: distances up to 256 directly, longer ones by (distance - 1) >> 7
+    constexpr std::array<uint8_t, 512> MakeDistSymbols() noexcept {
+        std::array<uint8_t, 512> symbols {};
+        for (uint32_t i = 0; i < 512; ++i) {
+            const uint32_t distance = i < 256 ? i + 1 : ((i - 256) << 7) + 1;
+            uint8_t symbol          = 29;
+            while (kDistBase[symbol] > distance)
+                --symbol;
+            symbols[i] = symbol;
+        }
+        return symbols;
+    }
+
+    constexpr auto kFixedLitCodes = MakeFixedLitCodes();
+    constexpr auto kLengthSymbols = MakeLengthSymbols();
+    constexpr auto kDistSymbols   = MakeDistSymbols();
+
+    void PutLiteral(BitWriter& bw, const uint32_t symbol) {
+        const Code code = kFixedLitCodes[symbol];
+        bw.Bits(code.bits, code.length);
+    }
+
+    void PutMatch(BitWriter& bw, const uint32_t length, const uint32_t distance) {
+        const uint32_t lengthSymbol = kLengthSymbols[length];
+        PutLiteral(bw, 257 + lengthSymbol);
+        bw.Bits(length - kLengthBase[lengthSymbol], kLengthExtra[lengthSymbol]);
+
+        const uint32_t distSymbol =
+          kDistSymbols[distance <= 256 ? distance - 1 : 256 + ((distance - 1) >> 7)];
+        bw.Bits(Reverse(distSymbol, 5), 5);
+        bw.Bits(distance - kDistBase[distSymbol], kDistExtra[distSymbol]);
+    }
+
+    uint32_t Hash3(const uint8_t* p) noexcept {
+        const uint32_t bytes = uint32_t {p[0]} << 16 | uint32_t {p[1]} << 8 | p[2];
+        return (bytes * 2654435761u) >> (32 - kHashBits);
+    }
+
+    uint32_t Adler32(const std::span<const uint8_t> data) noexcept {
+        constexpr uint32_t kModulus = 65521;
+        constexpr size_t kBlock     = 5552;  // the most bytes before s2 can overflow
+
+        uint32_t s1 = 1;
+        uint32_t s2 = 0;
+        for (size_t start = 0; start < data.size(); start += kBlock) {
+            const size_t end = std::min(data.size(), start + kBlock);
+            for (size_t i = start; i < end; ++i) {
+                s1 += data[i];
+                s2 += s1;
+            }
+            s1 %= kModulus;
+            s2 %= kModulus;
+        }
+        return s2 << 16 | s1;
+    }
+}  // namespace
+
+void Deflate::InflateZlib(const std::span<const uint8_t> src, std::vector<uint8_t>& out) {
+    if (src.size() < 6)
+        Fail("zlib stream is truncated");
+
+    const uint8_t cmf = src[0];
+    const uint8_t flg = src[1];
+    if ((cmf & 0x0F) != 8 || (cmf * 256 + flg) % 31 != 0 || (flg & 0x20))
+        Fail("Unsupported zlib stream header");
+
+    BitReader br(src.subspan(2));
+    bool last = false;
+    while (!last) {
+        last = br.Bits(1) != 0;
+        switch (br.Bits(2)) {
+            case 0:
+                InflateStored(br, out);
+                break;
+            case 1:
+                InflateFixed(br, out);
+                break;
+            case 2:
+                InflateDynamic(br, out);
+                break;
+            default:
+                Fail("Invalid deflate block type");
+        }
+    }
+}
+
+void Deflate::DeflateZlib(const std::span<const uint8_t> src,
+                          std::vector<uint8_t>& out,
+                          const uint32_t maxChain) {
+    out.push_back(0x78);  // deflate with a 32 KB window
+    out.push_back(0x9C);  // default compression level, no preset dictionary
+
+    BitWriter bw(out);
+    bw.Bits(1, 1);  // final block
+    bw.Bits(1, 2);  // fixed Huffman codes
+
+    // head holds the latest position of each hash and prev links back to older ones, so a chain
+    // walks from the nearest candidate outwards
+    const uint8_t* const data = src.data();
+    const size_t size         = src.size();
+    std::vector<int32_t> head(size_t {1} << kHashBits, -1);
+    std::vector<int32_t> prev(kWindowSize, -1);
+    const auto insert = [&](const size_t position) {
+        if (position + kMinMatch <= size) {
+            const uint32_t hash                = Hash3(data + position);
+            prev[position & (kWindowSize - 1)] = head[hash];
+            head[hash]                         = static_cast<int32_t>(position);
+        }
+    };
+
+    size_t position = 0;
+    while (position < size) {
+        uint32_t bestLength   = 0;
+        uint32_t bestDistance = 0;
+        if (maxChain && position + kMinMatch <= size) {
+            const auto maxLength =
+              static_cast<uint32_t>(std::min<size_t>(kMaxMatch, size - position));
+            int32_t candidate = head[Hash3(data + position)];
+            for (uint32_t chain = 0; candidate >= 0 && chain < maxChain; ++chain) {
+                const size_t distance = position - static_cast<size_t>(candidate);
+                if (distance > kWindowSize)
+                    break;
+
+                const uint8_t* a = data + candidate;
+                const uint8_t* b = data + position;
+                if (a[bestLength] == b[bestLength]) {
+                    uint32_t length = 0;
+                    while (length < maxLength && a[length] == b[length])
+                        ++length;
+                    if (length > bestLength) {
+                        bestLength   = length;
+                        bestDistance = static_cast<uint32_t>(distance);
+                        if (length == maxLength)
+                            break;
+                    }
+                }
+
+                // Entries older than the window may have been overwritten by newer positions
+                const int32_t next = prev[static_cast<size_t>(candidate) & (kWindowSize - 1)];
+                if (next >= candidate)
+                    break;
+                candidate = next;
+            }
+        }
+
+        if (bestLength >= kMinMatch) {
+            PutMatch(bw, bestLength, bestDistance);
+            for (size_t end = position + bestLength; position < end; ++position)
+                insert(position);
+        } else {
+            PutLiteral(bw, data[position]);
+            insert(position);
+            ++position;
+        }
+    }
+
+    PutLiteral(bw, 256);  // end of block
+    bw.Flush();
+
+    const uint32_t adler = Adler32(src);
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<uint8_t>(adler >> shift));
+}
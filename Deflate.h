@@ -0,0 +1,23 @@
+//
+// Deflate.h - zlib stream (RFC 1950/1951) decoding and encoding
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Deflate {
+    /// Inflates a zlib-wrapped deflate stream, appending the output to `out`. Throws
+    /// std::runtime_error if the stream is malformed.
+    void InflateZlib(std::span<const uint8_t> src, std::vector<uint8_t>& out);
+
+    /// Deflates `src` into a zlib stream appended to `out`, as a single block with the fixed
+    /// Huffman codes. Matches are found greedily through hash chains; `maxChain` bounds the
+    /// candidates tried at each position, trading ratio for speed, and 0 disables matching.
+    void DeflateZlib(std::span<const uint8_t> src,
+                     std::vector<uint8_t>& out,
+                     uint32_t maxChain = 16);
+}  // namespace Deflate
@@ -0,0 +1,237 @@
+//
+// Ecs.cpp - Archetype entity-component storage, cached queries and a parallel system scheduler
+//
+
+#include "Ecs.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <exception>
+#include <latch>
+#include <stdexcept>
+
+namespace {
+    std::atomic<uint32_t> g_NextComponentId {0};
+    std::array<uint32_t, kMaxComponentTypes> g_ComponentSizes {};
+}  // namespace
+
+uint32_t ComponentRegistry::Register(const uint32_t size) {
+    const uint32_t id = g_NextComponentId.fetch_add(1, std::memory_order_relaxed);
+    if (id >= kMaxComponentTypes)
+        throw std::length_error("Too many component types");
+    g_ComponentSizes[id] = size;
+    return id;
+}
+
+uint32_t ComponentRegistry::GetSize(const uint32_t id) noexcept {
+    return g_ComponentSizes[id];
+}
+
+Archetype::Archetype(const ComponentMask mask) : m_Mask(mask) {
+    m_ColumnOf.fill(kNoColumn);
+    for (ComponentMask bits = mask; bits; bits &= bits - 1) {
+        const auto id  = static_cast<uint32_t>(std::countr_zero(bits));
+        m_ColumnOf[id] = static_cast<uint8_t>(m_Columns.size());
+        m_Columns.push_back({id, ComponentRegistry::GetSize(id), {}});
+    }
+}
+
+void* Archetype::GetColumn(const uint32_t id) noexcept {
+    return Has(id) ? m_Columns[m_ColumnOf[id]].data.data() : nullptr;
+}
+
+uint32_t Archetype::AddRow(const Entity entity) {
+    for (auto& column : m_Columns)
+        column.data.resize(column.data.size() + column.elementSize);
+    m_Entities.push_back(entity);
+    return static_cast<uint32_t>(m_Entities.size() - 1);
+}
+
+Entity Archetype::RemoveRow(const uint32_t row) noexcept {
+    const auto last = static_cast<uint32_t>(m_Entities.size() - 1);
+    for (auto& column : m_Columns) {
+        if (row != last)
+            std::memcpy(column.data.data() + size_t {row} * column.elementSize,
+                        column.data.data() + size_t {last} * column.elementSize,
+                        column.elementSize);
+        column.data.resize(column.data.size() - column.elementSize);
+    }
+
+    m_Entities[row] = m_Entities[last];
+    m_Entities.pop_back();
+    return row != last ? m_Entities[row] : Entity {};
+}
+
+bool World::Destroy(const Entity entity) {
+    if (!IsAlive(entity))
+        return false;
+
+    Record& record     = m_Records[entity.index];
+    const Entity moved = m_Archetypes[record.archetype].RemoveRow(record.row);
+    if (moved.IsValid())
+        m_Records[moved.index].row = record.row;
+
+    record.archetype = UINT32_MAX;
+    record.generation++;
+    m_FreeEntities.push_back(entity.index);
+    return true;
+}
+
+void World::Clear() {
+    for (auto& archetype : m_Archetypes) {
+        for (auto& column : archetype.m_Columns)
+            column.data.clear();
+        archetype.m_Entities.clear();
+    }
+
+    for (uint32_t index = 0; index < m_Records.size(); ++index) {
+        Record& record = m_Records[index];
+        if (record.archetype == UINT32_MAX)
+            continue;
+        record.archetype = UINT32_MAX;
+        record.generation++;
+        m_FreeEntities.push_back(index);
+    }
+}
+
+bool World::IsAlive(const Entity entity) const noexcept {
+    return entity.index < m_Records.size() &&
+           m_Records[entity.index].generation == entity.generation &&
+           m_Records[entity.index].archetype != UINT32_MAX;
+}
+
+Entity World::AllocateEntity() {
+    if (m_FreeEntities.empty()) {
+        m_Records.emplace_back();
+        return {static_cast<uint32_t>(m_Records.size() - 1), 0};
+    }
+
+    const uint32_t index = m_FreeEntities.back();
+    m_FreeEntities.pop_back();
+    return {index, m_Records[index].generation};
+}
+
+ComponentMask World::GetMask(const Entity entity) const noexcept {
+    return m_Archetypes[m_Records[entity.index].archetype].GetMask();
+}
+
+uint32_t World::GetOrCreateArchetype(const ComponentMask mask) {
+    if (const auto it = m_ArchetypeByMask.find(mask); it != m_ArchetypeByMask.end())
+        return it->second;
+
+    const auto index = static_cast<uint32_t>(m_Archetypes.size());
+    m_Archetypes.emplace_back(mask);
+    m_ArchetypeByMask.emplace(mask, index);
+    return index;
+}
+
+void World::MoveEntity(const Entity entity, const ComponentMask mask) {
+    const uint32_t to = GetOrCreateArchetype(mask);  // may reallocate m_Archetypes
+    Record& record    = m_Records[entity.index];
+    Archetype& source = m_Archetypes[record.archetype];
+    Archetype& target = m_Archetypes[to];
+
+    const uint32_t row = target.AddRow(entity);
+    for (const auto& column : source.m_Columns) {
+        if (void* dest = target.GetColumn(column.id))
+            std::memcpy(static_cast<std::byte*>(dest) + size_t {row} * column.elementSize,
+                        column.data.data() + size_t {record.row} * column.elementSize,
+                        column.elementSize);
+    }
+
+    const Entity moved = source.RemoveRow(record.row);
+    if (moved.IsValid())
+        m_Records[moved.index].row = record.row;
+
+    record.archetype = to;
+    record.row       = row;
+}
+
+bool SystemAccess::ConflictsWith(const SystemAccess& other, const World& world) const noexcept {
+    if ((m_ResourceWrites & (other.m_ResourceReads | other.m_ResourceWrites)) ||
+        (other.m_ResourceWrites & m_ResourceReads))
+        return true;
+
+    for (uint32_t i = 0; i < world.GetArchetypeCount(); ++i) {
+        const ComponentMask mask = world.GetArchetype(i).GetMask();
+        for (const auto& a : m_Queries) {
+            if ((mask & a.include) != a.include)
+                continue;
+            for (const auto& b : other.m_Queries) {
+                if ((mask & b.include) != b.include)
+                    continue;
+                if (mask & ((a.writes & (b.reads | b.writes)) | (b.writes & a.reads)))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Scheduler::Add(std::string name, SystemAccess access, SystemFunc run) {
+    m_Systems.push_back({std::move(name), std::move(access), std::move(run)});
+    m_StagedArchetypes = UINT32_MAX;
+}
+
+void Scheduler::Run() {
+    if (m_StagedArchetypes != m_pWorld->GetArchetypeCount())
+        BuildStages();
+
+    for (const auto& stage : m_Stages)
+        RunStage(stage);
+}
+
+void Scheduler::BuildStages() {
+    m_Stages.clear();
+
+    std::vector<uint32_t> stageOf(m_Systems.size(), 0);
+    for (uint32_t i = 0; i < m_Systems.size(); ++i) {
+        for (uint32_t j = 0; j < i; ++j) {
+            if (stageOf[j] + 1 > stageOf[i] &&
+                m_Systems[i].access.ConflictsWith(m_Systems[j].access, *m_pWorld))
+                stageOf[i] = stageOf[j] + 1;
+        }
+
+        if (stageOf[i] >= m_Stages.size())
+            m_Stages.resize(stageOf[i] + 1);
+        m_Stages[stageOf[i]].push_back(i);
+    }
+
+    m_StagedArchetypes = m_pWorld->GetArchetypeCount();
+}
+
+void Scheduler::RunStage(const std::vector<uint32_t>& stage) {
+    if (!m_pJobs || stage.size() == 1) {
+        for (const uint32_t system : stage)
+            m_Systems[system].run();
+        return;
+    }
+
+    // The calling thread takes the first system itself rather than idling at the barrier.
+    std::vector<std::exception_ptr> errors(stage.size());
+    std::latch done(static_cast<ptrdiff_t>(stage.size() - 1));
+    for (size_t i = 1; i < stage.size(); ++i) {
+        m_pJobs->Submit([this, &stage, &errors, &done, i] {
+            try {
+                m_Systems[stage[i]].run();
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+            done.count_down();
+        });
+    }
+
+    try {
+        m_Systems[stage[0]].run();
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+    done.wait();
+
+    for (const auto& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
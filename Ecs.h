@@ -0,0 +1,370 @@
+//
+// Ecs.h - Archetype entity-component storage, cached queries and a parallel system scheduler
+//
+// Entities with the same set of component types share an archetype, which stores each
+// component type in its own contiguous column. Queries cache the archetypes that match them and
+// walk those columns linearly. The scheduler runs systems in registration order, but groups
+// systems whose component and resource accesses cannot overlap into stages that run in
+// parallel on a JobSystem.
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+
+using ComponentMask = uint64_t;
+
+inline constexpr uint32_t kMaxComponentTypes = 64;
+
+/// Identifies a live entity. As with pool handles, destroying an entity bumps its generation, so
+/// handles to destroyed entities are detected instead of aliasing new ones.
+struct Entity {
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    uint32_t index      = kInvalidIndex;
+    uint32_t generation = 0;
+
+    bool IsValid() const noexcept {
+        return index != kInvalidIndex;
+    }
+
+    friend bool operator==(const Entity&, const Entity&) = default;
+};
+
+/// Assigns each component (or resource) type a bit in a ComponentMask on first use.
+/// Components are plain data: rows are moved between archetypes with memcpy.
+class ComponentRegistry {
+public:
+    template<typename T>
+    static uint32_t GetId() {
+        if constexpr (!std::is_same_v<T, std::remove_cv_t<T>>) {
+            return GetId<std::remove_cv_t<T>>();
+        } else {
+            static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                          "Components must be plain data");
+            static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+            static const uint32_t s_Id = Register(sizeof(T));
+            return s_Id;
+        }
+    }
+
+    template<typename... Ts>
+    static ComponentMask GetMask() {
+        return (ComponentMask {0} | ... | (ComponentMask {1} << GetId<Ts>()));
+    }
+
+    static uint32_t GetSize(uint32_t id) noexcept;
+
+private:
+    /// Throws std::length_error past kMaxComponentTypes types.
+    static uint32_t Register(uint32_t size);
+};
+
+class Archetype {
+public:
+    explicit Archetype(ComponentMask mask);
+
+    ComponentMask GetMask() const noexcept {
+        return m_Mask;
+    }
+    uint32_t GetSize() const noexcept {
+        return static_cast<uint32_t>(m_Entities.size());
+    }
+    const std::vector<Entity>& GetEntities() const noexcept {
+        return m_Entities;
+    }
+
+    bool Has(const uint32_t id) const noexcept {
+        return m_ColumnOf[id] != kNoColumn;
+    }
+
+    /// The component's column, one element per row. Null if the archetype lacks the component.
+    template<typename T>
+    T* GetColumn() noexcept {
+        return static_cast<T*>(GetColumn(ComponentRegistry::GetId<T>()));
+    }
+    void* GetColumn(uint32_t id) noexcept;
+
+private:
+    friend class World;
+
+    static constexpr uint8_t kNoColumn = 0xFF;
+
+    struct Column {
+        uint32_t id;
+        uint32_t elementSize;
+        std::vector<std::byte> data;
+    };
+
+    /// Appends a row with zeroed components.
+    uint32_t AddRow(Entity entity);
+    /// Removes a row by moving the last row into it. Returns the entity that now occupies the
+    /// row, or an invalid entity if it was the last row.
+    Entity RemoveRow(uint32_t row) noexcept;
+
+    ComponentMask m_Mask;
+    std::array<uint8_t, kMaxComponentTypes> m_ColumnOf;
+    std::vector<Column> m_Columns;
+    std::vector<Entity> m_Entities;
+};
+
+/// Owns every entity and archetype. Structural changes (Create, Destroy, Add, Remove) must not
+/// happen while a Scheduler is running systems on the same world.
+class World {
+public:
+    template<typename... Ts>
+    Entity Create(const Ts&... components) {
+        const uint32_t archetypeIndex = GetOrCreateArchetype(ComponentRegistry::GetMask<Ts...>());
+        const Entity entity           = AllocateEntity();
+
+        Archetype& archetype = m_Archetypes[archetypeIndex];
+        const uint32_t row   = archetype.AddRow(entity);
+        ((archetype.GetColumn<Ts>()[row] = components), ...);
+
+        m_Records[entity.index].archetype = archetypeIndex;
+        m_Records[entity.index].row       = row;
+        return entity;
+    }
+
+    /// Returns false if the entity is not alive.
+    bool Destroy(Entity entity);
+
+    /// Destroys every entity. Archetypes are kept, so queries and schedules stay valid.
+    void Clear();
+
+    bool IsAlive(Entity entity) const noexcept;
+
+    /// Null if the entity is not alive or lacks the component. Pointers are invalidated by
+    /// structural changes.
+    template<typename T>
+    T* Get(const Entity entity) noexcept {
+        if (!IsAlive(entity))
+            return nullptr;
+        const Record& record = m_Records[entity.index];
+        T* column            = m_Archetypes[record.archetype].GetColumn<T>();
+        return column ? column + record.row : nullptr;
+    }
+
+    template<typename T>
+    bool Has(const Entity entity) const noexcept {
+        return IsAlive(entity) &&
+               m_Archetypes[m_Records[entity.index].archetype].Has(ComponentRegistry::GetId<T>());
+    }
+
+    /// Adds the component, moving the entity to the matching archetype, or overwrites it if the
+    /// entity already has one.
+    template<typename T>
+    void Add(const Entity entity, const T& component) {
+        if (!Has<T>(entity))
+            MoveEntity(entity, GetMask(entity) | ComponentRegistry::GetMask<T>());
+        *Get<T>(entity) = component;
+    }
+
+    template<typename T>
+    void Remove(const Entity entity) {
+        if (Has<T>(entity))
+            MoveEntity(entity, GetMask(entity) & ~ComponentRegistry::GetMask<T>());
+    }
+
+    uint32_t GetArchetypeCount() const noexcept {
+        return static_cast<uint32_t>(m_Archetypes.size());
+    }
+    Archetype& GetArchetype(const uint32_t index) noexcept {
+        return m_Archetypes[index];
+    }
+    const Archetype& GetArchetype(const uint32_t index) const noexcept {
+        return m_Archetypes[index];
+    }
+
+    uint32_t GetEntityCount() const noexcept {
+        return static_cast<uint32_t>(m_Records.size() - m_FreeEntities.size());
+    }
+
+private:
+    struct Record {
+        uint32_t archetype  = UINT32_MAX;  // UINT32_MAX while the slot is free
+        uint32_t row        = 0;
+        uint32_t generation = 0;
+    };
+
+    Entity AllocateEntity();
+    ComponentMask GetMask(Entity entity) const noexcept;
+    uint32_t GetOrCreateArchetype(ComponentMask mask);
+    /// Copies the components both archetypes share; the others start zeroed.
+    void MoveEntity(Entity entity, ComponentMask mask);
+
+    std::vector<Archetype> m_Archetypes;
+    std::unordered_map<ComponentMask, uint32_t> m_ArchetypeByMask;
+    std::vector<Record> m_Records;
+    std::vector<uint32_t> m_FreeEntities;
+};
+
+/// Iterates every entity that has all of `Ts`. Const component types are read-only, which the
+/// scheduler uses to let queries that only read the same columns run in parallel. The matching
+/// archetypes are cached; only archetypes created since the last iteration are tested.
+template<typename... Ts>
+class Query {
+public:
+    explicit Query(World& world) noexcept : m_pWorld(&world) {}
+
+    static ComponentMask GetIncludeMask() {
+        return ComponentRegistry::GetMask<Ts...>();
+    }
+    static ComponentMask GetReadMask() {
+        return (ComponentMask {0} | ... |
+                (std::is_const_v<Ts> ? ComponentRegistry::GetMask<Ts>() : ComponentMask {0}));
+    }
+    static ComponentMask GetWriteMask() {
+        return GetIncludeMask() & ~GetReadMask();
+    }
+
+    /// Calls func(Ts&...) or func(Entity, Ts&...) for every matching entity.
+    template<typename TFunc>
+    void ForEach(const TFunc& func) {
+        Update();
+        for (const uint32_t index : m_Archetypes) {
+            Archetype& archetype = m_pWorld->GetArchetype(index);
+            const auto columns   = GetColumns(archetype);
+            const auto& entities = archetype.GetEntities();
+            for (uint32_t row = 0; row < archetype.GetSize(); ++row) {
+                std::apply(
+                  [&](Ts*... column) {
+                      if constexpr (std::is_invocable_v<const TFunc&, Entity, Ts&...>)
+                          func(entities[row], column[row]...);
+                      else
+                          func(column[row]...);
+                  },
+                  columns);
+            }
+        }
+    }
+
+    /// Calls func(count, Ts*...) once per matching archetype with its whole columns, for loops
+    /// that want to vectorize.
+    template<typename TFunc>
+    void ForEachChunk(const TFunc& func) {
+        Update();
+        for (const uint32_t index : m_Archetypes) {
+            Archetype& archetype = m_pWorld->GetArchetype(index);
+            if (archetype.GetSize())
+                std::apply([&](Ts*... column) { func(archetype.GetSize(), column...); },
+                           GetColumns(archetype));
+        }
+    }
+
+    uint32_t Count() {
+        Update();
+        uint32_t count = 0;
+        for (const uint32_t index : m_Archetypes)
+            count += m_pWorld->GetArchetype(index).GetSize();
+        return count;
+    }
+
+private:
+    void Update() {
+        const ComponentMask include = GetIncludeMask();
+        for (; m_SeenArchetypes < m_pWorld->GetArchetypeCount(); ++m_SeenArchetypes) {
+            if ((m_pWorld->GetArchetype(m_SeenArchetypes).GetMask() & include) == include)
+                m_Archetypes.push_back(m_SeenArchetypes);
+        }
+    }
+
+    static std::tuple<Ts*...> GetColumns(Archetype& archetype) noexcept {
+        return {archetype.GetColumn<std::remove_const_t<Ts>>()...};
+    }
+
+    World* m_pWorld;
+    std::vector<uint32_t> m_Archetypes;
+    uint32_t m_SeenArchetypes = 0;
+};
+
+/// What a system touches: the queries it iterates, plus any shared non-component state
+/// ("resources", identified by type like components).
+class SystemAccess {
+public:
+    struct QueryAccess {
+        ComponentMask include;
+        ComponentMask reads;
+        ComponentMask writes;
+    };
+
+    template<typename... Ts>
+    SystemAccess& Uses(const Query<Ts...>&) {
+        m_Queries.push_back({Query<Ts...>::GetIncludeMask(),
+                             Query<Ts...>::GetReadMask(),
+                             Query<Ts...>::GetWriteMask()});
+        return *this;
+    }
+
+    template<typename T>
+    SystemAccess& Reads() {
+        m_ResourceReads |= ComponentRegistry::GetMask<T>();
+        return *this;
+    }
+    template<typename T>
+    SystemAccess& Writes() {
+        m_ResourceWrites |= ComponentRegistry::GetMask<T>();
+        return *this;
+    }
+
+    /// True if running both systems at once could race, given the archetypes in `world`. Two
+    /// queries only conflict inside an archetype they both match, so systems writing the same
+    /// component of disjoint entity sets still run in parallel.
+    bool ConflictsWith(const SystemAccess& other, const World& world) const noexcept;
+
+private:
+    std::vector<QueryAccess> m_Queries;
+    ComponentMask m_ResourceReads  = 0;
+    ComponentMask m_ResourceWrites = 0;
+};
+
+/// Runs systems once per Run() call. A system is placed in the stage after the last earlier
+/// system it conflicts with, so the results match running them in registration order. Stages
+/// are rebuilt whenever the world gains archetypes.
+class Scheduler {
+public:
+    using SystemFunc = std::function<void()>;
+
+    /// With no job system, every stage runs on the calling thread.
+    Scheduler(World& world, JobSystem* pJobs) noexcept : m_pWorld(&world), m_pJobs(pJobs) {}
+
+    void Add(std::string name, SystemAccess access, SystemFunc run);
+
+    /// Runs every system; rethrows the first exception a system threw once its stage finishes.
+    void Run();
+
+    /// System indices grouped by stage, as of the last Run().
+    const std::vector<std::vector<uint32_t>>& GetStages() const noexcept {
+        return m_Stages;
+    }
+    const std::string& GetName(const uint32_t system) const noexcept {
+        return m_Systems[system].name;
+    }
+
+private:
+    struct System {
+        std::string name;
+        SystemAccess access;
+        SystemFunc run;
+    };
+
+    void BuildStages();
+    void RunStage(const std::vector<uint32_t>& stage);
+
+    World* m_pWorld;
+    JobSystem* m_pJobs;
+    std::vector<System> m_Systems;
+    std::vector<std::vector<uint32_t>> m_Stages;
+    uint32_t m_StagedArchetypes = UINT32_MAX;
+};
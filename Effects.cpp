@@ -0,0 +1,60 @@
+//
+// Effects.cpp - Sparks and the ball trail, driven by the simulation's events
+//
+
+#include "Effects.h"
+#include "Palette.h"
+#include "Sim.h"
+
+namespace {
+    constexpr uint32_t kMaxSparks = 16384;
+    constexpr uint32_t kMaxTrail  = 4096;
+    constexpr float kSparkGravity = 900.f;
+    constexpr float kPi           = 3.14159265f;
+}  // namespace
+
+CourtEffects::CourtEffects() : m_Sparks(kMaxSparks, kSparkGravity), m_Trail(kMaxTrail) {}
+
+void CourtEffects::Emit(Sim& sim) {
+    for (const SimEvent& event : sim.GetEvents()) {
+        // Sparks spray back into the court, away from whatever was hit
+        const float intoCourt = event.side == Side::Left ? 0.f : kPi;
+        switch (event.type) {
+            case SimEventType::PaddleHit:
+                m_Sparks.Emit(
+                  {event.x, event.y, intoCourt, 0.9f, 150.f, 550.f, 0.45f, 5.f, 0xFFFFD070, 40});
+                break;
+            case SimEventType::WallHit:
+                m_Sparks.Emit({event.x,
+                               event.y,
+                               event.y < kCourtHeight * 0.5f ? kPi * 0.5f : -kPi * 0.5f,
+                               1.f,
+                               80.f,
+                               300.f,
+                               0.3f,
+                               4.f,
+                               0xFFC0D0FF,
+                               16});
+                break;
+            case SimEventType::Goal:
+                m_Sparks.Emit(
+                  {event.x, event.y, intoCourt, 1.4f, 200.f, 900.f, 0.9f, 6.f, 0xFFFF5050, 300});
+                break;
+            case SimEventType::BrickBroken:
+                m_Sparks.Emit(
+                  {event.x, event.y, 0.f, kPi, 40.f, 260.f, 0.4f, 4.f, GetBrickColor(event.y), 12});
+                break;
+        }
+    }
+
+    sim.ForEachSprite([&](const Transform& transform, const Extent&, const Sprite& sprite) {
+        if (sprite.id == kSpriteBall)
+            m_Trail.Emit(
+              {transform.x, transform.y, 0.f, kPi, 0.f, 30.f, 0.35f, 12.f, 0x8090B0FF, 1});
+    });
+}
+
+void CourtEffects::Update(const float dt, JobSystem* pJobs) {
+    m_Sparks.Update(dt, pJobs);
+    m_Trail.Update(dt, pJobs);
+}
@@ -0,0 +1,35 @@
+//
+// Effects.h - Sparks and the ball trail, driven by the simulation's events
+//
+
+#pragma once
+
+#include "Particles.h"
+
+class JobSystem;
+class Sim;
+
+/// The court's particle effects, shared by every renderer. Sparks from paddle hits, bounces,
+/// goals and broken bricks fall under gravity; the ball trail does not.
+class CourtEffects {
+public:
+    CourtEffects();
+
+    /// Emits sparks for the events of the sim's last step and extends the ball trail. Call once
+    /// per step, so the trail's density does not depend on the frame rate.
+    void Emit(Sim& sim);
+
+    /// Advances both systems; call once per frame.
+    void Update(float dt, JobSystem* pJobs = nullptr);
+
+    const ParticleSystem& GetSparks() const noexcept {
+        return m_Sparks;
+    }
+    const ParticleSystem& GetTrail() const noexcept {
+        return m_Trail;
+    }
+
+private:
+    ParticleSystem m_Sparks;
+    ParticleSystem m_Trail;
+};
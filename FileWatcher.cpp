@@ -0,0 +1,213 @@
+//
+// FileWatcher.cpp - Debounced change notifications for the files in one directory
+//
+
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <map>
+#include <system_error>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <Windows.h>
+#else
+    #include <poll.h>
+    #include <sys/eventfd.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Changed files waiting for their debounce interval to elapse, keyed by name.
+    class PendingChanges {
+    public:
+        explicit PendingChanges(const std::chrono::milliseconds debounce) noexcept
+            : m_Debounce(debounce) {}
+
+        void Touch(std::filesystem::path file) {
+            m_Files[std::move(file)] = Clock::now();
+        }
+
+        /// Milliseconds until the next file is due, or -1 if nothing is pending.
+        int GetTimeoutMs() const {
+            if (m_Files.empty())
+                return -1;
+
+            auto earliest = Clock::time_point::max();
+            for (const auto& [file, changed] : m_Files)
+                earliest = std::min(earliest, changed);
+
+            const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+              earliest + m_Debounce - Clock::now());
+            return static_cast<int>(std::max<std::chrono::milliseconds::rep>(0, wait.count()));
+        }
+
+        template<typename TCallback>
+        void Flush(const TCallback& callback) {
+            const auto now = Clock::now();
+            for (auto it = m_Files.begin(); it != m_Files.end();) {
+                if (now - it->second >= m_Debounce) {
+                    callback(it->first);
+                    it = m_Files.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+    private:
+        std::chrono::milliseconds m_Debounce;
+        std::map<std::filesystem::path, Clock::time_point> m_Files;
+    };
+}  // namespace
+
+#ifdef _WIN32
+
+FileWatcher::FileWatcher(const std::filesystem::path& directory,
+                         const std::chrono::milliseconds debounce,
+                         Callback onChanged)
+    : m_Debounce(debounce), m_OnChanged(std::move(onChanged)) {
+    m_hDirectory = ::CreateFileW(directory.c_str(),
+                                 FILE_LIST_DIRECTORY,
+                                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                 nullptr,
+                                 OPEN_EXISTING,
+                                 FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                                 nullptr);
+    if (m_hDirectory == INVALID_HANDLE_VALUE)
+        throw std::system_error(
+          std::error_code(static_cast<int>(::GetLastError()), std::system_category()),
+          "CreateFileW");
+
+    m_hStopEvent = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    m_Thread     = std::thread([this] { WatchMain(); });
+}
+
+FileWatcher::~FileWatcher() {
+    ::SetEvent(m_hStopEvent);
+    m_Thread.join();
+    ::CloseHandle(m_hStopEvent);
+    ::CloseHandle(m_hDirectory);
+}
+
+void FileWatcher::WatchMain() {
+    constexpr DWORD kFilter =
+      FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+    alignas(DWORD) std::byte buffer[16 * 1024];
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent     = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+    const auto issueRead = [&] {
+        ::ResetEvent(overlapped.hEvent);
+        return ::ReadDirectoryChangesW(
+          m_hDirectory, buffer, sizeof(buffer), FALSE, kFilter, nullptr, &overlapped, nullptr);
+    };
+
+    PendingChanges pending(m_Debounce);
+    bool reading = issueRead() != FALSE;
+    while (reading) {
+        const HANDLE handles[] = {overlapped.hEvent, m_hStopEvent};
+        const int timeout      = pending.GetTimeoutMs();
+        const DWORD result =
+          ::WaitForMultipleObjects(2, handles, FALSE, timeout < 0 ? INFINITE : DWORD(timeout));
+
+        if (result == WAIT_OBJECT_0) {
+            DWORD bytes = 0;
+            if (::GetOverlappedResult(m_hDirectory, &overlapped, &bytes, FALSE) && bytes) {
+                const std::byte* cursor = buffer;
+                for (;;) {
+                    const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+                    pending.Touch(
+                      std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+                    if (!info->NextEntryOffset)
+                        break;
+                    cursor += info->NextEntryOffset;
+                }
+            }
+            reading = issueRead() != FALSE;
+        } else if (result != WAIT_TIMEOUT) {
+            break;
+        }
+
+        pending.Flush(m_OnChanged);
+    }
+
+    ::CancelIoEx(m_hDirectory, &overlapped);
+    DWORD bytes = 0;
+    ::GetOverlappedResult(m_hDirectory, &overlapped, &bytes, TRUE);
+    ::CloseHandle(overlapped.hEvent);
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::filesystem::path& directory,
+                         const std::chrono::milliseconds debounce,
+                         Callback onChanged)
+    : m_Debounce(debounce), m_OnChanged(std::move(onChanged)) {
+    m_InotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_InotifyFd < 0)
+        throw std::system_error(std::error_code(errno, std::generic_category()), "inotify_init1");
+
+    constexpr uint32_t kMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY;
+    if (::inotify_add_watch(m_InotifyFd, directory.c_str(), kMask) < 0) {
+        const int error = errno;
+        ::close(m_InotifyFd);
+        throw std::system_error(std::error_code(error, std::generic_category()),
+                                "inotify_add_watch");
+    }
+
+    m_StopFd = ::eventfd(0, EFD_CLOEXEC);
+    if (m_StopFd < 0) {
+        const int error = errno;
+        ::close(m_InotifyFd);
+        throw std::system_error(std::error_code(error, std::generic_category()), "eventfd");
+    }
+    m_Thread = std::thread([this] { WatchMain(); });
+}
+
+FileWatcher::~FileWatcher() {
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto written = ::write(m_StopFd, &one, sizeof(one));
+    m_Thread.join();
+    ::close(m_StopFd);
+    ::close(m_InotifyFd);
+}
+
+void FileWatcher::WatchMain() {
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    PendingChanges pending(m_Debounce);
+    for (;;) {
+        pollfd fds[] = {{m_InotifyFd, POLLIN, 0}, {m_StopFd, POLLIN, 0}};
+        if (::poll(fds, 2, pending.GetTimeoutMs()) < 0 && errno != EINTR)
+            break;
+        if (fds[1].revents & POLLIN)
+            break;
+
+        if (fds[0].revents & POLLIN) {
+            ssize_t length;
+            while ((length = ::read(m_InotifyFd, buffer, sizeof(buffer))) > 0) {
+                for (char* cursor = buffer; cursor < buffer + length;) {
+                    const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+                    if (event->len && !(event->mask & IN_ISDIR))
+                        pending.Touch(event->name);
+                    cursor += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+
+        pending.Flush(m_OnChanged);
+    }
+}
+
+#endif
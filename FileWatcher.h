@@ -0,0 +1,44 @@
+//
+// FileWatcher.h - Debounced change notifications for the files in one directory
+//
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+/// Watches a directory (not recursively) on a background thread using inotify on Linux and
+/// ReadDirectoryChangesW on Windows. Editors usually save with several writes or a rename, so
+/// events for a file are coalesced until it has been quiet for the debounce interval; the
+/// callback then runs once, on the watcher thread, with the file's name relative to the directory.
+class FileWatcher {
+public:
+    using Callback = std::function<void(const std::filesystem::path& file)>;
+
+    /// Throws std::system_error if the directory cannot be watched.
+    FileWatcher(const std::filesystem::path& directory,
+                std::chrono::milliseconds debounce,
+                Callback onChanged);
+    ~FileWatcher();
+
+    FileWatcher(FileWatcher const&)            = delete;
+    FileWatcher& operator=(FileWatcher const&) = delete;
+
+private:
+    void WatchMain();
+
+    std::chrono::milliseconds m_Debounce;
+    Callback m_OnChanged;
+
+#ifdef _WIN32
+    void* m_hDirectory = nullptr;
+    void* m_hStopEvent = nullptr;
+#else
+    int m_InotifyFd = -1;
+    int m_StopFd    = -1;
+#endif
+
+    std::thread m_Thread;
+};
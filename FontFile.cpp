@@ -0,0 +1,87 @@
+//
+// FontFile.cpp - Parser for DirectXTK MakeSpriteFont (.font) files
+//
+
+#include "FontFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    constexpr char kMagic[8] = {'D', 'X', 'T', 'K', 'f', 'o', 'n', 't'};
+
+    class Reader {
+    public:
+        explicit Reader(const std::span<const std::byte> data) noexcept : m_Data(data) {}
+
+        template<typename T>
+        T Read() {
+            T value;
+            std::memcpy(&value, Take(sizeof(T)).data(), sizeof(T));
+            return value;
+        }
+
+        std::span<const std::byte> Take(const size_t size) {
+            if (m_Data.size() - m_Offset < size)
+                throw std::runtime_error("Font file is truncated");
+            const auto bytes = m_Data.subspan(m_Offset, size);
+            m_Offset += size;
+            return bytes;
+        }
+
+    private:
+        std::span<const std::byte> m_Data;
+        size_t m_Offset = 0;
+    };
+}  // namespace
+
+const FontGlyph* FontData::FindGlyph(const uint32_t character) const noexcept {
+    if (character < asciiLookup.size()) {
+        const int16_t index = asciiLookup[character];
+        return index >= 0 ? &glyphs[static_cast<size_t>(index)] : nullptr;
+    }
+
+    const auto it = std::lower_bound(
+      glyphs.begin(), glyphs.end(), character, [](const FontGlyph& glyph, const uint32_t c) {
+          return glyph.character < c;
+      });
+    return it != glyphs.end() && it->character == character ? &*it : nullptr;
+}
+
+FontData ParseFont(const std::span<const std::byte> file) {
+    Reader reader(file);
+    if (std::memcmp(reader.Take(sizeof(kMagic)).data(), kMagic, sizeof(kMagic)) != 0)
+        throw std::runtime_error("Not a sprite font file");
+
+    FontData font;
+
+    const auto glyphCount = reader.Read<uint32_t>();
+    const auto glyphBytes = reader.Take(size_t {glyphCount} * sizeof(FontGlyph));
+    font.glyphs.resize(glyphCount);
+    std::memcpy(font.glyphs.data(), glyphBytes.data(), glyphBytes.size());
+
+    font.lineSpacing      = reader.Read<float>();
+    font.defaultCharacter = reader.Read<uint32_t>();
+    font.textureWidth     = reader.Read<uint32_t>();
+    font.textureHeight    = reader.Read<uint32_t>();
+    font.textureFormat    = reader.Read<uint32_t>();
+    font.textureStride    = reader.Read<uint32_t>();
+    font.textureRows      = reader.Read<uint32_t>();
+
+    const auto texture = reader.Take(size_t {font.textureStride} * font.textureRows);
+    font.textureData.assign(texture.begin(), texture.end());
+
+    std::stable_sort(font.glyphs.begin(), font.glyphs.end(), [](const auto& a, const auto& b) {
+        return a.character < b.character;
+    });
+
+    font.asciiLookup.fill(-1);
+    for (size_t i = 0; i < font.glyphs.size(); ++i) {
+        const uint32_t c = font.glyphs[i].character;
+        if (c < font.asciiLookup.size())
+            font.asciiLookup[c] = static_cast<int16_t>(i);
+    }
+
+    return font;
+}
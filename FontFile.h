@@ -0,0 +1,46 @@
+//
+// FontFile.h - Parser for DirectXTK MakeSpriteFont (.font) files
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct FontGlyph {
+    uint32_t character;
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+    float xOffset;
+    float yOffset;
+    float xAdvance;
+};
+static_assert(sizeof(FontGlyph) == 32, "FontGlyph must match the on-disk glyph record");
+
+/// Glyph table and atlas texture of a sprite font. Glyphs are sorted by character, with a direct
+/// lookup table for ASCII so the common case of HUD text never searches.
+struct FontData {
+    std::vector<FontGlyph> glyphs;
+    std::array<int16_t, 128> asciiLookup;  // index into glyphs, or -1
+    float lineSpacing         = 0.f;
+    uint32_t defaultCharacter = 0;
+
+    // Atlas texture, in the DXGI format MakeSpriteFont wrote (typically BC2).
+    uint32_t textureWidth  = 0;
+    uint32_t textureHeight = 0;
+    uint32_t textureFormat = 0;
+    uint32_t textureStride = 0;
+    uint32_t textureRows   = 0;
+    std::vector<std::byte> textureData;
+
+    /// Returns nullptr if the font has no glyph for `character`.
+    const FontGlyph* FindGlyph(uint32_t character) const noexcept;
+};
+
+/// Throws std::runtime_error if `file` is not a well-formed .font file.
+FontData ParseFont(std::span<const std::byte> file);
@@ -0,0 +1,75 @@
+//
+// FrameArena.cpp - Double-buffered bump allocator for data that lives for one frame
+//
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <new>
+
+namespace {
+    // Buffers start on a cache line so SIMD-friendly arrays can be carved from them
+    constexpr std::align_val_t kBufferAlignment {64};
+}  // namespace
+
+FrameArena::FrameArena(const size_t capacityPerFrame) : m_Capacity(capacityPerFrame) {
+    for (auto& frame : m_Frames)
+        frame.pBuffer = static_cast<std::byte*>(::operator new(m_Capacity, kBufferAlignment));
+    m_Stats.capacity = m_Capacity;
+}
+
+FrameArena::~FrameArena() {
+    for (auto& frame : m_Frames) {
+        Release(frame);
+        ::operator delete(frame.pBuffer, kBufferAlignment);
+    }
+}
+
+void FrameArena::BeginFrame() noexcept {
+    const Frame& finished = m_Frames[m_Current];
+    m_Stats.used          = finished.offset + finished.overflow;
+    m_Stats.overflow      = finished.overflow;
+    m_Stats.allocations   = finished.allocations;
+    m_Stats.highWater     = std::max(m_Stats.highWater, m_Stats.used);
+
+    m_Current ^= 1;
+    Release(m_Frames[m_Current]);
+}
+
+void* FrameArena::Allocate(const size_t bytes, const size_t alignment) {
+    Frame& frame = m_Frames[m_Current];
+    frame.allocations++;
+
+    const size_t offset = (frame.offset + alignment - 1) & ~(alignment - 1);
+    if (offset <= m_Capacity && bytes <= m_Capacity - offset) {
+        frame.offset = offset + bytes;
+        return frame.pBuffer + offset;
+    }
+
+    frame.heapBlocks.reserve(frame.heapBlocks.size() + 1);
+    void* p = ::operator new(bytes, std::align_val_t {alignment});
+    frame.heapBlocks.emplace_back(p, alignment);
+    frame.overflow += bytes;
+    return p;
+}
+
+void FrameArena::Release(Frame& frame) noexcept {
+    for (const auto& [p, alignment] : frame.heapBlocks)
+        ::operator delete(p, std::align_val_t {alignment});
+    frame.heapBlocks.clear();
+    frame.offset      = 0;
+    frame.overflow    = 0;
+    frame.allocations = 0;
+}
+
+void* FrameArena::do_allocate(const size_t bytes, const size_t alignment) {
+    return Allocate(bytes, alignment);
+}
+
+void FrameArena::do_deallocate(void*, size_t, size_t) {
+    // Memory is reclaimed wholesale when the frame's buffer comes around again
+}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,74 @@
+//
+// FrameArena.h - Double-buffered bump allocator for data that lives for one frame
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+struct FrameArenaStats {
+    size_t capacity      = 0;  // bytes per frame buffer
+    size_t used          = 0;  // bytes allocated during the last completed frame
+    size_t highWater     = 0;  // most bytes any frame has allocated, overflow included
+    size_t overflow      = 0;  // bytes the last completed frame had to take from the heap
+    uint32_t allocations = 0;  // allocations made during the last completed frame
+};
+
+/// Bump allocator over two fixed buffers that alternate every frame. BeginFrame() switches to
+/// the other buffer and releases everything allocated into it two frames ago, so transient data
+/// may be read until the end of the following frame. Deallocation is a no-op.
+///
+/// Allocations that do not fit fall back to the heap and are freed with their frame; they are
+/// reported as overflow so the capacity can be tuned. Not thread-safe: use it from the thread
+/// that drives the frame.
+class FrameArena final : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t capacityPerFrame);
+    ~FrameArena() override;
+
+    FrameArena(FrameArena const&)            = delete;
+    FrameArena& operator=(FrameArena const&) = delete;
+
+    void BeginFrame() noexcept;
+
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    template<typename T>
+    T* AllocateArray(const size_t count) {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /// Bytes allocated so far in the current frame.
+    size_t GetUsed() const noexcept {
+        return m_Frames[m_Current].offset + m_Frames[m_Current].overflow;
+    }
+
+    const FrameArenaStats& GetStats() const noexcept {
+        return m_Stats;
+    }
+
+private:
+    struct Frame {
+        std::byte* pBuffer   = nullptr;
+        size_t offset        = 0;
+        size_t overflow      = 0;
+        uint32_t allocations = 0;
+        std::vector<std::pair<void*, size_t>> heapBlocks;  // pointer, alignment
+    };
+
+    void Release(Frame& frame) noexcept;
+
+    // std::pmr::memory_resource
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    size_t m_Capacity;
+    Frame m_Frames[2];
+    int m_Current = 0;
+    FrameArenaStats m_Stats;
+};
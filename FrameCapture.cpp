@@ -0,0 +1,278 @@
+//
+// FrameCapture.cpp - Streams rendered frames to disk from a background thread
+//
+
+#include "FrameCapture.h"
+#include "Image.h"
+#include "Png.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <Windows.h>
+#else
+    #include <sys/resource.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    // Bigger writes mean fewer system calls; a 720p Y4M frame is about 1.4 MB
+    constexpr size_t kFileBufferSize = 1 << 20;
+
+    // PNG sequences favour encoding speed over size
+    constexpr uint32_t kPngMaxChain = 8;
+
+    // BT.601 studio range, the Y4M default, in 8.8 fixed point
+    uint8_t GetLuma(const int r, const int g, const int b) noexcept {
+        return static_cast<uint8_t>(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+    }
+    uint8_t GetBlueDifference(const int r, const int g, const int b) noexcept {
+        return static_cast<uint8_t>(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+    }
+    uint8_t GetRedDifference(const int r, const int g, const int b) noexcept {
+        return static_cast<uint8_t>(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+    }
+
+    // Paths reach the C runtime as wide characters on Windows and messages as UTF-8, never
+    // through the ANSI code page, which cannot hold every folder name a user may have
+    FILE* OpenForWriting(const std::filesystem::path& path) {
+#ifdef _WIN32
+        return _wfopen(path.c_str(), L"wb");
+#else
+        return std::fopen(path.c_str(), "wb");
+#endif
+    }
+
+    std::string ToUtf8(const std::filesystem::path& path) {
+        const std::u8string name = path.u8string();
+        return std::string(name.begin(), name.end());
+    }
+
+    std::string GetPngName(const uint32_t index) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%06u.png", index);
+        return name;
+    }
+}  // namespace
+
+FrameCapture::FrameCapture(const CaptureOptions& options) : m_Options(options) {
+    if (!options.width || !options.height)
+        throw std::invalid_argument("Capture size must be non-zero");
+    if (!options.bufferCount || options.bufferCount > kMaxBuffers)
+        throw std::invalid_argument("Capture buffer count must be 1 to " +
+                                    std::to_string(kMaxBuffers));
+
+    if (options.format == CaptureFormat::Y4m) {
+        m_pFile = OpenForWriting(options.path);
+        if (!m_pFile)
+            throw std::runtime_error("Failed to create " + ToUtf8(options.path));
+        std::setvbuf(m_pFile, nullptr, _IOFBF, kFileBufferSize);
+        std::fprintf(m_pFile,
+                     "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n",
+                     options.width,
+                     options.height,
+                     options.frameRate);
+
+        const size_t chromaSize = size_t {(options.width + 1) / 2} * ((options.height + 1) / 2);
+        m_Planes.resize(size_t {options.width} * options.height + chromaSize * 2);
+    } else {
+        std::error_code error;
+        std::filesystem::create_directories(options.path, error);
+        if (error)
+            throw std::runtime_error("Failed to create " + ToUtf8(options.path));
+        m_pEncoders = std::make_unique<JobSystem>(options.encoders);
+    }
+
+    m_Buffers.resize(options.bufferCount);
+    for (uint32_t buffer = 0; buffer < options.bufferCount; ++buffer) {
+        m_Buffers[buffer].resize(size_t {options.width} * options.height);
+        m_Free.TryPush(buffer);
+    }
+
+    m_Thread = std::thread(&FrameCapture::WriterMain, this);
+}
+
+FrameCapture::~FrameCapture() {
+    m_Stopping.store(true, std::memory_order_release);
+    m_Wake.release();
+    m_Thread.join();
+    if (m_pFile)
+        std::fclose(m_pFile);
+}
+
+bool FrameCapture::Submit(const void* pPixels, const uint32_t rowPitch) noexcept {
+    m_Submitted.fetch_add(1, std::memory_order_relaxed);
+    uint32_t buffer;
+    if (m_Failed.load(std::memory_order_relaxed) || !m_Free.TryPop(buffer)) {
+        m_Dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const auto* pSource   = static_cast<const uint8_t*>(pPixels);
+    uint32_t* pDest       = m_Buffers[buffer].data();
+    const size_t rowBytes = size_t {m_Options.width} * sizeof(uint32_t);
+    for (uint32_t y = 0; y < m_Options.height; ++y, pSource += rowPitch, pDest += m_Options.width)
+        std::memcpy(pDest, pSource, rowBytes);
+
+    // Never full: only bufferCount frames exist
+    m_Queued.TryPush({buffer, m_NextIndex++});
+    m_Wake.release();
+    return true;
+}
+
+CaptureStats FrameCapture::GetStats() const noexcept {
+    return {
+      m_Submitted.load(std::memory_order_relaxed),
+      m_Written.load(std::memory_order_relaxed),
+      m_Dropped.load(std::memory_order_relaxed),
+    };
+}
+
+std::optional<std::string> FrameCapture::GetError() const {
+    std::lock_guard lock(m_ErrorMutex);
+    return m_Error;
+}
+
+void FrameCapture::SetError(const std::string& message) {
+    std::lock_guard lock(m_ErrorMutex);
+    if (!m_Error)
+        m_Error = message;
+    m_Failed.store(true, std::memory_order_relaxed);
+}
+
+void FrameCapture::WriterMain() noexcept {
+    // Submit wakes the writer, which at normal priority may take over the core before Submit has
+    // even returned, and convert and write the whole frame on the rendering thread's time. The
+    // writer only has to keep up on average, with bufferCount frames of slack.
+#ifdef _WIN32
+    ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#else
+    ::setpriority(PRIO_PROCESS, static_cast<id_t>(::gettid()), 10);
+#endif
+
+    QueuedFrame frames[kMaxBuffers];
+    for (;;) {
+        // Read before draining, so every frame queued ahead of the destructor is written
+        const bool stopping = m_Stopping.load(std::memory_order_acquire);
+        uint32_t count      = 0;
+        while (count < kMaxBuffers && m_Queued.TryPop(frames[count]))
+            ++count;
+        if (!count) {
+            if (stopping)
+                break;
+            m_Wake.acquire();
+            continue;
+        }
+
+        if (!m_Failed.load(std::memory_order_relaxed)) {
+            try {
+                if (m_Options.format == CaptureFormat::Y4m) {
+                    for (uint32_t i = 0; i < count; ++i)
+                        WriteY4mFrame(m_Buffers[frames[i].buffer]);
+                } else {
+                    WritePngFrames(frames, count);
+                }
+            } catch (const std::exception& e) {
+                SetError(e.what());
+            }
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+            m_Free.TryPush(frames[i].buffer);
+    }
+
+    if (m_pFile && std::fflush(m_pFile) != 0)
+        SetError("Failed to write " + ToUtf8(m_Options.path));
+}
+
+void FrameCapture::WriteY4mFrame(const std::vector<uint32_t>& pixels) {
+    const uint32_t width       = m_Options.width;
+    const uint32_t height      = m_Options.height;
+    const uint32_t chromaWidth = (width + 1) / 2;
+    uint8_t* pLuma             = m_Planes.data();
+    uint8_t* pBlue             = pLuma + size_t {width} * height;
+    uint8_t* pRed              = pBlue + size_t {chromaWidth} * ((height + 1) / 2);
+
+    // Each chroma sample averages a 2x2 block, repeating the last row or column when odd
+    for (uint32_t y = 0; y < height; y += 2) {
+        const uint32_t* pRow0 = pixels.data() + size_t {y} * width;
+        const uint32_t* pRow1 = y + 1 < height ? pRow0 + width : pRow0;
+        uint8_t* pLuma0       = pLuma + size_t {y} * width;
+        uint8_t* pLuma1       = y + 1 < height ? pLuma0 + width : pLuma0;
+        const size_t chroma   = size_t {y / 2} * chromaWidth;
+        for (uint32_t x = 0; x < width; x += 2) {
+            const uint32_t x1      = std::min(x + 1, width - 1);
+            const uint32_t quad[4] = {pRow0[x], pRow0[x1], pRow1[x], pRow1[x1]};
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            for (int i = 0; i < 4; ++i) {
+                const int pr = static_cast<int>(quad[i] >> 16 & 0xFF);
+                const int pg = static_cast<int>(quad[i] >> 8 & 0xFF);
+                const int pb = static_cast<int>(quad[i] & 0xFF);
+                r += pr;
+                g += pg;
+                b += pb;
+                uint8_t* pOut = (i < 2 ? pLuma0 : pLuma1) + (i & 1 ? x1 : x);
+                *pOut         = GetLuma(pr, pg, pb);
+            }
+            r = (r + 2) >> 2;
+            g = (g + 2) >> 2;
+            b = (b + 2) >> 2;
+            pBlue[chroma + x / 2] = GetBlueDifference(r, g, b);
+            pRed[chroma + x / 2]  = GetRedDifference(r, g, b);
+        }
+    }
+
+    static constexpr char kFrameHeader[] = "FRAME\n";
+    constexpr size_t kFrameHeaderSize    = sizeof(kFrameHeader) - 1;
+    if (std::fwrite(kFrameHeader, 1, kFrameHeaderSize, m_pFile) != kFrameHeaderSize ||
+        std::fwrite(m_Planes.data(), 1, m_Planes.size(), m_pFile) != m_Planes.size())
+        throw std::runtime_error("Failed to write " + ToUtf8(m_Options.path));
+    m_Written.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameCapture::WritePngFrames(const QueuedFrame* pFrames, const uint32_t count) {
+    // One job per frame; the files are independent, so they finish in any order
+    for (uint32_t i = 0; i < count; ++i) {
+        const QueuedFrame frame = pFrames[i];
+        m_pEncoders->Submit([this, frame] {
+            try {
+                const std::vector<uint32_t>& pixels = m_Buffers[frame.buffer];
+                Image image;
+                image.width  = m_Options.width;
+                image.height = m_Options.height;
+                image.pixels.resize(pixels.size() * 4);
+                for (size_t p = 0; p < pixels.size(); ++p) {
+                    image.pixels[p * 4]     = static_cast<uint8_t>(pixels[p] >> 16);
+                    image.pixels[p * 4 + 1] = static_cast<uint8_t>(pixels[p] >> 8);
+                    image.pixels[p * 4 + 2] = static_cast<uint8_t>(pixels[p]);
+                    image.pixels[p * 4 + 3] = 255;  // the swap chain's alpha is not meaningful
+                }
+
+                const std::vector<std::byte> file = EncodePng(image, kPngMaxChain);
+                const std::filesystem::path path  = m_Options.path / GetPngName(frame.index);
+                std::ofstream output(path, std::ios::binary | std::ios::trunc);
+                output.write(reinterpret_cast<const char*>(file.data()),
+                             static_cast<std::streamsize>(file.size()));
+                if (!output)
+                    throw std::runtime_error("Failed to write " + ToUtf8(path));
+                m_Written.fetch_add(1, std::memory_order_relaxed);
+            } catch (const std::exception& e) {
+                SetError(e.what());
+            }
+        });
+    }
+    m_pEncoders->WaitIdle();
+}
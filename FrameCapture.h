@@ -0,0 +1,112 @@
+//
+// FrameCapture.h - Streams rendered frames to disk from a background thread
+//
+// Submit copies a frame into one of a fixed pool of buffers and queues it; a writer thread
+// streams the queued frames to a Y4M video or a numbered PNG sequence and hands the buffers back.
+// The rendering thread never waits on the disk or the encoder: when every buffer is still
+// queued, the frame is dropped and counted instead.
+//
+
+#pragma once
+
+#include "JobSystem.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class CaptureFormat : uint8_t {
+    Y4m,          // one .y4m file, 8-bit 4:2:0 BT.601 at a constant frame rate
+    PngSequence,  // <path>/frame_000000.png onwards, compressed on several threads
+};
+
+struct CaptureOptions {
+    CaptureFormat format = CaptureFormat::Y4m;
+    std::filesystem::path path;  // the .y4m file, or the directory for the PNG sequence
+    uint32_t width       = 0;
+    uint32_t height      = 0;
+    uint32_t frameRate   = 60;  // written to the Y4M header
+    uint32_t bufferCount = 8;   // frames that may be in flight, at most kMaxBuffers
+    unsigned encoders    = JobSystem::GetDefaultWorkerCount();  // PNG compression threads
+};
+
+struct CaptureStats {
+    uint64_t submitted = 0;  // frames passed to Submit, dropped ones included
+    uint64_t written   = 0;
+    uint64_t dropped   = 0;  // every buffer was queued, or the writer had failed
+};
+
+class FrameCapture {
+public:
+    static constexpr uint32_t kMaxBuffers = 64;
+
+    /// Creates the output file or directory and starts the writer. Throws std::invalid_argument
+    /// for a zero size or buffer count and std::runtime_error if the output cannot be created.
+    explicit FrameCapture(const CaptureOptions& options);
+    /// Writes every frame already queued, then closes the output.
+    ~FrameCapture();
+
+    FrameCapture(FrameCapture const&)            = delete;
+    FrameCapture& operator=(FrameCapture const&) = delete;
+
+    /// Copies a frame of 0xAARRGGBB pixels (B, G, R, A in memory, as in a B8G8R8A8 texture),
+    /// `rowPitch` bytes apart, and queues it. Returns false if the frame was dropped. Call from
+    /// one thread only.
+    bool Submit(const void* pPixels, uint32_t rowPitch) noexcept;
+
+    CaptureStats GetStats() const noexcept;
+
+    /// The first write or encode error; the writer drops every frame after one.
+    std::optional<std::string> GetError() const;
+
+    uint32_t GetWidth() const noexcept {
+        return m_Options.width;
+    }
+    uint32_t GetHeight() const noexcept {
+        return m_Options.height;
+    }
+
+private:
+    struct QueuedFrame {
+        uint32_t buffer;
+        uint32_t index;  // position in the output, counting only frames that were queued
+    };
+
+    void WriterMain() noexcept;
+    void WriteY4mFrame(const std::vector<uint32_t>& pixels);
+    void WritePngFrames(const QueuedFrame* pFrames, uint32_t count);
+    void SetError(const std::string& message);
+
+    CaptureOptions m_Options;
+    std::vector<std::vector<uint32_t>> m_Buffers;
+
+    // Buffer indices travel to the writer through m_Queued and back through m_Free
+    SpscQueue<QueuedFrame, kMaxBuffers> m_Queued;
+    SpscQueue<uint32_t, kMaxBuffers> m_Free;
+    uint32_t m_NextIndex = 0;
+
+    std::atomic<uint64_t> m_Submitted {0};
+    std::atomic<uint64_t> m_Written {0};
+    std::atomic<uint64_t> m_Dropped {0};
+    std::atomic<bool> m_Failed {false};
+    mutable std::mutex m_ErrorMutex;
+    std::optional<std::string> m_Error;
+
+    // Writer thread state
+    FILE* m_pFile = nullptr;
+    std::vector<uint8_t> m_Planes;           // one Y4M frame: Y, then Cb, then Cr
+    std::unique_ptr<JobSystem> m_pEncoders;  // PNG sequences only
+
+    std::counting_semaphore<> m_Wake {0};  // released once per queued frame
+    std::atomic<bool> m_Stopping {false};
+    std::thread m_Thread;
+};
@@ -0,0 +1,140 @@
+//
+// FrameScheduler.cpp - Just-in-time frame starts ahead of the vblank deadline
+//
+
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    constexpr const char* kTraceHeader = "start,submit,vblank,period";
+
+    // While frames make their vblank, each one takes this fraction off the excess margin
+    constexpr int64_t kMarginDecay = 32;
+}  // namespace
+
+FrameScheduler::FrameScheduler(const FrameSchedulerOptions& options)
+    : m_Options(options), m_Margin(options.minMargin) {
+    if (options.history == 0 || !(options.quantile >= 0.f && options.quantile <= 1.f) ||
+        options.minMargin < 0 || options.maxMargin < options.minMargin ||
+        !(options.spikeFactor >= 0.f))
+        throw std::invalid_argument("Invalid frame scheduler options");
+
+    m_Costs.reserve(options.history);
+    m_Sorted.reserve(options.history);
+    m_Stats.margin = m_Margin;
+}
+
+void FrameScheduler::SetVblank(const int64_t time, const int64_t period) noexcept {
+    m_VblankTime   = time;
+    m_VblankPeriod = period;
+}
+
+int64_t FrameScheduler::GetNextVblank(const int64_t time) const noexcept {
+    // Division truncates towards zero, which rounds up for vblanks after `time`
+    const int64_t offset = time - m_VblankTime;
+    int64_t periods      = offset / m_VblankPeriod;
+    if (periods * m_VblankPeriod < offset)
+        periods++;
+    return m_VblankTime + periods * m_VblankPeriod;
+}
+
+int64_t FrameScheduler::GetFrameStart(const int64_t now) const noexcept {
+    // Without vsync there is nothing to aim at, and without a frame's cost nothing to aim with
+    if (m_VblankPeriod <= 0 || m_Stats.frames == 0)
+        return now;
+
+    // Aim at the first vblank the frame could make. Holding it back past that one would drop a
+    // vblank on purpose, so a frame that needs longer than the wait starts at once.
+    const int64_t target = GetNextVblank(now + 1);
+    return std::max(now, target - GetLead());
+}
+
+int64_t FrameScheduler::GetLead() const noexcept {
+    const auto spikeLead = static_cast<int64_t>(
+      static_cast<double>(m_Stats.predictedCost) * static_cast<double>(m_Options.spikeFactor));
+    return std::max(m_Stats.predictedCost + m_Margin, spikeLead);
+}
+
+void FrameScheduler::BeginFrame(const int64_t time) noexcept {
+    m_FrameStart  = time;
+    m_FrameTarget = m_VblankPeriod > 0 ? GetNextVblank(time + GetLead()) : 0;
+}
+
+void FrameScheduler::EndFrame(const int64_t time) {
+    const int64_t cost = time - m_FrameStart;
+    if (m_Costs.size() < m_Options.history)
+        m_Costs.push_back(cost);
+    else
+        m_Costs[m_NextCost] = cost;
+    m_NextCost = (m_NextCost + 1) % m_Options.history;
+
+    m_Sorted.assign(m_Costs.begin(), m_Costs.end());
+    const auto rank = static_cast<size_t>(
+      std::lround(m_Options.quantile * static_cast<float>(m_Sorted.size() - 1)));
+    std::nth_element(m_Sorted.begin(), m_Sorted.begin() + rank, m_Sorted.end());
+
+    m_Stats.frames++;
+    m_Stats.predictedCost = m_Sorted[rank];
+    if (m_FrameTarget) {
+        // A miss means the cost or the margin was underestimated: grow the margin by at least
+        // the overrun and keep it for a while, then creep back towards the minimum while frames
+        // make it
+        m_Stats.lastSlack = m_FrameTarget - time;
+        if (m_Stats.lastSlack < 0) {
+            m_Stats.missed++;
+            m_Margin     = std::clamp(std::max(m_Margin * 2, m_Margin - m_Stats.lastSlack),
+                                  m_Options.minMargin,
+                                  m_Options.maxMargin);
+            m_HoldFrames = m_Options.holdFrames;
+        } else if (m_HoldFrames > 0) {
+            m_HoldFrames--;
+        } else {
+            m_Margin -= (m_Margin - m_Options.minMargin) / kMarginDecay;
+        }
+        m_Stats.margin = m_Margin;
+    }
+}
+
+void WriteFrameTrace(const std::filesystem::path& path, const std::span<const FrameRecord> frames) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Failed to create " + path.string());
+
+    file << kTraceHeader << '\n';
+    for (const FrameRecord& frame : frames)
+        file << frame.start << ',' << frame.submit << ',' << frame.vblank << ',' << frame.period
+             << '\n';
+    if (!file)
+        throw std::runtime_error("Failed to write " + path.string());
+}
+
+std::vector<FrameRecord> ReadFrameTrace(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    if (!file)
+        throw std::runtime_error("Failed to open " + path.string());
+
+    std::string line;
+    if (!std::getline(file, line) || line != kTraceHeader)
+        throw std::runtime_error(path.string() + " is not a frame trace");
+
+    std::vector<FrameRecord> frames;
+    while (std::getline(file, line)) {
+        if (line.empty())
+            continue;
+        FrameRecord frame;
+        char separators[3] = {};
+        std::istringstream fields(line);
+        fields >> frame.start >> separators[0] >> frame.submit >> separators[1] >> frame.vblank >>
+          separators[2] >> frame.period;
+        if (!fields || separators[0] != ',' || separators[1] != ',' || separators[2] != ',')
+            throw std::runtime_error("Malformed frame in " + path.string() + ": " + line);
+        frames.push_back(frame);
+    }
+    return frames;
+}
@@ -0,0 +1,109 @@
+//
+// FrameScheduler.h - Just-in-time frame starts ahead of the vblank deadline
+//
+// With vsync, a loop that starts each frame right after the previous Present returns samples
+// input up to a whole refresh before the frame can be shown. The scheduler instead predicts the
+// next frame's cost from recent frames and delays its start so the work ends just before a
+// vblank, keeping a safety margin that grows after a missed deadline and shrinks back once
+// frames have made it for a while. The lead also leaves room for a spike of twice the predicted
+// cost, and a frame is never held back past the first vblank it could make, so the delay only
+// moves input sampling later and does not drop frames that starting at once would have shown.
+//
+// Times are GetInputTime() nanoseconds. Nothing here touches the platform, so the prediction can
+// be replayed against recorded frame traces (see PongSchedulerBench).
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+struct FrameSchedulerOptions {
+    float quantile   = 0.95f;  // of the recent frame costs, taken as the next frame's cost
+    uint32_t history = 120;    // frames the quantile is taken over
+    // Nanoseconds of slack left between the end of a frame's work and its vblank
+    int64_t minMargin = 500'000;
+    int64_t maxMargin = 4'000'000;
+    // Frames after a miss before the margin starts shrinking again. Spikes come in bursts and
+    // recur, so dropping the margin straight away only sets up the next miss.
+    uint32_t holdFrames = 600;
+    // The lead is never less than this multiple of the predicted cost, so a frame that takes
+    // twice as long as usual still makes its vblank, as it would have started at once
+    float spikeFactor = 2.f;
+};
+
+/// What the scheduler has done so far.
+struct FrameSchedulerStats {
+    uint64_t frames       = 0;
+    uint64_t missed       = 0;  // frames that ended after the vblank they were aimed at
+    int64_t predictedCost = 0;
+    int64_t margin        = 0;
+    int64_t lastSlack     = 0;  // time left before its vblank when the last frame ended
+};
+
+class FrameScheduler {
+public:
+    explicit FrameScheduler(const FrameSchedulerOptions& options = {});
+
+    /// The time of a recent vblank and the refresh period. Until this is called, or with a zero
+    /// period, frames start as soon as they are asked for.
+    void SetVblank(int64_t time, int64_t period) noexcept;
+
+    /// When the next frame should start, at `now` or later: the latest time from which the lead
+    /// still ends before the first vblank after `now`. Frames start at once until one has been
+    /// timed. Does not change any state.
+    int64_t GetFrameStart(int64_t now) const noexcept;
+
+    /// Starts a frame at `time`, aiming at the first vblank it can make.
+    void BeginFrame(int64_t time) noexcept;
+
+    /// Ends the frame begun last, once its work has been submitted, and updates the prediction.
+    void EndFrame(int64_t time);
+
+    int64_t GetVblankTime() const noexcept {
+        return m_VblankTime;
+    }
+    int64_t GetVblankPeriod() const noexcept {
+        return m_VblankPeriod;
+    }
+    const FrameSchedulerStats& GetStats() const noexcept {
+        return m_Stats;
+    }
+
+private:
+    /// The first vblank at or after `time`.
+    int64_t GetNextVblank(int64_t time) const noexcept;
+    /// How long before its vblank a frame starts.
+    int64_t GetLead() const noexcept;
+
+    FrameSchedulerOptions m_Options;
+    int64_t m_VblankTime   = 0;
+    int64_t m_VblankPeriod = 0;
+
+    int64_t m_FrameStart  = 0;
+    int64_t m_FrameTarget = 0;  // vblank the current frame is aimed at, or 0 if unscheduled
+    int64_t m_Margin;
+    uint32_t m_HoldFrames = 0;  // left before the margin may shrink
+
+    std::vector<int64_t> m_Costs;  // ring buffer of the last m_Options.history costs
+    std::vector<int64_t> m_Sorted;
+    uint32_t m_NextCost = 0;
+
+    FrameSchedulerStats m_Stats;
+};
+
+/// One frame of a recorded trace.
+struct FrameRecord {
+    int64_t start;   // work began
+    int64_t submit;  // work was handed to Present
+    int64_t vblank;  // the latest vblank known when the frame began
+    int64_t period;  // refresh period at the time, 0 if unknown
+};
+
+/// Writes a trace as CSV, one frame per line after a header. Throws std::runtime_error on failure.
+void WriteFrameTrace(const std::filesystem::path& path, std::span<const FrameRecord> frames);
+
+/// Reads a trace written by WriteFrameTrace. Throws std::runtime_error if it cannot be read.
+std::vector<FrameRecord> ReadFrameTrace(const std::filesystem::path& path);
@@ -4,8 +4,16 @@
 
 #include "pch.h"
 #include "Game.h"
+#include "Palette.h"
+#include "Png.h"
+#include "Utf.h"
 
-#include <chrono>
+#include <dwmapi.h>
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
 
 using namespace DirectX;
 
@@ -15,12 +23,154 @@ static float g_FrameRate           = 0.f;
 static int g_FrameCount            = 0;
 static constexpr float kUpdateFreq = 0.8f;  // 80% current frame rate
 
-Game::Game() noexcept(false) {
+static constexpr auto kAssetPackName    = L"data.pak";
+static constexpr size_t kFrameArenaSize = 256 * 1024;
+
+// Edits are usually several writes or a rename; wait for the file to settle before reloading
+static constexpr std::chrono::milliseconds kAssetReloadDebounce(250);
+
+// The sim runs in fixed ticks; after a stall it catches up by at most kMaxTicksPerFrame
+static constexpr std::chrono::nanoseconds kSimTick(1'000'000'000 / 120);
+static constexpr float kSimTickSeconds     = std::chrono::duration<float>(kSimTick).count();
+static constexpr uint32_t kMaxTicksPerFrame = 12;
+
+// Ten minutes of frame timings at 60 Hz, about 1 MB
+static constexpr size_t kMaxTraceFrames = 36000;
+static constexpr auto kFrameTraceName   = L"frametrace.csv";
+
+// 48 kHz stereo; the ring holds about 40 ms and the mixer refills it 5 ms at a time
+static constexpr uint32_t kAudioSampleRate  = 48000;
+static constexpr uint32_t kAudioVoices      = 32;
+static constexpr uint32_t kAudioRingSize    = 4096;
+static constexpr uint32_t kAudioBlockFrames = 240;
+
+// Y4M has one frame rate for the whole file; frames are presented at the display's, usually 60 Hz
+static constexpr uint32_t kCaptureFrameRate = 60;
+static constexpr auto kCaptureName          = L"capture.y4m";
+
+// The match is kept here while the game is suspended, in case Windows ends the process
+static constexpr auto kSuspendSnapshotName = L"suspended.snap";
+
+static std::filesystem::path GetExecutableDirectory() {
+    wchar_t path[MAX_PATH] = {};
+    ::GetModuleFileNameW(nullptr, path, MAX_PATH);
+    return std::filesystem::path(path).parent_path();
+}
+
+// 0xAARRGGBB scaled by `fade`, premultiplied for SpriteBatch's default blend state
+static XMVECTOR PremultiplyColor(const uint32_t color, const float fade) {
+    const float alpha = static_cast<float>(color >> 24) / 255.f * fade;
+    const float scale = alpha / 255.f;
+    return XMVectorSet(static_cast<float>((color >> 16) & 0xFF) * scale,
+                       static_cast<float>((color >> 8) & 0xFF) * scale,
+                       static_cast<float>(color & 0xFF) * scale,
+                       alpha);
+}
+
+static std::vector<std::byte> ReadLooseFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        throw std::runtime_error("Failed to open " + path.string());
+
+    std::vector<std::byte> bytes(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file)
+        throw std::runtime_error("Failed to read " + path.string());
+    return bytes;
+}
+
+static void WriteLooseFile(const std::filesystem::path& path,
+                           const std::span<const std::byte> bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+    if (!file)
+        throw std::runtime_error("Failed to write " + path.string());
+}
+
+static std::vector<SpriteFont::Glyph> ToSpriteFontGlyphs(const FontData& font) {
+    std::vector<SpriteFont::Glyph> glyphs(font.glyphs.size());
+    std::transform(
+      font.glyphs.begin(), font.glyphs.end(), glyphs.begin(), [](const FontGlyph& g) {
+          return SpriteFont::Glyph {
+            g.character,
+            {g.left, g.top, g.right, g.bottom},
+            g.xOffset,
+            g.yOffset,
+            g.xAdvance,
+          };
+      });
+    return glyphs;
+}
+
+// A sprite's collision mask at its size in court units, built once its texture has loaded
+static AssetHandle<CollisionMask> LoadCollisionMask(AssetLoader& loader,
+                                                    const AssetHandle<TextureData>& texture,
+                                                    const float width,
+                                                    const float height) {
+    return loader.Load(
+      [width, height](const TextureData& data) {
+          return CollisionMask::FromTexture(
+            data, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+      },
+      texture);
+}
+
+// Moves a completed reload into `current`. A failed reload (typically a file caught half
+// written) is reported and dropped, leaving the asset already on screen in place.
+template<typename T>
+static bool TakeReload(AssetHandle<T>& reload, AssetHandle<T>& current) {
+    if (!reload.IsComplete())
+        return false;
+
+    try {
+        reload.Get();
+    } catch (const std::exception& e) {
+        char buff[256] = {};
+        sprintf_s(buff, "WARNING: Asset reload failed: %s\n", e.what());
+        OutputDebugStringA(buff);
+        reload.Reset();
+        return false;
+    }
+
+    current = std::move(reload);
+    return true;
+}
+
+Game::Game(const GameOptions& options) noexcept(false)
+    : m_FrameArena(kFrameArenaSize),
+      m_Loader(m_Jobs),
+      m_Sim(&m_Jobs, options.sim),
+      m_SimOptions(options.sim),
+      m_InputTimeline(kSimTick),
+      m_LateLatch(options.lateLatch),
+      m_Pipeline(kSimTick, [this](SimFrame& frame, float seconds) { UpdateSim(frame, seconds); }),
+      m_Pipelined(options.pipelined),
+      m_CapturePath(options.capturePath),
+      m_Sounds(kAudioSampleRate),
+      m_AudioMixer(kAudioSampleRate, kAudioVoices),
+      m_AudioRing(kAudioRingSize),
+      m_SoundEnabled(options.sound) {
     m_pDeviceResources = std::make_unique<DX::DeviceResources>();
     m_pDeviceResources->RegisterDeviceNotify(this);
 }
 
+Game::~Game() {
+    // The pipeline's updates use m_Jobs, which is destroyed first
+    m_Pipeline.Stop();
+}
+
 void Game::Initialize(HWND window, const int width, const int height) {
+    m_InitializeTime = std::chrono::steady_clock::now();
+
+    m_Assets.Open(GetExecutableDirectory() / kAssetPackName);
+    StartAssetLoads();
+    WatchAssets();
+
+    RestoreSuspendedMatch();
+    m_Sim.SaveSnapshot(m_RecordingStart);
+
     m_pDeviceResources->SetWindow(window, width, height);
 
     m_pDeviceResources->CreateDeviceResources();
@@ -30,9 +180,39 @@ void Game::Initialize(HWND window, const int width, const int height) {
     CreateWindowSizeDependentResources();
 
     CreateD2DResources();
+    if (m_SoundEnabled)
+        StartAudio();
+    if (!m_CapturePath.empty())
+        StartCapture();
+
+    m_InputTimeline.Start(GetInputTime());
+    if (m_Pipelined)
+        m_Pipeline.Start();
+}
+
+void Game::StartAudio() {
+    try {
+        m_pAudioThread =
+          std::make_unique<AudioThread>(m_AudioMixer, m_AudioRing, kAudioBlockFrames);
+        m_pAudioDevice =
+          std::make_unique<AudioDevice>(m_AudioRing, *m_pAudioThread, kAudioSampleRate);
+    } catch (const std::exception& e) {
+        char buff[256] = {};
+        sprintf_s(buff, "WARNING: No audio output, continuing without sound: %s\n", e.what());
+        OutputDebugStringA(buff);
+        m_pAudioDevice.reset();
+        m_pAudioThread.reset();
+    }
 }
 
 void Game::Tick() {
+    m_FrameStart = GetInputTime();
+    m_FrameScheduler.BeginFrame(m_FrameStart);
+
+    m_FrameArena.BeginFrame();
+    ApplyResize();
+    UpdateAssets();
+
     m_Timer.Tick([&]() { Update(m_Timer); });
 
     const auto start = std::chrono::high_resolution_clock::now();
@@ -50,18 +230,115 @@ void Game::Tick() {
     }
 
     g_FrameCount++;
+
+    UpdateVblank();
+}
+
+std::chrono::nanoseconds Game::GetTimeUntilFrameStart() const {
+    const int64_t now = GetInputTime();
+    return std::chrono::nanoseconds(m_FrameScheduler.GetFrameStart(now) - now);
+}
+
+void Game::UpdateVblank() {
+    // Only a blocking Present leaves time to reclaim; with tearing, frames never wait for vblank
+    const bool tearing =
+      m_pDeviceResources->GetDeviceOptions() & DX::DeviceResources::c_AllowTearing;
+    DWM_TIMING_INFO timing = {};
+    timing.cbSize          = sizeof(timing);
+    if (!m_LateLatch || tearing || FAILED(::DwmGetCompositionTimingInfo(nullptr, &timing))) {
+        m_FrameScheduler.SetVblank(0, 0);
+        return;
+    }
+
+    // QPC ticks to nanoseconds the way steady_clock converts them, so the times line up with
+    // GetInputTime
+    static const int64_t frequency = [] {
+        LARGE_INTEGER value;
+        ::QueryPerformanceFrequency(&value);
+        return value.QuadPart;
+    }();
+    const auto toNanoseconds = [](const uint64_t ticks) {
+        const auto counter = static_cast<int64_t>(ticks);
+        return counter / frequency * 1'000'000'000 +
+               counter % frequency * 1'000'000'000 / frequency;
+    };
+    m_FrameScheduler.SetVblank(toNanoseconds(timing.qpcVBlank),
+                               toNanoseconds(timing.qpcRefreshPeriod));
 }
 
 void Game::OnDeviceLost() {
-    // Cleaup code here
+    // Everything created on the device goes with it. m_GpuResources keeps the recipes.
+    m_WhiteTexture  = {};
+    m_PaddleTexture = {};
+    m_BallTexture   = {};
+    m_pScoreFont.reset();
+    m_pSpriteBatch.reset();
+    m_pStates.reset();
+
+    StopCapture();
+
+    // The D2D target draws into the swap chain's buffer. The D2D and DirectWrite factories and
+    // the text format do not depend on the device, so they are kept.
     m_pD2DRenderTarget.Reset();
-    m_pD2DFactory.Reset();
-    m_pDWriteFactory.Reset();
 }
 
 void Game::OnDeviceRestored() {
     CreateDeviceDependentResources();
+    m_GpuResources.Recreate(&m_Jobs);
     CreateWindowSizeDependentResources();
+    CreateD2DSurface();
+}
+
+void Game::OnKey(const uint32_t virtualKey, const bool pressed) {
+    const int64_t time = GetInputTime();
+    const auto push    = [&](const InputAction action) {
+        m_InputQueue.TryPush({time, action, pressed, m_LatencyTracer.NextId()});
+    };
+
+    // W/S or the arrow keys drive the left paddle; the right paddle is the AI
+    switch (virtualKey) {
+        case 'W':
+        case VK_UP:
+            push(InputAction::LeftUp);
+            break;
+        case 'S':
+        case VK_DOWN:
+            push(InputAction::LeftDown);
+            break;
+        case 'B':  // switch between Pong and breakout, starting a new match
+            if (pressed)
+                m_ToggleModeRequested = true;
+            break;
+        case 'R':  // replay the match so far
+            if (pressed)
+                m_ReplayRequested = true;
+            break;
+        case 'L':  // toggle late latching
+            m_LateLatch = pressed ? !m_LateLatch : m_LateLatch;
+            break;
+        case 'T':  // save the frame timings so far for PongSchedulerBench
+            if (pressed) {
+                try {
+                    WriteFrameTrace(GetExecutableDirectory() / kFrameTraceName, m_FrameTrace);
+                    m_FrameTrace.clear();
+                } catch (const std::exception& e) {
+                    char buff[256] = {};
+                    sprintf_s(buff, "WARNING: Saving the frame trace failed: %s\n", e.what());
+                    OutputDebugStringA(buff);
+                }
+            }
+            break;
+        case 'C':  // start or stop capturing frames
+            if (pressed) {
+                if (m_pCapture)
+                    StopCapture();
+                else
+                    StartCapture();
+            }
+            break;
+        default:
+            break;
+    }
 }
 
 void Game::OnActivated() {
@@ -69,40 +346,80 @@ void Game::OnActivated() {
 }
 
 void Game::OnDeactivated() {
-    // TODO: Game is becoming background window.
+    // Key releases go to the new foreground window, so release everything now
+    const int64_t time = GetInputTime();
+    for (uint32_t action = 0; action < kInputActionCount; ++action)
+        m_InputQueue.TryPush({time, static_cast<InputAction>(action), false});
 }
 
 void Game::OnSuspending() {
-    // TODO: Game is being power-suspended (or minimized).
+    m_Pipeline.RunExclusive([this] { m_Sim.SaveSnapshot(m_SuspendSnapshot); });
+    try {
+        WriteLooseFile(GetExecutableDirectory() / kSuspendSnapshotName, m_SuspendSnapshot);
+    } catch (const std::exception& e) {
+        char buff[256] = {};
+        sprintf_s(buff, "WARNING: Saving the match for suspend failed: %s\n", e.what());
+        OutputDebugStringA(buff);
+    }
 }
 
 void Game::OnResuming() {
     m_Timer.ResetElapsedTime();
-    // TODO: Game is being power-resumed (or returning from minimize).
+
+    // The process survived, so the match in memory is current and the saved one is stale
+    std::error_code error;
+    std::filesystem::remove(GetExecutableDirectory() / kSuspendSnapshotName, error);
 }
 
-void Game::OnWindowMoved() {
-    // const auto [left, top, right, bottom] = m_pDeviceResources->GetOutputSize();
-    // m_pDeviceResources->WindowSizeChanged(right, bottom);
-    //
+void Game::RestoreSuspendedMatch() {
+    const std::filesystem::path path = GetExecutableDirectory() / kSuspendSnapshotName;
+    std::error_code error;
+    if (!std::filesystem::exists(path, error))
+        return;
 
-    const auto [left, top, right, bottom] = m_pDeviceResources->GetOutputSize();
-    OnWindowSizeChanged(right, bottom);
+    try {
+        m_Sim.RestoreSnapshot(ReadLooseFile(path));
+        m_SimOptions.breakout = m_Sim.IsBreakout();
+    } catch (const std::exception& e) {
+        char buff[256] = {};
+        sprintf_s(buff, "WARNING: Discarding the suspended match: %s\n", e.what());
+        OutputDebugStringA(buff);
+    }
+    std::filesystem::remove(path, error);
+}
+
+void Game::OnWindowMoved() {
+    // A move keeps the size, but may take the window to a display with another color space
+    m_pDeviceResources->UpdateColorSpace();
 }
 
 void Game::OnDisplayChange() {
     m_pDeviceResources->UpdateColorSpace();
 }
 
-void Game::OnWindowSizeChanged(int width, int height) {
-    if (m_pD2DRenderTarget) {
-        m_pD2DRenderTarget.Reset();
-    }
+void Game::OnWindowSizeChanged(const int width, const int height) {
+    m_Resizes.Request({static_cast<uint32_t>(std::max(width, 0)),
+                       static_cast<uint32_t>(std::max(height, 0))});
+}
 
-    if (!m_pDeviceResources->WindowSizeChanged(width, height))
+void Game::ApplyResize() {
+    const auto [left, top, right, bottom] = m_pDeviceResources->GetOutputSize();
+    const std::optional<SurfaceSize> size =
+      m_Resizes.Take({static_cast<uint32_t>(right - left), static_cast<uint32_t>(bottom - top)});
+    if (!size)
         return;
+
+    // The D2D target holds the back buffer, which ResizeBuffers needs released
+    m_pD2DRenderTarget.Reset();
+    m_pDeviceResources->WindowSizeChanged(static_cast<int>(size->width),
+                                          static_cast<int>(size->height));
     CreateWindowSizeDependentResources();
 
+    // A Y4M stream cannot change size, and neither should a PNG sequence
+    if (m_pCapture &&
+        (m_pCapture->GetWidth() != size->width || m_pCapture->GetHeight() != size->height))
+        StopCapture();
+
     CreateD2DSurface();
 }
 
@@ -112,7 +429,62 @@ void Game::GetDefaultSize(int& width, int& height) const {
 }
 
 void Game::Update(const DX::StepTimer& timer) {
-    const auto dT = static_cast<float>(timer.GetElapsedSeconds());
+    if (!m_Pipeline.IsThreaded())
+        m_Pipeline.Update(static_cast<float>(timer.GetElapsedSeconds()));
+}
+
+void Game::UpdateSim(SimFrame& frame, const float seconds) {
+    if (m_ToggleModeRequested.exchange(false)) {
+        m_SimOptions.breakout = !m_SimOptions.breakout;
+        m_Sim.Reset(m_SimOptions);
+        m_Sim.SaveSnapshot(m_RecordingStart);
+        m_InputRecording.Clear();
+        m_InputReplay.reset();
+    }
+    if (m_ReplayRequested.exchange(false)) {
+        if (!m_InputReplay && m_InputRecording.GetTickCount()) {
+            m_Sim.RestoreSnapshot(m_RecordingStart);
+            m_InputReplay.emplace(m_InputRecording);
+        }
+    }
+
+    // Run every tick whose input window has closed. Live events are consumed during a replay
+    // too, so the keys held when it ends are current.
+    const uint32_t ticks = m_InputTimeline.GetDueTicks(GetInputTime(), kMaxTicksPerFrame);
+    for (uint32_t tick = 0; tick < ticks; ++tick) {
+        SimInput input;
+        {
+            std::lock_guard lock(m_LatencyMutex);
+            input = m_InputTimeline.NextTick(m_InputQueue, &m_LatencyTracer);
+        }
+        if (m_InputReplay) {
+            input = m_InputReplay->NextTick();
+            if (m_InputReplay->IsFinished())
+                m_InputReplay.reset();
+        } else {
+            m_InputRecording.Record(input);
+        }
+
+        m_Sim.Step(input, kSimTickSeconds);
+        m_Effects.Emit(m_Sim);
+        if (m_pAudioDevice)
+            m_Sounds.Emit(m_AudioMixer, m_Sim);
+        std::lock_guard lock(m_LatencyMutex);
+        m_LatencyTracer.Mark(LatencyStage::Simulated, GetInputTime());
+    }
+
+    m_Effects.Update(seconds, &m_Jobs);
+
+    RecordCourt(frame.list, m_Sim, &m_Effects);
+    frame.status.clear();
+    if (m_InputReplay)
+        std::format_to(std::back_inserter(frame.status),
+                       "replay: tick {} of {}",
+                       m_InputReplay->GetTick(),
+                       m_InputRecording.GetTickCount());
+    else
+        std::format_to(
+          std::back_inserter(frame.status), "tick: {}", m_InputRecording.GetTickCount());
 }
 
 void Game::Render() {
@@ -120,20 +492,111 @@ void Game::Render() {
         return;
     }
 
+    m_Pipeline.BeginRender();
     Clear();
 
-    auto context = m_pDeviceResources->GetD3DDeviceContext();
+    const SimFrame& frame = m_Pipeline.AcquireFrame();
+    {  // Court, from the latest frame UpdateSim recorded
+        const RenderList& list = frame.list;
+
+        const auto viewport = m_pDeviceResources->GetScreenViewport();
+        const float scaleX  = viewport.Width / kCourtWidth;
+        const float scaleY  = viewport.Height / kCourtHeight;
 
-    // TODO: Render code goes here
+        const auto drawSprite = [&](const Texture& texture, const RECT& dest) {
+            if (texture.view)
+                m_pSpriteBatch->Draw(texture.view.Get(), dest, Colors::White);
+            else
+                m_pSpriteBatch->Draw(
+                  m_WhiteTexture.view.Get(), dest, PremultiplyColor(kPlaceholderColor, 1.f));
+        };
+
+        // Sprite textures are premultiplied, matching SpriteBatch's default blend state
+        m_pSpriteBatch->Begin(SpriteSortMode_Deferred);
+        for (const RenderCommand& command : list.GetCommands()) {
+            const RECT dest = {
+              static_cast<LONG>(command.x0 * scaleX),
+              static_cast<LONG>(command.y0 * scaleY),
+              static_cast<LONG>(command.x1 * scaleX),
+              static_cast<LONG>(command.y1 * scaleY),
+            };
+            switch (command.type) {
+                case RenderCommandType::Clear: {
+                    // Everything batched so far lies under the clear
+                    m_pSpriteBatch->End();
+                    XMFLOAT4 color;
+                    XMStoreFloat4(&color, PremultiplyColor(command.color, 1.f));
+                    m_pDeviceResources->GetD3DDeviceContext()->ClearRenderTargetView(
+                      m_pDeviceResources->GetRenderTargetView(), &color.x);
+                    m_pSpriteBatch->Begin(SpriteSortMode_Deferred);
+                    break;
+                }
+                case RenderCommandType::Sprite:
+                    switch (command.material) {
+                        case RenderMaterial::Solid:
+                            m_pSpriteBatch->Draw(m_WhiteTexture.view.Get(),
+                                                 dest,
+                                                 PremultiplyColor(command.color, command.fade));
+                            break;
+                        case RenderMaterial::Paddle:
+                            drawSprite(m_PaddleTexture, dest);
+                            break;
+                        case RenderMaterial::Ball:
+                            drawSprite(m_BallTexture, dest);
+                            break;
+                    }
+                    break;
+                case RenderCommandType::Text:
+                    if (m_pScoreFont) {
+                        std::pmr::wstring text(&m_FrameArena);
+                        AppendWide(list.GetText(command), text);
+                        const XMVECTOR size = m_pScoreFont->MeasureString(text.c_str());
+                        m_pScoreFont->DrawString(m_pSpriteBatch.get(),
+                                                 text.c_str(),
+                                                 XMFLOAT2(command.x0 * scaleX, command.y0 * scaleY),
+                                                 PremultiplyColor(command.color, 1.f),
+                                                 0.f,
+                                                 XMFLOAT2(XMVectorGetX(size) * 0.5f, 0.f));
+                    }
+                    break;
+            }
+        }
+        m_pSpriteBatch->End();
+    }
 
     // Ensure all D3D command are executed before switching to D2D
     m_pDeviceResources->GetD3DDeviceContext()->Flush();
 
-    RenderInterface();
+    RenderInterface(frame);
+    CaptureFrame();
+
+    const auto markLatency = [this](const LatencyStage stage, const int64_t time) {
+        std::lock_guard lock(m_LatencyMutex);
+        m_LatencyTracer.Mark(stage, time);
+    };
+    markLatency(LatencyStage::Rendered, GetInputTime());
+
+    // Present returns once the frame is queued; with vsync it may first wait for a free buffer
+    const int64_t submitTime = GetInputTime();
+    m_FrameScheduler.EndFrame(submitTime);
+    if (m_FrameTrace.size() < kMaxTraceFrames)
+        m_FrameTrace.push_back({m_FrameStart,
+                                submitTime,
+                                m_FrameScheduler.GetVblankTime(),
+                                m_FrameScheduler.GetVblankPeriod()});
+    markLatency(LatencyStage::Submitted, submitTime);
     m_pDeviceResources->Present();
+    markLatency(LatencyStage::Presented, GetInputTime());
+    m_Pipeline.EndRender();
+
+    if (m_TimeToFirstFrame < 0.f) {
+        const std::chrono::duration<float, std::milli> elapsed =
+          std::chrono::steady_clock::now() - m_InitializeTime;
+        m_TimeToFirstFrame = elapsed.count();
+    }
 }
 
-void Game::RenderInterface() const {
+void Game::RenderInterface(const SimFrame& frame) {
     if (m_pD2DRenderTarget) {
         m_pD2DRenderTarget->BeginDraw();
 
@@ -143,9 +606,8 @@ void Game::RenderInterface() const {
           m_pD2DRenderTarget->CreateSolidColorBrush(D2D1_COLOR_F(1.f, 1.f, 1.f, 1.f), &brush));
 
         {  // FPS counter
-            const auto fmt = std::format("fRate: {:.2f}", g_FrameRate);
-            std::wstring fpsCounter;
-            ANSIToWide(fmt, fpsCounter);
+            std::pmr::wstring fpsCounter(&m_FrameArena);
+            std::format_to(std::back_inserter(fpsCounter), L"fRate: {:.2f}", g_FrameRate);
             m_pD2DRenderTarget->DrawText(fpsCounter.c_str(),
                                          wcslen(fpsCounter.c_str()),
                                          m_pTextFormat.Get(),
@@ -154,9 +616,9 @@ void Game::RenderInterface() const {
         }
 
         {  // Frame time counter
-            const auto fmt = std::format("fTime: {:.2f} ms", 1000.f / g_FrameRate);
-            std::wstring frameTime;
-            ANSIToWide(fmt, frameTime);
+            std::pmr::wstring frameTime(&m_FrameArena);
+            std::format_to(
+              std::back_inserter(frameTime), L"fTime: {:.2f} ms", 1000.f / g_FrameRate);
             m_pD2DRenderTarget->DrawText(frameTime.c_str(),
                                          wcslen(frameTime.c_str()),
                                          m_pTextFormat.Get(),
@@ -164,19 +626,209 @@ void Game::RenderInterface() const {
                                          brush);
         }
 
+        {  // Startup timings
+            std::pmr::wstring startup(&m_FrameArena);
+            std::format_to(std::back_inserter(startup),
+                           L"ttff: {:.2f} ms, assets: {:.2f} ms",
+                           m_TimeToFirstFrame,
+                           m_TimeToAssets);
+            m_pD2DRenderTarget->DrawText(startup.c_str(),
+                                         wcslen(startup.c_str()),
+                                         m_pTextFormat.Get(),
+                                         D2D1::RectF(20, 60, 400, 70),
+                                         brush);
+        }
+
+        {  // Frame arena usage of the previous frame
+            const auto& stats = m_FrameArena.GetStats();
+            std::pmr::wstring arena(&m_FrameArena);
+            std::format_to(std::back_inserter(arena),
+                           L"arena: {:.1f}/{} KB, peak {:.1f} KB, overflow {:.1f} KB",
+                           stats.used / 1024.f,
+                           stats.capacity / 1024,
+                           stats.highWater / 1024.f,
+                           stats.overflow / 1024.f);
+            m_pD2DRenderTarget->DrawText(arena.c_str(),
+                                         wcslen(arena.c_str()),
+                                         m_pTextFormat.Get(),
+                                         D2D1::RectF(20, 80, 500, 90),
+                                         brush);
+        }
+
+        {  // Sim tick and replay progress
+            std::pmr::wstring ticks(&m_FrameArena);
+            AppendWide(frame.status, ticks);
+            m_pD2DRenderTarget->DrawText(ticks.c_str(),
+                                         wcslen(ticks.c_str()),
+                                         m_pTextFormat.Get(),
+                                         D2D1::RectF(20, 100, 400, 110),
+                                         brush);
+        }
+
+        {  // Key press to present latency over the last traced inputs
+            std::unique_lock latencyLock(m_LatencyMutex);
+            const LatencySummary simulated = m_LatencyTracer.GetSummary(LatencyStage::Simulated);
+            const LatencySummary presented = m_LatencyTracer.GetSummary(LatencyStage::Presented);
+            latencyLock.unlock();
+            std::pmr::wstring latency(&m_FrameArena);
+            std::format_to(std::back_inserter(latency),
+                           L"input to sim p50/p99: {:.1f}/{:.1f} ms, to present {:.1f}/{:.1f} ms",
+                           simulated.p50,
+                           simulated.p99,
+                           presented.p50,
+                           presented.p99);
+            m_pD2DRenderTarget->DrawText(latency.c_str(),
+                                         wcslen(latency.c_str()),
+                                         m_pTextFormat.Get(),
+                                         D2D1::RectF(20, 120, 600, 130),
+                                         brush);
+        }
+
+        {  // Late latching prediction
+            const FrameSchedulerStats& stats = m_FrameScheduler.GetStats();
+            std::pmr::wstring latch(&m_FrameArena);
+            if (m_FrameScheduler.GetVblankPeriod() > 0)
+                std::format_to(std::back_inserter(latch),
+                               L"late latch: cost {:.2f} ms, margin {:.2f} ms, slack {:.2f} ms, "
+                               L"missed {}",
+                               static_cast<double>(stats.predictedCost) * 1e-6,
+                               static_cast<double>(stats.margin) * 1e-6,
+                               static_cast<double>(stats.lastSlack) * 1e-6,
+                               stats.missed);
+            else
+                latch = m_LateLatch ? L"late latch: no vsync" : L"late latch: off";
+            m_pD2DRenderTarget->DrawText(latch.c_str(),
+                                         wcslen(latch.c_str()),
+                                         m_pTextFormat.Get(),
+                                         D2D1::RectF(20, 140, 600, 150),
+                                         brush);
+        }
+
+        if (m_pCapture) {  // Frames captured so far
+            const CaptureStats stats = m_pCapture->GetStats();
+            std::pmr::wstring capture(&m_FrameArena);
+            std::format_to(std::back_inserter(capture),
+                           L"capture: {} frames written, {} dropped",
+                           stats.written,
+                           stats.dropped);
+            m_pD2DRenderTarget->DrawText(capture.c_str(),
+                                         wcslen(capture.c_str()),
+                                         m_pTextFormat.Get(),
+                                         D2D1::RectF(20, 160, 600, 170),
+                                         brush);
+        }
+
+        {  // Sim and render overlap, and how long frames waited to be drawn
+            const SimPipelineStats stats = m_Pipeline.GetStats();
+            std::pmr::wstring pipeline(&m_FrameArena);
+            std::format_to(std::back_inserter(pipeline),
+                           L"sim: {}, overlap {:.0f}%, queued p50/p99: {:.2f}/{:.2f} ms, "
+                           L"dropped {}",
+                           m_Pipeline.IsThreaded() ? L"pipelined" : L"serial",
+                           stats.overlap * 100.0,
+                           stats.queueP50,
+                           stats.queueP99,
+                           stats.dropped);
+            m_pD2DRenderTarget->DrawText(pipeline.c_str(),
+                                         wcslen(pipeline.c_str()),
+                                         m_pTextFormat.Get(),
+                                         D2D1::RectF(20, 180, 700, 190),
+                                         brush);
+        }
+
         brush->Release();
         DX::ThrowIfFailed(m_pD2DRenderTarget->EndDraw());
     }
 }
 
+void Game::StartCapture() {
+    D3D11_TEXTURE2D_DESC desc = {};
+    m_pDeviceResources->GetRenderTarget()->GetDesc(&desc);
+    desc.Usage          = D3D11_USAGE_STAGING;
+    desc.BindFlags      = 0;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    desc.MiscFlags      = 0;
+
+    try {
+        if (desc.Format != DXGI_FORMAT_B8G8R8A8_UNORM &&
+            desc.Format != DXGI_FORMAT_B8G8R8A8_UNORM_SRGB)
+            throw std::runtime_error("Frame capture needs a B8G8R8A8 back buffer");
+        for (auto& staging : m_CaptureStaging)
+            DX::ThrowIfFailed(m_pDeviceResources->GetD3DDevice()->CreateTexture2D(
+              &desc, nullptr, staging.ReleaseAndGetAddressOf()));
+
+        const std::filesystem::path path =
+          m_CapturePath.empty() ? GetExecutableDirectory() / kCaptureName : m_CapturePath;
+        const bool y4m = path.extension() == L".y4m";
+
+        CaptureOptions options;
+        options.format    = y4m ? CaptureFormat::Y4m : CaptureFormat::PngSequence;
+        options.path      = path;
+        options.width     = desc.Width;
+        options.height    = desc.Height;
+        options.frameRate = kCaptureFrameRate;
+
+        m_pCapture       = std::make_unique<FrameCapture>(options);
+        m_CapturedFrames = 0;
+    } catch (const std::exception& e) {
+        char buff[256] = {};
+        sprintf_s(buff, "WARNING: Frame capture failed to start: %s\n", e.what());
+        OutputDebugStringA(buff);
+        m_CaptureStaging = {};
+    }
+}
+
+void Game::StopCapture() {
+    if (!m_pCapture)
+        return;
+
+    const uint64_t pending = std::min<uint64_t>(m_CapturedFrames, kCaptureStagingCount);
+    for (uint64_t frame = m_CapturedFrames - pending; frame < m_CapturedFrames; ++frame)
+        SubmitCapturedFrame(m_CaptureStaging[frame % kCaptureStagingCount].Get());
+
+    const CaptureStats stats = m_pCapture->GetStats();
+    const auto error         = m_pCapture->GetError();
+    m_pCapture.reset();  // waits for the writer to finish the queued frames
+    m_CaptureStaging = {};
+
+    char buff[256] = {};
+    sprintf_s(buff,
+              "Frame capture: %llu frames, %llu dropped%s%s\n",
+              static_cast<unsigned long long>(stats.submitted - stats.dropped),
+              static_cast<unsigned long long>(stats.dropped),
+              error ? ", stopped by: " : "",
+              error ? error->c_str() : "");
+    OutputDebugStringA(buff);
+}
+
+void Game::CaptureFrame() {
+    if (!m_pCapture)
+        return;
+
+    // The texture about to be reused holds the copy from kCaptureStagingCount frames ago
+    ID3D11Texture2D* pStaging = m_CaptureStaging[m_CapturedFrames % kCaptureStagingCount].Get();
+    if (m_CapturedFrames >= kCaptureStagingCount)
+        SubmitCapturedFrame(pStaging);
+    m_pDeviceResources->GetD3DDeviceContext()->CopyResource(pStaging,
+                                                            m_pDeviceResources->GetRenderTarget());
+    ++m_CapturedFrames;
+}
+
+void Game::SubmitCapturedFrame(ID3D11Texture2D* pStaging) {
+    const auto context              = m_pDeviceResources->GetD3DDeviceContext();
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(context->Map(pStaging, 0, D3D11_MAP_READ, 0, &mapped)))
+        return;  // the device was lost, and the frame with it
+    m_pCapture->Submit(mapped.pData, mapped.RowPitch);
+    context->Unmap(pStaging, 0);
+}
+
 void Game::Clear() {
-    // Clear the views.
+    // Clear the views. The color is cleared by the render list's clear command.
     auto context      = m_pDeviceResources->GetD3DDeviceContext();
     auto renderTarget = m_pDeviceResources->GetRenderTargetView();
     auto depthStencil = m_pDeviceResources->GetDepthStencilView();
 
-    float clearColor[4] = {17.f / 255.f, 18.f / 255.f, 28.f / 255.f, 1.f};
-    context->ClearRenderTargetView(renderTarget, clearColor);
     context->ClearDepthStencilView(depthStencil, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
     context->OMSetRenderTargets(1, &renderTarget, depthStencil);
 
@@ -203,6 +855,24 @@ void Game::CreateDeviceDependentResources() {
     DX::ThrowIfFailed(device->CreateBlendState(&blendDesc, &blendState));
     context->OMSetBlendState(blendState, nullptr, 0xFFFFFFFF);
     blendState->Release();
+
+    m_pStates      = std::make_unique<CommonStates>(device);
+    m_pSpriteBatch = std::make_unique<SpriteBatch>(context);
+
+    // Textures are created once here or by UpdateAssets; after device loss, m_GpuResources
+    // creates them again
+    if (!m_GpuResources.Contains(&m_WhiteTexture)) {
+        static constexpr uint32_t white = 0xFFFFFFFF;
+        const CD3D11_TEXTURE2D_DESC whiteDesc(DXGI_FORMAT_B8G8R8A8_UNORM,
+                                              1,
+                                              1,
+                                              1,
+                                              1,
+                                              D3D11_BIND_SHADER_RESOURCE,
+                                              D3D11_USAGE_IMMUTABLE);
+        const D3D11_SUBRESOURCE_DATA whiteData = {&white, sizeof(white), 0};
+        CreateTexture(whiteDesc, {&whiteData, 1}, nullptr, m_WhiteTexture);
+    }
 }
 
 void Game::CreateWindowSizeDependentResources() {}
@@ -242,3 +912,213 @@ void Game::CreateD2DSurface() {
       m_pD2DFactory->CreateDxgiSurfaceRenderTarget(surface, &props, &m_pD2DRenderTarget));
     surface->Release();
 }
+
+void Game::StartAssetLoads() {
+    // Pre-converted .ptex textures are viewed in place; PNGs are decoded only as a fallback.
+    const auto loadTexture = [this](const std::string_view name) {
+        return m_Loader.Load([this, name] { return LoadPackedTexture(m_Assets, name); });
+    };
+
+    m_PaddleTextureData = loadTexture("paddle");
+    m_BallTextureData   = loadTexture("ball");
+
+    m_PaddleMask = LoadCollisionMask(m_Loader, m_PaddleTextureData, kPaddleWidth, kPaddleHeight);
+    m_BallMask   = LoadCollisionMask(m_Loader, m_BallTextureData, kBallSize, kBallSize);
+
+    m_ScoreFontData = m_Loader.Load([this] {
+        std::vector<std::byte> scratch;
+        return ParseFont(m_Assets.Load("chakra_32.font", scratch));
+    });
+    m_ScoreFontGlyphs = m_Loader.Load(ToSpriteFontGlyphs, m_ScoreFontData);
+}
+
+void Game::WatchAssets() {
+#ifdef PONG_DATA_DIR
+    // Debug builds read edits straight from the source tree; shipped builds only see data.pak.
+    const std::filesystem::path dataDir = PONG_DATA_DIR;
+    if (!std::filesystem::is_directory(dataDir))
+        return;
+
+    m_pAssetWatcher = std::make_unique<FileWatcher>(
+      dataDir, kAssetReloadDebounce, [this](const std::filesystem::path& file) {
+          std::lock_guard lock(m_ChangedAssetsMutex);
+          m_ChangedAssets.push_back(file);
+      });
+#endif
+}
+
+void Game::StartAssetReloads() {
+#ifdef PONG_DATA_DIR
+    std::vector<std::filesystem::path> changed;
+    {
+        std::lock_guard lock(m_ChangedAssetsMutex);
+        changed.swap(m_ChangedAssets);
+    }
+
+    // Only the asset behind the changed file is re-imported. Sprites are decoded from the source
+    // PNG, since the .ptex in the pack is produced by the build.
+    for (const auto& file : changed) {
+        const std::filesystem::path path = std::filesystem::path(PONG_DATA_DIR) / file;
+        const auto loadTexture           = [this, path] {
+            return m_Loader.Load([path] {
+                const auto bytes = ReadLooseFile(path);
+                return ConvertImage(DecodePng(bytes), true);
+            });
+        };
+
+        if (file == "paddle.png") {
+            m_PaddleTextureReload = loadTexture();
+        } else if (file == "ball.png") {
+            m_BallTextureReload = loadTexture();
+        } else if (file == "chakra_32.font") {
+            m_ScoreFontReload = m_Loader.Load([path] { return ParseFont(ReadLooseFile(path)); });
+            m_ScoreFontGlyphsReload = m_Loader.Load(ToSpriteFontGlyphs, m_ScoreFontReload);
+        }
+    }
+#endif
+}
+
+void Game::UpdateAssets() {
+    if (!m_pDeviceResources->GetD3DDevice())
+        return;
+
+    // Reloaded assets replace the current ones here, at the frame boundary, and are recreated on
+    // the device below; until a reload completes the old asset keeps drawing.
+    StartAssetReloads();
+    if (TakeReload(m_PaddleTextureReload, m_PaddleTextureData)) {
+        ReleaseTexture(m_PaddleTexture);
+        m_PaddleMask =
+          LoadCollisionMask(m_Loader, m_PaddleTextureData, kPaddleWidth, kPaddleHeight);
+    }
+    if (TakeReload(m_BallTextureReload, m_BallTextureData)) {
+        ReleaseTexture(m_BallTexture);
+        m_BallMask = LoadCollisionMask(m_Loader, m_BallTextureData, kBallSize, kBallSize);
+    }
+    if (m_ScoreFontGlyphsReload.IsComplete()) {
+        if (TakeReload(m_ScoreFontGlyphsReload, m_ScoreFontGlyphs)) {
+            m_ScoreFontData = std::move(m_ScoreFontReload);
+            m_GpuResources.Remove(&m_pScoreFont);
+            m_pScoreFont.reset();
+        }
+        m_ScoreFontReload.Reset();
+    }
+
+    // Get() rethrows the load error of an asset that failed. The sim keeps each mask alive
+    // through a pointer sharing ownership of its asset state.
+    const auto installMask = [this](AssetHandle<CollisionMask>& mask, const SpriteId sprite) {
+        if (mask.IsComplete()) {
+            const CollisionMask& shape = mask.Get();
+            m_Pipeline.RunExclusive([&] {
+                m_Sim.SetCollisionMask(
+                  sprite, std::shared_ptr<const CollisionMask>(mask.GetState(), &shape));
+            });
+            mask.Reset();
+        }
+    };
+    installMask(m_PaddleMask, kSpritePaddle);
+    installMask(m_BallMask, kSpriteBall);
+
+    if (!m_PaddleTexture.view && m_PaddleTextureData.IsComplete())
+        CreateTexture(m_PaddleTextureData, m_PaddleTexture);
+    if (!m_BallTexture.view && m_BallTextureData.IsComplete())
+        CreateTexture(m_BallTextureData, m_BallTexture);
+
+    if (!m_pScoreFont && m_ScoreFontGlyphs.IsComplete())
+        CreateScoreFont();
+
+    if (m_TimeToAssets < 0.f && m_PaddleTexture.view && m_BallTexture.view && m_pScoreFont) {
+        const std::chrono::duration<float, std::milli> elapsed =
+          std::chrono::steady_clock::now() - m_InitializeTime;
+        m_TimeToAssets = elapsed.count();
+    }
+}
+
+void Game::CreateScoreFont() {
+    const FontData& font = m_ScoreFontData.Get();
+    m_ScoreFontGlyphs.Get();  // rethrows the conversion error, if any
+
+    const CD3D11_TEXTURE2D_DESC desc(static_cast<DXGI_FORMAT>(font.textureFormat),
+                                     font.textureWidth,
+                                     font.textureHeight,
+                                     1,
+                                     1,
+                                     D3D11_BIND_SHADER_RESOURCE,
+                                     D3D11_USAGE_IMMUTABLE);
+    const GpuSubresource data = {font.textureData.data(), font.textureStride, 0};
+
+    // The atlas pixels and glyphs stay in the font assets, which the function holds on to. The
+    // font only wraps the atlas, so like the atlas it can be created on any thread.
+    const auto create = [this, fontData = m_ScoreFontData, fontGlyphs = m_ScoreFontGlyphs](
+                          const GpuResourceRecipe& recipe) {
+        const FontData& font = fontData.Get();
+        const auto& glyphs   = fontGlyphs.Get();
+
+        Texture atlas;
+        RecreateTexture(recipe, atlas);
+        auto pFont = std::make_unique<SpriteFont>(
+          atlas.view.Get(), glyphs.data(), glyphs.size(), font.lineSpacing);
+        if (font.defaultCharacter)
+            pFont->SetDefaultCharacter(static_cast<wchar_t>(font.defaultCharacter));
+        m_pScoreFont = std::move(pFont);
+    };
+    m_GpuResources.Add(&m_pScoreFont,
+                       GpuResourceRecipe::Make(desc, {&data, 1}, m_ScoreFontData.GetState()),
+                       create);
+}
+
+void Game::CreateTexture(const AssetHandle<TextureData>& asset, Texture& texture) {
+    const TextureData& data = asset.Get();
+
+    D3D11_SUBRESOURCE_DATA mips[kMaxTextureMips] = {};
+    for (uint32_t level = 0; level < data.mipCount; ++level) {
+        mips[level].pSysMem     = data.GetMip(level).data();
+        mips[level].SysMemPitch = data.mips[level].rowPitch;
+    }
+
+    const CD3D11_TEXTURE2D_DESC desc(DXGI_FORMAT_B8G8R8A8_UNORM,
+                                     data.width,
+                                     data.height,
+                                     1,
+                                     data.mipCount,
+                                     D3D11_BIND_SHADER_RESOURCE,
+                                     D3D11_USAGE_IMMUTABLE);
+    CreateTexture(desc, std::span(mips, data.mipCount), asset.GetState(), texture);
+}
+
+void Game::CreateTexture(const D3D11_TEXTURE2D_DESC& desc,
+                         const std::span<const D3D11_SUBRESOURCE_DATA> initialData,
+                         std::shared_ptr<const void> pOwner,
+                         Texture& texture) {
+    std::vector<GpuSubresource> subresources;
+    for (const D3D11_SUBRESOURCE_DATA& subresource : initialData)
+        subresources.push_back(
+          {subresource.pSysMem, subresource.SysMemPitch, subresource.SysMemSlicePitch});
+
+    // ID3D11Device creates resources from any thread, so they are recreated on the job system
+    m_GpuResources.Add(
+      &texture,
+      GpuResourceRecipe::Make(desc, subresources, std::move(pOwner)),
+      [this, &texture](const GpuResourceRecipe& recipe) { RecreateTexture(recipe, texture); });
+}
+
+void Game::RecreateTexture(const GpuResourceRecipe& recipe, Texture& texture) const {
+    const auto device = m_pDeviceResources->GetD3DDevice();
+    const auto desc   = recipe.GetDesc<D3D11_TEXTURE2D_DESC>();
+
+    std::vector<D3D11_SUBRESOURCE_DATA> initialData;
+    for (const GpuSubresource& subresource : recipe.initialData)
+        initialData.push_back({subresource.pData, subresource.rowPitch, subresource.slicePitch});
+
+    ComPtr<ID3D11Texture2D> texture2D;
+    DX::ThrowIfFailed(device->CreateTexture2D(
+      &desc, initialData.empty() ? nullptr : initialData.data(), texture2D.GetAddressOf()));
+    DX::ThrowIfFailed(device->CreateShaderResourceView(
+      texture2D.Get(), nullptr, texture.view.ReleaseAndGetAddressOf()));
+    texture.width  = desc.Width;
+    texture.height = desc.Height;
+}
+
+void Game::ReleaseTexture(Texture& texture) {
+    m_GpuResources.Remove(&texture);
+    texture = {};
+}
@@ -4,13 +4,61 @@
 
 #pragma once
 
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "AudioDevice.h"
+#include "AudioMixer.h"
+#include "AudioRing.h"
+#include "CollisionMask.h"
 #include "DeviceResources.h"
+#include "Effects.h"
+#include "FileWatcher.h"
+#include "FontFile.h"
+#include "FrameArena.h"
+#include "FrameCapture.h"
+#include "FrameScheduler.h"
+#include "GpuResourceRegistry.h"
+#include "Input.h"
+#include "JobSystem.h"
+#include "LatencyTracer.h"
+#include "ResizeQueue.h"
+#include "Sim.h"
+#include "SimPipeline.h"
+#include "Sounds.h"
 #include "StepTimer.h"
+#include "TextureFile.h"
+
+#include <CommonStates.h>
+#include <SpriteBatch.h>
+#include <SpriteFont.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+
+struct Texture {
+    ComPtr<ID3D11ShaderResourceView> view;
+    UINT width  = 0;
+    UINT height = 0;
+};
+
+/// Startup settings, from the command line.
+struct GameOptions {
+    SimOptions sim;
+    bool lateLatch = true;
+    bool sound     = true;
+    bool pipelined = false;  // updates the sim on a thread of its own rather than before each frame
+    std::filesystem::path capturePath;  // captures from the first frame when set
+};
 
 class Game final : public DX::IDeviceNotify {
 public:
-    Game() noexcept(false);
-    ~Game() = default;
+    explicit Game(const GameOptions& options = {}) noexcept(false);
+    ~Game();
 
     Game(Game&&)            = default;
     Game& operator=(Game&&) = default;
@@ -21,6 +69,10 @@ public:
     void Initialize(HWND window, int width, int height);
     void Tick();
 
+    /// How long to keep handling messages before calling Tick, so that with vsync the frame
+    /// starts as late as its predicted cost allows. Zero when late latching is off.
+    std::chrono::nanoseconds GetTimeUntilFrameStart() const;
+
     // IDeviceNotify
     void OnDeviceLost() override;
     void OnDeviceRestored() override;
@@ -32,16 +84,38 @@ public:
     void OnResuming();
     void OnWindowMoved();
     void OnDisplayChange();
+    /// Queues the new client size; the next Tick rebuilds the surfaces if it differs.
     void OnWindowSizeChanged(int width, int height);
+    /// Queues a key press or release, stamped with the time of the call and traced until the
+    /// first frame presented after the tick that applies it.
+    void OnKey(uint32_t virtualKey, bool pressed);
 
     void GetDefaultSize(int& width, int& height) const;
 
 private:
+    /// Rebuilds the window size dependent surfaces if a resize was asked for since the last frame.
+    void ApplyResize();
     void Update(const DX::StepTimer& timer);
+    /// Runs the ticks that are due and records the frame; on m_Pipeline's thread when pipelined.
+    void UpdateSim(SimFrame& frame, float seconds);
+    /// Refreshes the scheduler's vblank timing from the compositor after a Present.
+    void UpdateVblank();
+    /// Starts sound output, or leaves the game silent if there is no audio device.
+    void StartAudio();
+    /// Picks up the match saved by OnSuspending if the game was ended while suspended.
+    void RestoreSuspendedMatch();
     void Render();
 
+    /// Streams every presented frame to m_CapturePath: a .y4m file, or else a directory of PNGs.
+    void StartCapture();
+    /// Reads back the frames still in the staging textures and closes the capture.
+    void StopCapture();
+    /// Queues the back buffer's readback; call after the frame is drawn, before Present.
+    void CaptureFrame();
+    void SubmitCapturedFrame(ID3D11Texture2D* pStaging);
+
     /// Renders the UI drawn by Direct2D
-    void RenderInterface() const;
+    void RenderInterface(const SimFrame& frame);
 
     void Clear();
     void CreateDeviceDependentResources();
@@ -49,11 +123,131 @@ private:
     void CreateD2DResources();
     void CreateD2DSurface();
 
+    /// Starts decoding every asset on the job system; nothing here touches the device.
+    void StartAssetLoads();
+    /// Creates GPU resources for assets that finished loading since the last frame.
+    void UpdateAssets();
+    /// Watches the source data directory and re-imports assets edited while the game runs.
+    void WatchAssets();
+    /// Starts re-importing the files the watcher reported since the last frame.
+    void StartAssetReloads();
+    /// Creates `texture` and records its recipe in m_GpuResources, which keeps `pOwner`, the
+    /// owner of the initial data, alive to create the texture again after device loss.
+    void CreateTexture(const AssetHandle<TextureData>& data, Texture& texture);
+    void CreateTexture(const D3D11_TEXTURE2D_DESC& desc,
+                       std::span<const D3D11_SUBRESOURCE_DATA> initialData,
+                       std::shared_ptr<const void> pOwner,
+                       Texture& texture);
+    /// Creates `texture` on the current device from its recipe; safe on any thread.
+    void RecreateTexture(const GpuResourceRecipe& recipe, Texture& texture) const;
+    /// Releases `texture` and forgets its recipe, before its asset is replaced.
+    void ReleaseTexture(Texture& texture);
+    /// Creates m_pScoreFont and its atlas from the font assets, recording the recipe.
+    void CreateScoreFont();
+
     std::unique_ptr<DX::DeviceResources> m_pDeviceResources;
     DX::StepTimer m_Timer;
+    ResizeQueue m_Resizes;
+
+    // Transient per-frame allocations (HUD strings, sort keys, ...); reset at the start of Tick
+    FrameArena m_FrameArena;
+
+    AssetPack m_Assets;
+    AssetLoader m_Loader;
+    AssetHandle<TextureData> m_PaddleTextureData;
+    AssetHandle<TextureData> m_BallTextureData;
+    // Built from the textures above and handed to m_Sim, which then owns them
+    AssetHandle<CollisionMask> m_PaddleMask;
+    AssetHandle<CollisionMask> m_BallMask;
+    AssetHandle<FontData> m_ScoreFontData;
+    AssetHandle<std::vector<DirectX::SpriteFont::Glyph>> m_ScoreFontGlyphs;
+
+    // Hot reload: the watcher queues changed file names from its own thread, and each frame
+    // re-imports them into the reload handles, which replace the handles above once complete.
+    std::mutex m_ChangedAssetsMutex;
+    std::vector<std::filesystem::path> m_ChangedAssets;
+    std::unique_ptr<FileWatcher> m_pAssetWatcher;
+    AssetHandle<TextureData> m_PaddleTextureReload;
+    AssetHandle<TextureData> m_BallTextureReload;
+    AssetHandle<FontData> m_ScoreFontReload;
+    AssetHandle<std::vector<DirectX::SpriteFont::Glyph>> m_ScoreFontGlyphsReload;
+
+    std::unique_ptr<DirectX::CommonStates> m_pStates;
+    std::unique_ptr<DirectX::SpriteBatch> m_pSpriteBatch;
+    std::unique_ptr<DirectX::SpriteFont> m_pScoreFont;
+    Texture m_WhiteTexture;
+    Texture m_PaddleTexture;
+    Texture m_BallTexture;
+
+    // How the textures above and the score font were created, so that after device loss they
+    // are created again from data still in memory, in parallel on m_Jobs
+    GpuResourceRegistry m_GpuResources;
+
+    // Paddles, ball and score; systems run on m_Jobs. The sim, its input below and m_Effects
+    // belong to UpdateSim, and are only touched elsewhere through m_Pipeline.RunExclusive.
+    Sim m_Sim;
+    SimOptions m_SimOptions;
+    std::vector<std::byte> m_SuspendSnapshot;  // reused by every OnSuspending
+
+    // Key events from the window procedure, consumed one fixed tick at a time. Every tick's
+    // input is recorded, so a replay of the match so far, from the snapshot taken when the
+    // recording began, ends in exactly the live state.
+    InputQueue m_InputQueue;
+    InputTimeline m_InputTimeline;
+    std::vector<std::byte> m_RecordingStart;
+    InputRecording m_InputRecording;
+    std::optional<InputReplay> m_InputReplay;
+    std::atomic<bool> m_ToggleModeRequested {false};
+    std::atomic<bool> m_ReplayRequested {false};
+
+    // Key events traced from OnKey through the tick that applies them to Present; marked by
+    // both UpdateSim and Render, so under m_LatencyMutex
+    std::mutex m_LatencyMutex;
+    LatencyTracer m_LatencyTracer;
+
+    // Late latching: with vsync, Tick is held back until just before the vblank deadline. Every
+    // frame's timing is kept (up to a limit) and can be saved as a trace for PongSchedulerBench.
+    FrameScheduler m_FrameScheduler;
+    bool m_LateLatch     = true;
+    int64_t m_FrameStart = 0;
+    std::vector<FrameRecord> m_FrameTrace;
+
+    CourtEffects m_Effects;
+
+    // UpdateSim records each frame once its ticks have run, and Render draws the newest, so
+    // drawing never reads the sim directly. Serially, Update runs it before every frame;
+    // pipelined, it runs on the pipeline's thread at the tick rate.
+    SimPipeline m_Pipeline;
+    bool m_Pipelined = false;
+
+    // Frame capture: each frame is copied to a staging texture and mapped kCaptureStagingCount
+    // frames later, once the GPU has long finished with it, then handed to m_pCapture's writer
+    static constexpr uint32_t kCaptureStagingCount = 4;
+    std::filesystem::path m_CapturePath;
+    std::unique_ptr<FrameCapture> m_pCapture;
+    std::array<ComPtr<ID3D11Texture2D>, kCaptureStagingCount> m_CaptureStaging;
+    uint64_t m_CapturedFrames = 0;  // copies made into m_CaptureStaging
+
+    // Sim events are played by m_AudioMixer on its own thread, which keeps m_AudioRing topped up
+    // for the device. Without an audio device the game runs silent.
+    CourtSounds m_Sounds;
+    AudioMixer m_AudioMixer;
+    AudioRing m_AudioRing;
+    std::unique_ptr<AudioThread> m_pAudioThread;
+    std::unique_ptr<AudioDevice> m_pAudioDevice;  // after the thread, so it stops first
+    bool m_SoundEnabled = true;
+
+    // Startup timings, in milliseconds since Initialize; negative until reached.
+    std::chrono::steady_clock::time_point m_InitializeTime;
+    float m_TimeToFirstFrame = -1.f;
+    float m_TimeToAssets     = -1.f;
 
     ComPtr<ID2D1Factory> m_pD2DFactory;
     ComPtr<IDWriteFactory> m_pDWriteFactory;
     ComPtr<IDWriteTextFormat> m_pTextFormat;
     ComPtr<ID2D1RenderTarget> m_pD2DRenderTarget;
+
+    // Declared last so it is destroyed first: its destructor finishes in-flight loads, which
+    // read m_Assets and resolve the handles above.
+    JobSystem m_Jobs;
 };
@@ -0,0 +1,84 @@
+//
+// GpuResourceRegistry.cpp - Creation recipes for device-bound resources, replayed after device loss
+//
+
+#include "GpuResourceRegistry.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <latch>
+
+void GpuResourceRegistry::Add(const void* key,
+                              GpuResourceRecipe recipe,
+                              CreateFunc create,
+                              const bool freeThreaded) {
+    create(recipe);
+    ++m_Stats.created;
+
+    Remove(key);
+    m_Entries.push_back({key, std::move(recipe), std::move(create), freeThreaded});
+}
+
+void GpuResourceRegistry::Remove(const void* key) noexcept {
+    std::erase_if(m_Entries, [key](const Entry& entry) { return entry.key == key; });
+}
+
+bool GpuResourceRegistry::Contains(const void* key) const noexcept {
+    return std::any_of(
+      m_Entries.begin(), m_Entries.end(), [key](const Entry& entry) { return entry.key == key; });
+}
+
+void GpuResourceRegistry::Recreate(JobSystem* pJobs) {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::exception_ptr> errors(m_Entries.size());
+    const auto create = [&](const size_t i) {
+        try {
+            m_Entries[i].create(m_Entries[i].recipe);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+
+    // Workers take free-threaded recipes from a shared list while this thread creates the rest
+    // in order, then joins them rather than idling at the barrier
+    std::vector<size_t> parallel;
+    for (size_t i = 0; i < m_Entries.size(); ++i) {
+        if (m_Entries[i].freeThreaded)
+            parallel.push_back(i);
+    }
+    std::atomic<size_t> next {0};
+    const auto drain = [&] {
+        for (size_t n = next.fetch_add(1); n < parallel.size(); n = next.fetch_add(1))
+            create(parallel[n]);
+    };
+
+    const size_t helpers = pJobs ? std::min<size_t>(pJobs->GetWorkerCount(), parallel.size()) : 0;
+    std::latch done(static_cast<ptrdiff_t>(helpers));
+    for (size_t helper = 0; helper < helpers; ++helper) {
+        pJobs->Submit([&drain, &done] {
+            drain();
+            done.count_down();
+        });
+    }
+    for (size_t i = 0; i < m_Entries.size(); ++i) {
+        if (!m_Entries[i].freeThreaded)
+            create(i);
+    }
+    drain();
+    done.wait();
+
+    m_Stats.created += static_cast<uint64_t>(std::count(errors.begin(), errors.end(), nullptr));
+    ++m_Stats.recreations;
+    m_Stats.lastRecreate =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+        .count();
+
+    for (const auto& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,116 @@
+//
+// GpuResourceRegistry.h - Creation recipes for device-bound resources, replayed after device loss
+//
+// A lost device takes every object created on it, but not what they were made from: the
+// description passed to the device and the initial data, which the assets still hold. Each
+// resource is registered with that recipe and a function that creates the object from it, under
+// a key, usually the address of the member holding the object. Once a new device is up,
+// Recreate replays the recipes, on the job system for devices that create from any thread, so
+// recovery rebuilds exactly what the device took: no asset is read or decoded again, and
+// objects that do not belong to the device are left alone.
+//
+// Recipes are plain bytes and pointers, so the registry runs against a mock device as well as
+// Direct3D (see PongDeviceBench).
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+class JobSystem;
+
+/// Initial data for one subresource, laid out like D3D11_SUBRESOURCE_DATA.
+struct GpuSubresource {
+    const void* pData   = nullptr;
+    uint32_t rowPitch   = 0;
+    uint32_t slicePitch = 0;
+};
+
+/// What a resource is created from.
+struct GpuResourceRecipe {
+    std::vector<std::byte> desc;              // the device's description of the resource, copied
+    std::vector<GpuSubresource> initialData;  // pointing into memory pOwner keeps alive
+    std::shared_ptr<const void> pOwner;       // null when the data is static
+
+    template<typename TDesc>
+    static GpuResourceRecipe Make(const TDesc& desc,
+                                  std::span<const GpuSubresource> initialData = {},
+                                  std::shared_ptr<const void> pOwner          = nullptr) {
+        static_assert(std::is_trivially_copyable_v<TDesc>);
+        GpuResourceRecipe recipe;
+        recipe.desc.resize(sizeof(TDesc));
+        std::memcpy(recipe.desc.data(), &desc, sizeof(TDesc));
+        recipe.initialData.assign(initialData.begin(), initialData.end());
+        recipe.pOwner = std::move(pOwner);
+        return recipe;
+    }
+
+    /// The description, as the type it was made from.
+    template<typename TDesc>
+    TDesc GetDesc() const {
+        static_assert(std::is_trivially_copyable_v<TDesc>);
+        if (desc.size() != sizeof(TDesc))
+            throw std::logic_error("GPU resource description of the wrong type");
+        TDesc value;
+        std::memcpy(&value, desc.data(), sizeof(TDesc));
+        return value;
+    }
+};
+
+struct GpuRegistryStats {
+    uint64_t created     = 0;  // resources created, first creations and recreations
+    uint64_t recreations = 0;  // Recreate calls
+    int64_t lastRecreate = 0;  // nanoseconds the last Recreate took
+};
+
+class GpuResourceRegistry {
+public:
+    /// Creates the resource from its recipe, replacing the object it created before; throws on
+    /// failure.
+    using CreateFunc = std::function<void(const GpuResourceRecipe& recipe)>;
+
+    /// Creates the resource at once and records how, replacing the recipe recorded under `key`.
+    /// Recreate calls `create` from job threads when `freeThreaded`, and otherwise on its own
+    /// thread, in the order the recipes were added.
+    void Add(const void* key,
+             GpuResourceRecipe recipe,
+             CreateFunc create,
+             bool freeThreaded = true);
+
+    /// Forgets the recipe under `key`, if any, so the resource is not created again. Releasing
+    /// the object is up to its owner.
+    void Remove(const void* key) noexcept;
+
+    bool Contains(const void* key) const noexcept;
+    uint32_t GetCount() const noexcept {
+        return static_cast<uint32_t>(m_Entries.size());
+    }
+
+    /// Creates every recorded resource again, after the objects were lost with their device.
+    /// Free-threaded ones run on `pJobs` when given, while this thread creates the rest. Every
+    /// resource is attempted; the first error is rethrown once all have finished.
+    void Recreate(JobSystem* pJobs);
+
+    const GpuRegistryStats& GetStats() const noexcept {
+        return m_Stats;
+    }
+
+private:
+    struct Entry {
+        const void* key;
+        GpuResourceRecipe recipe;
+        CreateFunc create;
+        bool freeThreaded;
+    };
+
+    std::vector<Entry> m_Entries;  // in the order added
+    GpuRegistryStats m_Stats;
+};
@@ -0,0 +1,32 @@
+//
+// Hash.h - FNV-1a hashing for asset names and content
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace Hash {
+    inline constexpr uint64_t kFnvOffset = 0xCBF29CE484222325ull;
+    inline constexpr uint64_t kFnvPrime  = 0x100000001B3ull;
+
+    constexpr uint64_t Fnv1a(const std::string_view str, uint64_t hash = kFnvOffset) noexcept {
+        for (const char c : str) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= kFnvPrime;
+        }
+        return hash;
+    }
+
+    constexpr uint64_t Fnv1a(const std::span<const std::byte> data,
+                             uint64_t hash = kFnvOffset) noexcept {
+        for (const std::byte b : data) {
+            hash ^= static_cast<uint8_t>(b);
+            hash *= kFnvPrime;
+        }
+        return hash;
+    }
+}  // namespace Hash
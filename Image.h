@@ -0,0 +1,18 @@
+//
+// Image.h - CPU-side 8-bit RGBA image
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct Image {
+    uint32_t width  = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;  // RGBA8, rows tightly packed
+
+    uint32_t GetRowPitch() const noexcept {
+        return width * 4;
+    }
+};
@@ -0,0 +1,110 @@
+//
+// ImageDiff.cpp - Per-pixel comparison of RGBA images with a tolerance
+//
+
+#include "ImageDiff.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+#include <stdexcept>
+
+namespace {
+    // Pixels per pass of the SSE2 loop, few enough that its 32-bit lane counters cannot wrap
+    constexpr size_t kChunkPixels = size_t {1} << 24;
+
+    void CheckSameSize(const Image& expected, const Image& actual) {
+        if (expected.width != actual.width || expected.height != actual.height)
+            throw std::invalid_argument("Images differ in size");
+    }
+
+    /// The largest channel difference of the pixel at `p` and `q`.
+    uint8_t GetPixelDelta(const uint8_t* p, const uint8_t* q) noexcept {
+        int delta = 0;
+        for (int channel = 0; channel < 4; ++channel)
+            delta = std::max(delta, std::abs(p[channel] - q[channel]));
+        return static_cast<uint8_t>(delta);
+    }
+}  // namespace
+
+ImageDiffResult DiffImages(const Image& expected, const Image& actual, const uint8_t tolerance) {
+    CheckSameSize(expected, actual);
+
+    ImageDiffResult result;
+    const size_t pixelCount  = size_t {expected.width} * expected.height;
+    const uint8_t* pExpected = expected.pixels.data();
+    const uint8_t* pActual   = actual.pixels.data();
+    size_t pixel             = 0;
+
+#if PONG_SSE2
+    const __m128i tolerances = _mm_set1_epi8(static_cast<char>(tolerance));
+    const __m128i zero       = _mm_setzero_si128();
+    __m128i maxDeltas        = zero;
+    while (pixelCount - pixel >= 4) {
+        const size_t chunk = std::min(kChunkPixels, (pixelCount - pixel) & ~size_t {3});
+        const size_t end   = pixel + chunk;
+        __m128i matching   = zero;  // per lane count of pixels within tolerance
+        for (; pixel < end; pixel += 4) {
+            const auto* pA       = reinterpret_cast<const __m128i*>(pExpected + pixel * 4);
+            const auto* pB       = reinterpret_cast<const __m128i*>(pActual + pixel * 4);
+            const __m128i a      = _mm_loadu_si128(pA);
+            const __m128i b      = _mm_loadu_si128(pB);
+            const __m128i deltas = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+            const __m128i excess = _mm_subs_epu8(deltas, tolerances);
+
+            // A pixel is within tolerance when none of its channels has any excess, so its
+            // 32-bit lane compares equal to zero and the all-ones mask subtracts as +1
+            matching  = _mm_sub_epi32(matching, _mm_cmpeq_epi32(excess, zero));
+            maxDeltas = _mm_max_epu8(maxDeltas, deltas);
+        }
+
+        alignas(16) uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), matching);
+        result.differingPixels += chunk - (uint64_t {lanes[0]} + lanes[1] + lanes[2] + lanes[3]);
+    }
+
+    alignas(16) uint8_t bytes[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(bytes), maxDeltas);
+    result.maxDelta = *std::max_element(bytes, bytes + 16);
+#endif
+
+    for (; pixel < pixelCount; ++pixel) {
+        const uint8_t delta = GetPixelDelta(pExpected + pixel * 4, pActual + pixel * 4);
+        result.maxDelta     = std::max(result.maxDelta, delta);
+        if (delta > tolerance)
+            ++result.differingPixels;
+    }
+    return result;
+}
+
+Image MakeDiffHeatmap(const Image& expected, const Image& actual, const uint8_t tolerance) {
+    CheckSameSize(expected, actual);
+
+    Image heatmap;
+    heatmap.width           = expected.width;
+    heatmap.height          = expected.height;
+    const size_t pixelCount = size_t {expected.width} * expected.height;
+    heatmap.pixels.resize(pixelCount * 4);
+    for (size_t pixel = 0; pixel < pixelCount; ++pixel) {
+        const uint8_t* p    = expected.pixels.data() + pixel * 4;
+        const uint8_t delta = GetPixelDelta(p, actual.pixels.data() + pixel * 4);
+        uint8_t* pOut       = heatmap.pixels.data() + pixel * 4;
+        if (delta > tolerance) {
+            const int excess = delta - tolerance;
+            const int range  = 255 - tolerance;
+            pOut[0]          = 255;
+            pOut[1]          = static_cast<uint8_t>((excess - 1) * 255 / std::max(range - 1, 1));
+            pOut[2]          = 0;
+        } else {
+            // Rec. 601 luma at a quarter brightness, so the differences stand out
+            const auto grey = static_cast<uint8_t>((p[0] * 77 + p[1] * 150 + p[2] * 29) >> 10);
+            pOut[0]         = grey;
+            pOut[1]         = grey;
+            pOut[2]         = grey;
+        }
+        pOut[3] = 255;
+    }
+    return heatmap;
+}
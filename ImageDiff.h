@@ -0,0 +1,25 @@
+//
+// ImageDiff.h - Per-pixel comparison of RGBA images with a tolerance
+//
+// Used to check rendered frames against reference images: a pixel differs when any of its
+// channels is more than `tolerance` away from the expected value.
+//
+
+#pragma once
+
+#include "Image.h"
+
+#include <cstdint>
+
+struct ImageDiffResult {
+    uint64_t differingPixels = 0;
+    uint8_t maxDelta         = 0;  // largest channel difference anywhere, within tolerance or not
+};
+
+/// Compares two images of the same size, 4 pixels at a time with SSE2 where available. Throws
+/// std::invalid_argument if the sizes differ.
+ImageDiffResult DiffImages(const Image& expected, const Image& actual, uint8_t tolerance);
+
+/// An image of where two same-sized images differ: `expected` dimmed to grey, with every pixel
+/// past the tolerance painted from red (just past it) to yellow (the largest possible delta).
+Image MakeDiffHeatmap(const Image& expected, const Image& actual, uint8_t tolerance);
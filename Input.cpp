@@ -0,0 +1,74 @@
+//
+// Input.cpp - Timestamped input events, fixed-tick sampling and exact replays
+//
+
+#include "Input.h"
+#include "LatencyTracer.h"
+
+InputTimeline::InputTimeline(const std::chrono::nanoseconds tickLength) noexcept
+    : m_TickLength(tickLength.count()) {}
+
+void InputTimeline::Start(const int64_t startTime) noexcept {
+    m_StartTime = startTime;
+    m_Tick      = 0;
+    m_Held      = {};
+}
+
+uint32_t InputTimeline::GetDueTicks(const int64_t now, const uint32_t maxTicks) noexcept {
+    const int64_t elapsed = now - m_StartTime;
+    if (elapsed < 0)
+        return 0;
+
+    const uint64_t due = static_cast<uint64_t>(elapsed / m_TickLength) - m_Tick;
+    if (due <= maxTicks)
+        return static_cast<uint32_t>(due);
+
+    m_StartTime += static_cast<int64_t>(due - maxTicks) * m_TickLength;
+    return maxTicks;
+}
+
+SimInput InputTimeline::NextTick(InputQueue& queue, LatencyTracer* pTracer) {
+    // An action pressed at any point in the window counts for the whole tick, so a tap
+    // released before the window closes is not lost
+    std::array<bool, kInputActionCount> active = m_Held;
+
+    const int64_t windowEnd = m_StartTime + static_cast<int64_t>(m_Tick + 1) * m_TickLength;
+    while (const InputEvent* pEvent = queue.Peek()) {
+        if (pEvent->time >= windowEnd)
+            break;
+        const auto action = static_cast<size_t>(pEvent->action);
+        m_Held[action]    = pEvent->pressed;
+        active[action]    = active[action] || pEvent->pressed;
+        if (pTracer && pEvent->traceId)
+            pTracer->Begin(pEvent->traceId, pEvent->time);
+        queue.Pop();
+    }
+    m_Tick++;
+
+    const auto axis = [&](const InputAction up, const InputAction down) {
+        return static_cast<float>(active[static_cast<size_t>(down)]) -
+               static_cast<float>(active[static_cast<size_t>(up)]);
+    };
+    return {axis(InputAction::LeftUp, InputAction::LeftDown),
+            axis(InputAction::RightUp, InputAction::RightDown)};
+}
+
+void InputRecording::Clear() noexcept {
+    m_Changes.clear();
+    m_TickCount = 0;
+}
+
+void InputRecording::Record(const SimInput& input) {
+    const SimInput previous = m_Changes.empty() ? SimInput {} : m_Changes.back().input;
+    if (m_TickCount == 0 || input != previous)
+        m_Changes.push_back({m_TickCount, input});
+    m_TickCount++;
+}
+
+SimInput InputReplay::NextTick() noexcept {
+    const auto& changes = m_pRecording->GetChanges();
+    if (m_Next < changes.size() && changes[m_Next].tick == m_Tick)
+        m_Input = changes[m_Next++].input;
+    m_Tick++;
+    return m_Input;
+}
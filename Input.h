@@ -0,0 +1,126 @@
+//
+// Input.h - Timestamped input events, fixed-tick sampling and exact replays
+//
+// The window thread stamps each key press or release on a high-resolution clock and pushes it
+// into a lock-free queue. The simulation runs in fixed ticks on the same clock, and each tick
+// applies exactly the events stamped inside its window, regardless of when frames happen to
+// run. Recording the resulting per-tick input is enough to replay a match exactly.
+//
+// Events can carry a LatencyTracer id; the tick that applies a traced event starts its trace.
+//
+
+#pragma once
+
+#include "Sim.h"
+#include "SpscQueue.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class LatencyTracer;
+
+enum class InputAction : uint8_t { LeftUp, LeftDown, RightUp, RightDown };
+
+inline constexpr uint32_t kInputActionCount = 4;
+
+struct InputEvent {
+    int64_t time;  // GetInputTime() when the event was seen
+    InputAction action;
+    bool pressed;
+    uint32_t traceId;  // from LatencyTracer::NextId, or 0 if untraced
+};
+
+/// Presses and releases, from the window thread to the thread running the simulation. A full
+/// queue drops events, so the consumer should drain it at least once a frame.
+using InputQueue = SpscQueue<InputEvent, 1024>;
+
+/// Nanoseconds on a monotonic high-resolution clock (QueryPerformanceCounter on Windows).
+inline int64_t GetInputTime() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// Divides time into fixed ticks and turns the events stamped inside each tick's window into
+/// that tick's SimInput.
+class InputTimeline {
+public:
+    explicit InputTimeline(std::chrono::nanoseconds tickLength) noexcept;
+
+    /// Restarts at tick 0, whose window opens at `startTime`, with every action released.
+    void Start(int64_t startTime) noexcept;
+
+    /// The number of ticks whose windows have closed by `now` and not been consumed. When more
+    /// than `maxTicks` are due the windows are moved forward so only `maxTicks` remain, and the
+    /// events in the skipped windows land on the next tick.
+    uint32_t GetDueTicks(int64_t now, uint32_t maxTicks) noexcept;
+
+    /// Applies the queued events stamped before the next tick's window closes and returns the
+    /// tick's input, in which an action counts if it was held at any point of the window.
+    /// Events from later windows stay queued. Traced events begin their traces on `pTracer`.
+    SimInput NextTick(InputQueue& queue, LatencyTracer* pTracer = nullptr);
+
+    /// Ticks consumed since Start.
+    uint64_t GetTick() const noexcept {
+        return m_Tick;
+    }
+
+private:
+    int64_t m_TickLength;
+    int64_t m_StartTime = 0;
+    uint64_t m_Tick     = 0;
+    std::array<bool, kInputActionCount> m_Held {};
+};
+
+/// A tick whose input differs from the tick before it.
+struct InputChange {
+    uint32_t tick;
+    SimInput input;
+};
+
+/// The input of every tick of a match, stored as the ticks where it changed.
+class InputRecording {
+public:
+    void Clear() noexcept;
+
+    /// Appends the next tick's input.
+    void Record(const SimInput& input);
+
+    uint32_t GetTickCount() const noexcept {
+        return m_TickCount;
+    }
+    const std::vector<InputChange>& GetChanges() const noexcept {
+        return m_Changes;
+    }
+
+private:
+    std::vector<InputChange> m_Changes;
+    uint32_t m_TickCount = 0;
+};
+
+/// Plays a recording back tick by tick. Stepping a Sim reset with the recorded match's options
+/// by the same fixed tick reproduces the match exactly. The recording must outlive the replay
+/// and not change during it.
+class InputReplay {
+public:
+    explicit InputReplay(const InputRecording& recording) noexcept : m_pRecording(&recording) {}
+
+    bool IsFinished() const noexcept {
+        return m_Tick >= m_pRecording->GetTickCount();
+    }
+
+    SimInput NextTick() noexcept;
+
+    /// Ticks played so far.
+    uint32_t GetTick() const noexcept {
+        return m_Tick;
+    }
+
+private:
+    const InputRecording* m_pRecording;
+    uint32_t m_Tick = 0;
+    size_t m_Next   = 0;  // first change not yet applied
+    SimInput m_Input;
+};
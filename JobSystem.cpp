@@ -0,0 +1,63 @@
+//
+// JobSystem.cpp - Fixed pool of worker threads for background jobs
+//
+
+#include "JobSystem.h"
+
+#include <algorithm>
+
+JobSystem::JobSystem(const unsigned workerCount) {
+    const unsigned count = std::max(1u, workerCount);
+    m_Workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+        m_Workers.emplace_back([this] { WorkerMain(); });
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_WorkAvailable.notify_all();
+
+    for (auto& worker : m_Workers)
+        worker.join();
+}
+
+void JobSystem::Submit(Job job) {
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Queue.push_back(std::move(job));
+    }
+    m_WorkAvailable.notify_one();
+}
+
+void JobSystem::WaitIdle() {
+    std::unique_lock lock(m_Mutex);
+    m_Idle.wait(lock, [this] { return m_Queue.empty() && m_Running == 0; });
+}
+
+unsigned JobSystem::GetDefaultWorkerCount() noexcept {
+    const unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 1;
+}
+
+void JobSystem::WorkerMain() {
+    std::unique_lock lock(m_Mutex);
+    for (;;) {
+        m_WorkAvailable.wait(lock, [this] { return m_Stopping || !m_Queue.empty(); });
+        if (m_Queue.empty())
+            return;
+
+        Job job = std::move(m_Queue.front());
+        m_Queue.pop_front();
+        ++m_Running;
+
+        lock.unlock();
+        job();
+        lock.lock();
+
+        if (--m_Running == 0 && m_Queue.empty())
+            m_Idle.notify_all();
+    }
+}
@@ -0,0 +1,48 @@
+//
+// JobSystem.h - Fixed pool of worker threads for background jobs
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    explicit JobSystem(unsigned workerCount = GetDefaultWorkerCount());
+    /// Finishes every queued job (including jobs they submit) before joining the workers.
+    ~JobSystem();
+
+    JobSystem(JobSystem const&)            = delete;
+    JobSystem& operator=(JobSystem const&) = delete;
+
+    /// Jobs must not throw; wrap fallible work and report errors through the result.
+    void Submit(Job job);
+
+    /// Blocks until the queue is empty and no job is running.
+    void WaitIdle();
+
+    unsigned GetWorkerCount() const noexcept {
+        return static_cast<unsigned>(m_Workers.size());
+    }
+
+    /// One worker per hardware thread, leaving one for the thread that drives the frame.
+    static unsigned GetDefaultWorkerCount() noexcept;
+
+private:
+    void WorkerMain();
+
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkAvailable;
+    std::condition_variable m_Idle;
+    std::deque<Job> m_Queue;
+    unsigned m_Running = 0;
+    bool m_Stopping    = false;
+    std::vector<std::thread> m_Workers;
+};
@@ -0,0 +1,100 @@
+//
+// LatencyTracer.cpp - Input-to-present latency, traced per input event
+//
+
+#include "LatencyTracer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+LatencyTracer::LatencyTracer(const LatencyStage lastStage, const uint32_t historySize)
+    : m_LastStage(lastStage), m_HistorySize(historySize) {
+    if (historySize == 0)
+        throw std::invalid_argument("LatencyTracer needs room for at least one trace");
+    m_History.reserve(historySize);
+}
+
+uint32_t LatencyTracer::NextId() noexcept {
+    uint32_t id = m_NextId.fetch_add(1, std::memory_order_relaxed);
+    if (id == 0)  // wrapped
+        id = m_NextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void LatencyTracer::Begin(const uint32_t id, const int64_t inputTime) {
+    m_Pending.push_back({{id, inputTime, {}}, 0});
+}
+
+void LatencyTracer::Mark(const LatencyStage stage, const int64_t time) {
+    const auto index  = static_cast<uint32_t>(stage);
+    const bool isLast = stage == m_LastStage;
+
+    // Pending traces stay in the order they began, so the finished ones are compacted out in
+    // place and enter the history in that order
+    size_t kept = 0;
+    for (PendingTrace& pending : m_Pending) {
+        if (pending.reached == index) {
+            pending.trace.stageTimes[index] = time;
+            pending.reached++;
+            if (isLast) {
+                if (m_History.size() < m_HistorySize)
+                    m_History.push_back(pending.trace);
+                else
+                    m_History[m_HistoryNext] = pending.trace;
+                m_HistoryNext = (m_HistoryNext + 1) % m_HistorySize;
+                m_FinishedCount++;
+                continue;
+            }
+        }
+        m_Pending[kept++] = pending;
+    }
+    m_Pending.resize(kept);
+}
+
+LatencySummary LatencyTracer::GetSummary(const LatencyStage stage) const {
+    LatencySummary summary;
+    if (m_History.empty() || stage > m_LastStage)
+        return summary;
+
+    std::vector<double> latencies;
+    latencies.reserve(m_History.size());
+    const auto index = static_cast<size_t>(stage);
+    for (const LatencyTrace& trace : m_History)
+        latencies.push_back(static_cast<double>(trace.stageTimes[index] - trace.inputTime) * 1e-6);
+    std::sort(latencies.begin(), latencies.end());
+
+    // Nearest-rank percentiles
+    const auto percentile = [&](const double p) {
+        const auto rank = static_cast<size_t>(p * static_cast<double>(latencies.size() - 1) + 0.5);
+        return latencies[rank];
+    };
+    double sum = 0.0;
+    for (const double latency : latencies)
+        sum += latency;
+
+    summary.count = static_cast<uint32_t>(latencies.size());
+    summary.mean  = sum / static_cast<double>(latencies.size());
+    summary.p50   = percentile(0.5);
+    summary.p90   = percentile(0.9);
+    summary.p99   = percentile(0.99);
+    summary.max   = latencies.back();
+    return summary;
+}
+
+std::vector<LatencyTrace> LatencyTracer::GetHistory() const {
+    if (m_History.size() < m_HistorySize)
+        return m_History;
+
+    std::vector<LatencyTrace> history;
+    history.reserve(m_History.size());
+    history.insert(history.end(), m_History.begin() + m_HistoryNext, m_History.end());
+    history.insert(history.end(), m_History.begin(), m_History.begin() + m_HistoryNext);
+    return history;
+}
+
+void LatencyTracer::Clear() noexcept {
+    m_Pending.clear();
+    m_History.clear();
+    m_HistoryNext   = 0;
+    m_FinishedCount = 0;
+}
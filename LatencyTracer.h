@@ -0,0 +1,98 @@
+//
+// LatencyTracer.h - Input-to-present latency, traced per input event
+//
+// Each input event carries a trace id from the moment the window procedure stamps it. The tick
+// that applies the event starts its trace, and every later stage of the frame pipeline marks all
+// the traces that have reached the stage before it, so a trace ends with the first frame that
+// could show its effect. Only the thread running the frame loop touches a tracer, apart from
+// NextId.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/// Pipeline stages, in order, after the input was stamped.
+enum class LatencyStage : uint8_t {
+    Simulated,  // the tick that applied the input has been stepped
+    Rendered,   // a frame drawn from that tick or a later one has been recorded
+    Submitted,  // the frame has been handed to the display (Present called)
+    Presented,  // Present returned; with vsync, close to when the frame reaches the screen
+};
+
+inline constexpr uint32_t kLatencyStageCount = 4;
+
+/// A finished trace. Times are GetInputTime() nanoseconds; stages after the tracer's last stage
+/// are zero.
+struct LatencyTrace {
+    uint32_t id;
+    int64_t inputTime;
+    std::array<int64_t, kLatencyStageCount> stageTimes;
+};
+
+/// Input-to-stage latency over a tracer's history, in milliseconds.
+struct LatencySummary {
+    uint32_t count = 0;
+    double mean    = 0.0;
+    double p50     = 0.0;
+    double p90     = 0.0;
+    double p99     = 0.0;
+    double max     = 0.0;
+};
+
+class LatencyTracer {
+public:
+    /// Traces finish at `lastStage`, and the most recent `historySize` finished traces are kept
+    /// for the summaries.
+    explicit LatencyTracer(LatencyStage lastStage = LatencyStage::Presented,
+                           uint32_t historySize = 1024);
+
+    LatencyTracer(LatencyTracer const&)            = delete;
+    LatencyTracer& operator=(LatencyTracer const&) = delete;
+
+    /// A new trace id for an input event, from any thread. Never 0, which marks untraced events.
+    uint32_t NextId() noexcept;
+
+    /// Starts tracing an input stamped at `inputTime` that the current tick applies. The trace
+    /// reaches LatencyStage::Simulated at the next Mark of that stage.
+    void Begin(uint32_t id, int64_t inputTime);
+
+    /// Moves every trace that has reached the stage before `stage` on to it, at `time`. Traces
+    /// reaching the last stage are finished and added to the history.
+    void Mark(LatencyStage stage, int64_t time);
+
+    /// Latency from input to `stage` over the history.
+    LatencySummary GetSummary(LatencyStage stage) const;
+
+    /// The history, oldest first.
+    std::vector<LatencyTrace> GetHistory() const;
+
+    /// Traces finished since construction or Clear, including those no longer in the history.
+    uint64_t GetFinishedCount() const noexcept {
+        return m_FinishedCount;
+    }
+    /// Traces started but not yet finished.
+    size_t GetPendingCount() const noexcept {
+        return m_Pending.size();
+    }
+
+    /// Drops pending traces and the history.
+    void Clear() noexcept;
+
+private:
+    struct PendingTrace {
+        LatencyTrace trace;
+        uint32_t reached;  // stages reached so far
+    };
+
+    LatencyStage m_LastStage;
+    std::atomic<uint32_t> m_NextId {1};
+    std::vector<PendingTrace> m_Pending;
+    std::vector<LatencyTrace> m_History;  // ring buffer once full
+    uint32_t m_HistorySize;
+    uint32_t m_HistoryNext   = 0;
+    uint64_t m_FinishedCount = 0;
+};
@@ -0,0 +1,159 @@
+//
+// Lz.cpp - Small LZ77 block codec used for packed assets
+//
+// The stream is a series of sequences. Each sequence starts with a token byte whose high nibble
+// is the literal run length and whose low nibble is the match length minus kMinMatch; a nibble of
+// 15 means extra length bytes follow (each 255 continues). The literals come next, then a 16-bit
+// little-endian back-reference offset. The final sequence carries only literals.
+//
+
+#include "Lz.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    constexpr size_t kMinMatch  = 4;
+    constexpr size_t kMaxOffset = 0xFFFF;
+    constexpr int kHashBits     = 14;
+
+    uint32_t Load32(const std::byte* p) noexcept {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint32_t Hash(const uint32_t seq) noexcept {
+        return (seq * 2654435761u) >> (32 - kHashBits);
+    }
+
+    std::byte* WriteLength(std::byte* op, size_t length) noexcept {
+        while (length >= 255) {
+            *op++ = std::byte {255};
+            length -= 255;
+        }
+        *op++ = static_cast<std::byte>(length);
+        return op;
+    }
+
+    std::byte* WriteSequence(std::byte* op,
+                             const std::byte* literals,
+                             const size_t literalLength,
+                             const size_t offset,
+                             const size_t matchLength) noexcept {
+        const size_t litNibble   = std::min<size_t>(literalLength, 15);
+        const size_t matchNibble = matchLength ? std::min<size_t>(matchLength - kMinMatch, 15) : 0;
+        *op++                    = static_cast<std::byte>(litNibble << 4 | matchNibble);
+
+        if (litNibble == 15)
+            op = WriteLength(op, literalLength - 15);
+        std::memcpy(op, literals, literalLength);
+        op += literalLength;
+
+        if (matchLength == 0)
+            return op;
+
+        *op++ = static_cast<std::byte>(offset & 0xFF);
+        *op++ = static_cast<std::byte>(offset >> 8);
+        if (matchNibble == 15)
+            op = WriteLength(op, matchLength - kMinMatch - 15);
+        return op;
+    }
+
+    bool ReadLength(const std::byte*& ip, const std::byte* end, size_t& length) noexcept {
+        for (;;) {
+            if (ip == end)
+                return false;
+            const auto b = static_cast<size_t>(*ip++);
+            length += b;
+            if (b != 255)
+                return true;
+        }
+    }
+}  // namespace
+
+size_t Lz::Compress(const std::span<const std::byte> src, const std::span<std::byte> dst) {
+    if (dst.size() < CompressBound(src.size()))
+        throw std::invalid_argument("Lz::Compress destination is smaller than CompressBound");
+
+    std::vector<int64_t> table(size_t {1} << kHashBits, -1);
+
+    const std::byte* base = src.data();
+    const size_t size     = src.size();
+    std::byte* op         = dst.data();
+
+    size_t ip     = 0;
+    size_t anchor = 0;
+    while (ip + kMinMatch <= size) {
+        const uint32_t seq = Load32(base + ip);
+        const uint32_t h   = Hash(seq);
+        const int64_t cand = table[h];
+        table[h]           = static_cast<int64_t>(ip);
+
+        if (cand < 0 || ip - static_cast<size_t>(cand) > kMaxOffset ||
+            Load32(base + cand) != seq) {
+            ++ip;
+            continue;
+        }
+
+        size_t length = kMinMatch;
+        while (ip + length < size && base[cand + length] == base[ip + length])
+            ++length;
+
+        op     = WriteSequence(op, base + anchor, ip - anchor, ip - cand, length);
+        ip    += length;
+        anchor = ip;
+    }
+
+    op = WriteSequence(op, base + anchor, size - anchor, 0, 0);
+    return static_cast<size_t>(op - dst.data());
+}
+
+bool Lz::Decompress(const std::span<const std::byte> src, const std::span<std::byte> dst) noexcept {
+    const std::byte* ip  = src.data();
+    const std::byte* end = ip + src.size();
+    std::byte* op        = dst.data();
+    std::byte* opEnd     = op + dst.size();
+
+    while (ip < end) {
+        const auto token = static_cast<size_t>(*ip++);
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !ReadLength(ip, end, literalLength))
+            return false;
+        if (literalLength > static_cast<size_t>(end - ip) ||
+            literalLength > static_cast<size_t>(opEnd - op))
+            return false;
+        std::memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip == end)
+            break;
+
+        if (end - ip < 2)
+            return false;
+        const size_t offset = static_cast<size_t>(ip[0]) | static_cast<size_t>(ip[1]) << 8;
+        ip += 2;
+
+        size_t matchLength = token & 0xF;
+        if (matchLength == 15 && !ReadLength(ip, end, matchLength))
+            return false;
+        matchLength += kMinMatch;
+
+        if (offset == 0 || offset > static_cast<size_t>(op - dst.data()) ||
+            matchLength > static_cast<size_t>(opEnd - op))
+            return false;
+
+        // Byte-wise copy so overlapping matches (offset < length) replicate correctly.
+        const std::byte* match = op - offset;
+        for (size_t i = 0; i < matchLength; ++i)
+            op[i] = match[i];
+        op += matchLength;
+    }
+
+    return op == opEnd;
+}
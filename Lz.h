@@ -0,0 +1,23 @@
+//
+// Lz.h - Small LZ77 block codec used for packed assets
+//
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace Lz {
+    /// Worst-case compressed size for an input of `size` bytes.
+    constexpr size_t CompressBound(const size_t size) noexcept {
+        return size + size / 255 + 16;
+    }
+
+    /// Compresses `src` into `dst` and returns the number of bytes written. `dst` must be at least
+    /// CompressBound(src.size()) bytes.
+    size_t Compress(std::span<const std::byte> src, std::span<std::byte> dst);
+
+    /// Decompresses `src` into `dst`, which must be exactly the original size. Returns false if
+    /// the stream is malformed or does not fill `dst` exactly.
+    bool Decompress(std::span<const std::byte> src, std::span<std::byte> dst) noexcept;
+}  // namespace Lz
@@ -0,0 +1,152 @@
+//
+// MappedFile.cpp - Read-only memory mapping of a file
+//
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+namespace {
+    [[noreturn]] void ThrowLastError(const char* what) {
+#ifdef _WIN32
+        throw std::system_error(
+          std::error_code(static_cast<int>(::GetLastError()), std::system_category()), what);
+#else
+        throw std::system_error(std::error_code(errno, std::generic_category()), what);
+#endif
+    }
+}  // namespace
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        m_pData = std::exchange(other.m_pData, nullptr);
+        m_Size  = std::exchange(other.m_Size, 0);
+#ifdef _WIN32
+        m_hFile    = std::exchange(other.m_hFile, nullptr);
+        m_hMapping = std::exchange(other.m_hMapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+void MappedFile::Open(const std::filesystem::path& path) {
+    Close();
+
+    const HANDLE file = ::CreateFileW(path.c_str(),
+                                      GENERIC_READ,
+                                      FILE_SHARE_READ,
+                                      nullptr,
+                                      OPEN_EXISTING,
+                                      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                      nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        ThrowLastError("CreateFileW");
+    m_hFile = file;
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size)) {
+        Close();
+        ThrowLastError("GetFileSizeEx");
+    }
+    if (size.QuadPart == 0) {
+        Close();
+        throw std::runtime_error("Cannot map an empty file");
+    }
+
+    m_hMapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_hMapping) {
+        Close();
+        ThrowLastError("CreateFileMappingW");
+    }
+
+    const void* view = ::MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        Close();
+        ThrowLastError("MapViewOfFile");
+    }
+
+    m_pData = static_cast<const std::byte*>(view);
+    m_Size  = static_cast<size_t>(size.QuadPart);
+}
+
+void MappedFile::Close() noexcept {
+    if (m_pData)
+        ::UnmapViewOfFile(m_pData);
+    if (m_hMapping)
+        ::CloseHandle(m_hMapping);
+    if (m_hFile)
+        ::CloseHandle(m_hFile);
+
+    m_pData    = nullptr;
+    m_Size     = 0;
+    m_hMapping = nullptr;
+    m_hFile    = nullptr;
+}
+
+#else
+
+void MappedFile::Open(const std::filesystem::path& path) {
+    Close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        ThrowLastError("open");
+
+    struct stat st = {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        ThrowLastError("fstat");
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map an empty file");
+    }
+
+    void* view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+    if (view == MAP_FAILED)
+        ThrowLastError("mmap");
+
+    m_pData = static_cast<const std::byte*>(view);
+    m_Size  = static_cast<size_t>(st.st_size);
+}
+
+void MappedFile::Close() noexcept {
+    if (m_pData)
+        ::munmap(const_cast<std::byte*>(m_pData), m_Size);
+
+    m_pData = nullptr;
+    m_Size  = 0;
+}
+
+#endif
@@ -0,0 +1,44 @@
+//
+// MappedFile.h - Read-only memory mapping of a file
+//
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+/// Maps a whole file read-only into the address space. Pages are faulted in on first access, so
+/// opening is cheap regardless of file size.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(MappedFile const&)            = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    /// Throws std::system_error if the file cannot be opened or mapped.
+    void Open(const std::filesystem::path& path);
+    void Close() noexcept;
+
+    bool IsOpen() const noexcept {
+        return m_pData != nullptr;
+    }
+
+    std::span<const std::byte> GetData() const noexcept {
+        return {m_pData, m_Size};
+    }
+
+private:
+    const std::byte* m_pData = nullptr;
+    size_t m_Size            = 0;
+
+#ifdef _WIN32
+    void* m_hFile    = nullptr;
+    void* m_hMapping = nullptr;
+#endif
+};
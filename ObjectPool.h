@@ -0,0 +1,165 @@
+//
+// ObjectPool.h - Fixed-capacity object pool addressed through generation-checked handles
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+/// Handle to an object in an ObjectPool<T>. A handle stays safe to use after its object is
+/// destroyed: the slot's generation changes, so lookups through the stale handle fail.
+template<typename T>
+struct PoolHandle {
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    uint32_t index      = kInvalidIndex;
+    uint32_t generation = 0;
+
+    bool IsValid() const noexcept {
+        return index != kInvalidIndex;
+    }
+
+    friend bool operator==(const PoolHandle&, const PoolHandle&) = default;
+};
+
+/// Stores up to a fixed number of objects in one packed array, allocated up front. Live objects
+/// are always contiguous, so iteration touches only them. Destroy() moves the last object into
+/// the hole, which means object addresses and iteration order are not stable; hold handles, not
+/// pointers, across frames.
+///
+/// Handles index a sparse slot table that maps to the dense position, so Create, Destroy and Get
+/// are all O(1).
+template<typename T>
+class ObjectPool {
+public:
+    using Handle = PoolHandle<T>;
+
+    explicit ObjectPool(const uint32_t capacity)
+        : m_Capacity(capacity),
+          m_pObjects(std::allocator<T>().allocate(capacity)),
+          m_pSlots(std::make_unique<Slot[]>(capacity)),
+          m_pDenseToSlot(std::make_unique<uint32_t[]>(capacity)) {
+        for (uint32_t i = 0; i < capacity; ++i)
+            m_pSlots[i].dense = i + 1;  // free list threads through the unused slots
+        m_FreeSlot = capacity ? 0 : kNoSlot;
+    }
+
+    ~ObjectPool() {
+        Clear();
+        std::allocator<T>().deallocate(m_pObjects, m_Capacity);
+    }
+
+    ObjectPool(ObjectPool const&)            = delete;
+    ObjectPool& operator=(ObjectPool const&) = delete;
+
+    /// Returns an invalid handle if the pool is full.
+    template<typename... TArgs>
+    Handle Create(TArgs&&... args) {
+        if (m_FreeSlot >= m_Capacity)
+            return {};
+
+        const uint32_t slotIndex = m_FreeSlot;
+        Slot& slot               = m_pSlots[slotIndex];
+        ::new (static_cast<void*>(m_pObjects + m_Size)) T(std::forward<TArgs>(args)...);
+
+        m_FreeSlot               = slot.dense;
+        slot.dense               = m_Size;
+        m_pDenseToSlot[m_Size++] = slotIndex;
+        return {slotIndex, slot.generation};
+    }
+
+    /// Returns false if the handle is stale or invalid.
+    bool Destroy(const Handle handle) {
+        if (!Contains(handle))
+            return false;
+
+        Slot& slot          = m_pSlots[handle.index];
+        const uint32_t hole = slot.dense;
+        const uint32_t last = --m_Size;
+
+        std::destroy_at(m_pObjects + hole);
+        if (hole != last) {
+            ::new (static_cast<void*>(m_pObjects + hole)) T(std::move(m_pObjects[last]));
+            std::destroy_at(m_pObjects + last);
+
+            const uint32_t movedSlot = m_pDenseToSlot[last];
+            m_pDenseToSlot[hole]      = movedSlot;
+            m_pSlots[movedSlot].dense = hole;
+        }
+
+        slot.generation++;
+        slot.dense = m_FreeSlot;
+        m_FreeSlot = handle.index;
+        return true;
+    }
+
+    void Clear() noexcept {
+        while (m_Size)
+            Destroy(GetHandle(m_Size - 1));
+    }
+
+    bool Contains(const Handle handle) const noexcept {
+        if (handle.index >= m_Capacity)
+            return false;
+        const Slot& slot = m_pSlots[handle.index];
+        return slot.generation == handle.generation && slot.dense < m_Size &&
+               m_pDenseToSlot[slot.dense] == handle.index;
+    }
+
+    /// Returns nullptr if the handle is stale or invalid.
+    T* Get(const Handle handle) noexcept {
+        return Contains(handle) ? m_pObjects + m_pSlots[handle.index].dense : nullptr;
+    }
+    const T* Get(const Handle handle) const noexcept {
+        return Contains(handle) ? m_pObjects + m_pSlots[handle.index].dense : nullptr;
+    }
+
+    /// Handle of the object at a position in the packed array.
+    Handle GetHandle(const uint32_t denseIndex) const noexcept {
+        assert(denseIndex < m_Size);
+        const uint32_t slotIndex = m_pDenseToSlot[denseIndex];
+        return {slotIndex, m_pSlots[slotIndex].generation};
+    }
+
+    uint32_t GetSize() const noexcept {
+        return m_Size;
+    }
+    uint32_t GetCapacity() const noexcept {
+        return m_Capacity;
+    }
+    bool IsFull() const noexcept {
+        return m_Size == m_Capacity;
+    }
+
+    T* begin() noexcept {
+        return m_pObjects;
+    }
+    T* end() noexcept {
+        return m_pObjects + m_Size;
+    }
+    const T* begin() const noexcept {
+        return m_pObjects;
+    }
+    const T* end() const noexcept {
+        return m_pObjects + m_Size;
+    }
+
+private:
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+    struct Slot {
+        uint32_t dense      = 0;  // position in the packed array, or the next free slot
+        uint32_t generation = 0;
+    };
+
+    uint32_t m_Capacity;
+    uint32_t m_Size     = 0;
+    uint32_t m_FreeSlot = kNoSlot;
+    T* m_pObjects;
+    std::unique_ptr<Slot[]> m_pSlots;
+    std::unique_ptr<uint32_t[]> m_pDenseToSlot;
+};
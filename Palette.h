@@ -0,0 +1,28 @@
+//
+// Palette.h - Colors shared by the Direct3D and software renderers, 0xAARRGGBB
+//
+
+#pragma once
+
+#include "Sim.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+inline constexpr uint32_t kClearColor = 0xFF11121C;
+
+// Drawn in place of sprites whose textures are still loading
+inline constexpr uint32_t kPlaceholderColor = 0xFF404252;
+
+// Breakout bricks are tinted in horizontal bands
+inline constexpr uint32_t kBrickColors[] = {
+  0xFFE05A5A, 0xFFE0A050, 0xFFE0D060, 0xFF60C070, 0xFF5090E0, 0xFF9070D0};
+inline constexpr float kBrickBandHeight =
+  kCourtHeight / static_cast<float>(std::size(kBrickColors));
+
+inline uint32_t GetBrickColor(const float y) noexcept {
+    const auto band = static_cast<size_t>(std::max(y, 0.f) / kBrickBandHeight);
+    return kBrickColors[std::min(band, std::size(kBrickColors) - 1)];
+}
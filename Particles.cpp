@@ -0,0 +1,241 @@
+//
+// Particles.cpp - Structure-of-arrays particle system with an SSE2 update
+//
+
+#include "Particles.h"
+#include "JobSystem.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <latch>
+#include <new>
+
+namespace {
+    constexpr uint32_t kArrayCount = 9;
+    constexpr std::align_val_t kStorageAlignment {64};
+
+    // Chunks updated by one job; a single group runs on the calling thread
+    constexpr uint32_t kChunksPerJob = 8;
+}  // namespace
+
+void ParticleSystem::AlignedDelete::operator()(float* p) const noexcept {
+    ::operator delete[](p, kStorageAlignment);
+}
+
+ParticleSystem::ParticleSystem(const uint32_t capacity, const float gravity, const uint32_t seed)
+    : m_ChunkCount(std::max(1u, (capacity + kChunkSize - 1) / kChunkSize)),
+      m_Gravity(gravity),
+      m_RandomState(seed ? seed : 1),
+      m_pCounts(std::make_unique<uint32_t[]>(m_ChunkCount)) {
+    const size_t elements = size_t {m_ChunkCount} * kChunkSize;
+    m_pStorage.reset(static_cast<float*>(
+      ::operator new[](elements * kArrayCount * sizeof(float), kStorageAlignment)));
+
+    float* p     = m_pStorage.get();
+    m_pX         = p + 0 * elements;
+    m_pY         = p + 1 * elements;
+    m_pVelocityX = p + 2 * elements;
+    m_pVelocityY = p + 3 * elements;
+    m_pLife      = p + 4 * elements;
+    m_pFade      = p + 5 * elements;
+    m_pAlpha     = p + 6 * elements;
+    m_pSize      = p + 7 * elements;
+    m_pColor     = reinterpret_cast<uint32_t*>(p + 8 * elements);
+}
+
+void ParticleSystem::Emit(const ParticleBurst& burst) {
+    const float fade = burst.lifetime > 0.f ? 1.f / burst.lifetime : 0.f;
+    if (fade == 0.f)
+        return;
+
+    for (uint32_t emitted = 0; emitted < burst.count; ++emitted) {
+        while (m_EmitChunk < m_ChunkCount && m_pCounts[m_EmitChunk] == kChunkSize)
+            m_EmitChunk++;
+        if (m_EmitChunk == m_ChunkCount)
+            return;
+
+        const float angle = burst.direction + (NextRandom() * 2.f - 1.f) * burst.spread;
+        const float speed = burst.minSpeed + NextRandom() * (burst.maxSpeed - burst.minSpeed);
+
+        const size_t i  = size_t {m_EmitChunk} * kChunkSize + m_pCounts[m_EmitChunk]++;
+        m_pX[i]         = burst.x;
+        m_pY[i]         = burst.y;
+        m_pVelocityX[i] = std::cos(angle) * speed;
+        m_pVelocityY[i] = std::sin(angle) * speed;
+        m_pLife[i]      = burst.lifetime;
+        m_pFade[i]      = fade;
+        m_pAlpha[i]     = 1.f;
+        m_pSize[i]      = burst.size;
+        m_pColor[i]     = burst.color;
+        m_Count++;
+    }
+}
+
+void ParticleSystem::Update(const float dt, JobSystem* pJobs) {
+    const uint32_t groups = (m_ChunkCount + kChunksPerJob - 1) / kChunksPerJob;
+    if (!pJobs || groups == 1 || m_Count <= kChunkSize * kChunksPerJob) {
+        UpdateChunks(0, m_ChunkCount, dt);
+    } else {
+        // The calling thread takes the first group rather than idling at the barrier
+        std::latch done(groups - 1);
+        for (uint32_t group = 1; group < groups; ++group) {
+            pJobs->Submit([this, &done, group, dt] {
+                UpdateChunks(group * kChunksPerJob,
+                             std::min(m_ChunkCount, (group + 1) * kChunksPerJob),
+                             dt);
+                done.count_down();
+            });
+        }
+        UpdateChunks(0, std::min(m_ChunkCount, kChunksPerJob), dt);
+        done.wait();
+    }
+
+    m_Count     = 0;
+    m_EmitChunk = m_ChunkCount;
+    for (uint32_t chunk = 0; chunk < m_ChunkCount; ++chunk) {
+        m_Count += m_pCounts[chunk];
+        if (m_pCounts[chunk] < kChunkSize)
+            m_EmitChunk = std::min(m_EmitChunk, chunk);
+    }
+}
+
+ParticleChunkView ParticleSystem::GetChunk(const uint32_t chunk) const noexcept {
+    const size_t base = size_t {chunk} * kChunkSize;
+    return {
+      m_pCounts[chunk],
+      m_pX + base,
+      m_pY + base,
+      m_pSize + base,
+      m_pAlpha + base,
+      m_pColor + base,
+    };
+}
+
+void ParticleSystem::UpdateChunks(const uint32_t first,
+                                  const uint32_t last,
+                                  const float dt) noexcept {
+    for (uint32_t chunk = first; chunk < last; ++chunk) {
+        if (m_pCounts[chunk])
+            m_pCounts[chunk] = UpdateChunk(chunk, dt);
+    }
+}
+
+// Integrates, fades and compacts one chunk in a single pass: survivors are written back at the
+// write cursor, which never passes the read cursor, so the compaction is stable and in place.
+uint32_t ParticleSystem::UpdateChunk(const uint32_t chunk, const float dt) noexcept {
+    const size_t base    = size_t {chunk} * kChunkSize;
+    float* const x       = m_pX + base;
+    float* const y       = m_pY + base;
+    float* const vx      = m_pVelocityX + base;
+    float* const vy      = m_pVelocityY + base;
+    float* const life    = m_pLife + base;
+    float* const fade    = m_pFade + base;
+    float* const alpha   = m_pAlpha + base;
+    float* const size    = m_pSize + base;
+    uint32_t* const rgba = m_pColor + base;
+
+    const uint32_t count = m_pCounts[chunk];
+    const float gravity  = m_Gravity * dt;
+    uint32_t write       = 0;
+
+    const auto keep = [&](const uint32_t from,
+                          const float newX,
+                          const float newY,
+                          const float newVy,
+                          const float newLife,
+                          const float newAlpha) {
+        x[write]     = newX;
+        y[write]     = newY;
+        vx[write]    = vx[from];
+        vy[write]    = newVy;
+        life[write]  = newLife;
+        fade[write]  = fade[from];
+        alpha[write] = newAlpha;
+        size[write]  = size[from];
+        rgba[write]  = rgba[from];
+        write++;
+    };
+
+#if PONG_SSE2
+    // Lanes past `count` in the last block hold stale data; they are computed but never kept.
+    const __m128 vDt      = _mm_set1_ps(dt);
+    const __m128 vGravity = _mm_set1_ps(gravity);
+    const __m128 vZero    = _mm_setzero_ps();
+
+    for (uint32_t read = 0; read < count; read += 4) {
+        const __m128 velocityX = _mm_load_ps(vx + read);
+        const __m128 newVy     = _mm_add_ps(_mm_load_ps(vy + read), vGravity);
+        const __m128 newX      = _mm_add_ps(_mm_load_ps(x + read), _mm_mul_ps(velocityX, vDt));
+        const __m128 newY      = _mm_add_ps(_mm_load_ps(y + read), _mm_mul_ps(newVy, vDt));
+        const __m128 newLife   = _mm_sub_ps(_mm_load_ps(life + read), vDt);
+        const __m128 newAlpha  = _mm_mul_ps(_mm_max_ps(newLife, vZero), _mm_load_ps(fade + read));
+
+        const int valid = count - read >= 4 ? 0xF : (1 << (count - read)) - 1;
+        const int alive = _mm_movemask_ps(_mm_cmpgt_ps(newLife, vZero)) & valid;
+
+        if (alive == 0xF && write == read) {
+            // Nothing has died yet in this chunk: update in place
+            _mm_store_ps(x + read, newX);
+            _mm_store_ps(y + read, newY);
+            _mm_store_ps(vy + read, newVy);
+            _mm_store_ps(life + read, newLife);
+            _mm_store_ps(alpha + read, newAlpha);
+            write += 4;
+        } else if (alive == 0xF) {
+            _mm_storeu_ps(x + write, newX);
+            _mm_storeu_ps(y + write, newY);
+            _mm_storeu_ps(vx + write, velocityX);
+            _mm_storeu_ps(vy + write, newVy);
+            _mm_storeu_ps(life + write, newLife);
+            _mm_storeu_ps(fade + write, _mm_load_ps(fade + read));
+            _mm_storeu_ps(alpha + write, newAlpha);
+            _mm_storeu_ps(size + write, _mm_load_ps(size + read));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + write),
+                             _mm_load_si128(reinterpret_cast<const __m128i*>(rgba + read)));
+            write += 4;
+        } else if (alive) {
+            alignas(16) float lanes[5][4];
+            _mm_store_ps(lanes[0], newX);
+            _mm_store_ps(lanes[1], newY);
+            _mm_store_ps(lanes[2], newVy);
+            _mm_store_ps(lanes[3], newLife);
+            _mm_store_ps(lanes[4], newAlpha);
+            for (uint32_t lane = 0; lane < 4; ++lane) {
+                if (alive & (1 << lane))
+                    keep(read + lane,
+                         lanes[0][lane],
+                         lanes[1][lane],
+                         lanes[2][lane],
+                         lanes[3][lane],
+                         lanes[4][lane]);
+            }
+        }
+    }
+#else
+    for (uint32_t read = 0; read < count; ++read) {
+        const float newLife = life[read] - dt;
+        if (newLife <= 0.f)
+            continue;
+
+        const float newVy = vy[read] + gravity;
+        keep(read,
+             x[read] + vx[read] * dt,
+             y[read] + newVy * dt,
+             newVy,
+             newLife,
+             newLife * fade[read]);
+    }
+#endif
+
+    return write;
+}
+
+float ParticleSystem::NextRandom() noexcept {
+    // xorshift32
+    m_RandomState ^= m_RandomState << 13;
+    m_RandomState ^= m_RandomState >> 17;
+    m_RandomState ^= m_RandomState << 5;
+    return static_cast<float>(m_RandomState >> 8) / 16777216.f;
+}
@@ -0,0 +1,99 @@
+//
+// Particles.h - Structure-of-arrays particle system with an SSE2 update
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class JobSystem;
+
+/// A spray of particles from one point. Directions are in radians, with y pointing down.
+struct ParticleBurst {
+    float x, y;
+    float direction;
+    float spread;  // either side of direction
+    float minSpeed, maxSpeed;
+    float lifetime;  // seconds
+    float size;
+    uint32_t color;  // 0xAARRGGBB
+    uint32_t count;
+};
+
+/// Read-only view of one chunk's live particles, for rendering.
+struct ParticleChunkView {
+    uint32_t count;
+    const float* x;
+    const float* y;
+    const float* size;
+    const float* alpha;  // remaining life as a fraction of the lifetime
+    const uint32_t* color;
+};
+
+/// Particles live in fixed-size chunks, each a set of parallel arrays with its own live count.
+/// Update integrates, fades and compacts every chunk in place in a single pass, four particles
+/// at a time, and never moves particles between chunks, so chunks can be updated in parallel.
+class ParticleSystem {
+public:
+    static constexpr uint32_t kChunkSize = 4096;
+
+    /// Capacity is rounded up to a whole number of chunks.
+    explicit ParticleSystem(uint32_t capacity, float gravity = 0.f, uint32_t seed = 1);
+
+    ParticleSystem(ParticleSystem const&)            = delete;
+    ParticleSystem& operator=(ParticleSystem const&) = delete;
+
+    /// Particles beyond the capacity are dropped.
+    void Emit(const ParticleBurst& burst);
+
+    /// Advances and fades every particle and removes the expired ones. With a job system, groups
+    /// of chunks are updated in parallel once there is more than one group.
+    void Update(float dt, JobSystem* pJobs = nullptr);
+
+    /// Calls func(const ParticleChunkView&) for every chunk with live particles.
+    template<typename TFunc>
+    void ForEachChunk(const TFunc& func) const {
+        for (uint32_t chunk = 0; chunk < m_ChunkCount; ++chunk) {
+            if (m_pCounts[chunk])
+                func(GetChunk(chunk));
+        }
+    }
+
+    uint32_t GetCount() const noexcept {
+        return m_Count;
+    }
+    uint32_t GetCapacity() const noexcept {
+        return m_ChunkCount * kChunkSize;
+    }
+
+private:
+    struct AlignedDelete {
+        void operator()(float* p) const noexcept;
+    };
+
+    ParticleChunkView GetChunk(uint32_t chunk) const noexcept;
+    void UpdateChunks(uint32_t first, uint32_t last, float dt) noexcept;
+    uint32_t UpdateChunk(uint32_t chunk, float dt) noexcept;
+    float NextRandom() noexcept;
+
+    uint32_t m_ChunkCount;
+    float m_Gravity;
+    uint32_t m_RandomState;
+    uint32_t m_Count     = 0;
+    uint32_t m_EmitChunk = 0;  // first chunk that may have room
+
+    // One allocation holding every array back to back, each chunk 16-byte aligned
+    std::unique_ptr<float[], AlignedDelete> m_pStorage;
+    float* m_pX;
+    float* m_pY;
+    float* m_pVelocityX;
+    float* m_pVelocityY;
+    float* m_pLife;
+    float* m_pFade;  // 1 / lifetime
+    float* m_pAlpha;
+    float* m_pSize;
+    uint32_t* m_pColor;
+    std::unique_ptr<uint32_t[]> m_pCounts;
+};
@@ -0,0 +1,302 @@
+//
+// Png.cpp - PNG decoding to and encoding from 8-bit RGBA
+//
+
+#include "Png.h"
+#include "Deflate.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    constexpr uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+    enum ColorType : uint8_t {
+        kGrey      = 0,
+        kRgb       = 2,
+        kPalette   = 3,
+        kGreyAlpha = 4,
+        kRgba      = 6,
+    };
+
+    uint32_t ReadBE32(const uint8_t* p) noexcept {
+        return uint32_t {p[0]} << 24 | uint32_t {p[1]} << 16 | uint32_t {p[2]} << 8 | p[3];
+    }
+
+    uint32_t GetChannelCount(const uint8_t colorType) {
+        switch (colorType) {
+            case kGrey:
+            case kPalette:
+                return 1;
+            case kGreyAlpha:
+                return 2;
+            case kRgb:
+                return 3;
+            case kRgba:
+                return 4;
+            default:
+                throw std::runtime_error("Unsupported PNG color type");
+        }
+    }
+
+    uint8_t Paeth(const int a, const int b, const int c) noexcept {
+        const int p  = a + b - c;
+        const int pa = std::abs(p - a);
+        const int pb = std::abs(p - b);
+        const int pc = std::abs(p - c);
+        if (pa <= pb && pa <= pc)
+            return static_cast<uint8_t>(a);
+        return static_cast<uint8_t>(pb <= pc ? b : c);
+    }
+
+    constexpr std::array<uint32_t, 256> MakeCrcTable() noexcept {
+        std::array<uint32_t, 256> table {};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        return table;
+    }
+
+    constexpr auto kCrcTable = MakeCrcTable();
+
+    uint32_t Crc32(const uint8_t* p, const size_t size, uint32_t crc = 0xFFFFFFFFu) noexcept {
+        for (size_t i = 0; i < size; ++i)
+            crc = kCrcTable[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+        return crc;
+    }
+
+    void WriteBE32(std::vector<std::byte>& out, const uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back(static_cast<std::byte>(value >> shift));
+    }
+
+    void WriteChunk(std::vector<std::byte>& out,
+                    const char (&type)[5],
+                    const std::span<const uint8_t> data) {
+        WriteBE32(out, static_cast<uint32_t>(data.size()));
+        const size_t start = out.size();
+        for (int i = 0; i < 4; ++i)
+            out.push_back(static_cast<std::byte>(type[i]));
+        for (const uint8_t b : data)
+            out.push_back(static_cast<std::byte>(b));
+        const auto* pCrcStart = reinterpret_cast<const uint8_t*>(out.data() + start);
+        WriteBE32(out, Crc32(pCrcStart, out.size() - start) ^ 0xFFFFFFFFu);
+    }
+
+    // Filters one scanline with every filter type and appends the filter byte and the row whose
+    // residuals, read as signed bytes, have the smallest total magnitude
+    void FilterRow(const uint8_t* row,
+                   const uint8_t* prev,
+                   const size_t stride,
+                   const uint32_t bpp,
+                   std::array<std::vector<uint8_t>, 5>& candidates,
+                   std::vector<uint8_t>& out) {
+        uint32_t bestFilter = 0;
+        uint64_t bestCost   = UINT64_MAX;
+        for (uint32_t filter = 0; filter < 5; ++filter) {
+            std::vector<uint8_t>& residuals = candidates[filter];
+            residuals.resize(stride);
+            uint64_t cost = 0;
+            for (size_t x = 0; x < stride; ++x) {
+                const int a = x >= bpp ? row[x - bpp] : 0;
+                const int b = prev ? prev[x] : 0;
+                const int c = prev && x >= bpp ? prev[x - bpp] : 0;
+                int predicted;
+                switch (filter) {
+                    case 1:
+                        predicted = a;
+                        break;
+                    case 2:
+                        predicted = b;
+                        break;
+                    case 3:
+                        predicted = (a + b) >> 1;
+                        break;
+                    case 4:
+                        predicted = Paeth(a, b, c);
+                        break;
+                    default:
+                        predicted = 0;
+                        break;
+                }
+                const auto residual = static_cast<uint8_t>(row[x] - predicted);
+                residuals[x]        = residual;
+                cost += static_cast<uint64_t>(std::abs(static_cast<int8_t>(residual)));
+            }
+            if (cost < bestCost) {
+                bestCost   = cost;
+                bestFilter = filter;
+            }
+        }
+
+        out.push_back(static_cast<uint8_t>(bestFilter));
+        out.insert(out.end(), candidates[bestFilter].begin(), candidates[bestFilter].end());
+    }
+
+    // Reverses the per-scanline filters in place. `data` holds height rows of (1 + stride) bytes.
+    void Unfilter(uint8_t* data, const uint32_t height, const size_t stride, const uint32_t bpp) {
+        const uint8_t* prev = nullptr;
+        for (uint32_t y = 0; y < height; ++y) {
+            const uint8_t filter = data[0];
+            uint8_t* row         = data + 1;
+
+            for (size_t x = 0; x < stride; ++x) {
+                const int a = x >= bpp ? row[x - bpp] : 0;
+                const int b = prev ? prev[x] : 0;
+                const int c = prev && x >= bpp ? prev[x - bpp] : 0;
+                switch (filter) {
+                    case 0:
+                        break;
+                    case 1:
+                        row[x] = static_cast<uint8_t>(row[x] + a);
+                        break;
+                    case 2:
+                        row[x] = static_cast<uint8_t>(row[x] + b);
+                        break;
+                    case 3:
+                        row[x] = static_cast<uint8_t>(row[x] + ((a + b) >> 1));
+                        break;
+                    case 4:
+                        row[x] = static_cast<uint8_t>(row[x] + Paeth(a, b, c));
+                        break;
+                    default:
+                        throw std::runtime_error("Invalid PNG filter type");
+                }
+            }
+
+            prev = row;
+            data += stride + 1;
+        }
+    }
+}  // namespace
+
+Image DecodePng(const std::span<const std::byte> file) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(file.data());
+    const size_t size = file.size();
+    if (size < sizeof(kSignature) || std::memcmp(bytes, kSignature, sizeof(kSignature)) != 0)
+        throw std::runtime_error("Not a PNG file");
+
+    Image image;
+    uint8_t colorType = 0;
+    std::array<uint8_t, 256 * 4> palette {};
+    for (size_t i = 0; i < 256; ++i)
+        palette[i * 4 + 3] = 0xFF;
+
+    std::vector<uint8_t> compressed;
+    size_t offset = sizeof(kSignature);
+    for (;;) {
+        if (size - offset < 12)
+            throw std::runtime_error("PNG file is truncated");
+
+        const uint32_t length = ReadBE32(bytes + offset);
+        const uint8_t* type   = bytes + offset + 4;
+        const uint8_t* chunk  = bytes + offset + 8;
+        if (length > size - offset - 12)
+            throw std::runtime_error("PNG chunk is truncated");
+
+        if (std::memcmp(type, "IHDR", 4) == 0) {
+            if (length < 13)
+                throw std::runtime_error("PNG header is truncated");
+            image.width  = ReadBE32(chunk);
+            image.height = ReadBE32(chunk + 4);
+            colorType    = chunk[9];
+            if (chunk[8] != 8 || chunk[12] != 0)
+                throw std::runtime_error("Only 8-bit non-interlaced PNGs are supported");
+            GetChannelCount(colorType);
+        } else if (std::memcmp(type, "PLTE", 4) == 0) {
+            for (uint32_t i = 0; i < length / 3 && i < 256; ++i)
+                std::memcpy(&palette[i * 4], chunk + i * 3, 3);
+        } else if (std::memcmp(type, "tRNS", 4) == 0 && colorType == kPalette) {
+            for (uint32_t i = 0; i < length && i < 256; ++i)
+                palette[i * 4 + 3] = chunk[i];
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), chunk, chunk + length);
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+
+        offset += 12 + length;
+    }
+
+    if (image.width == 0 || image.height == 0)
+        throw std::runtime_error("PNG has no image data");
+
+    const uint32_t channels = GetChannelCount(colorType);
+    const size_t stride     = size_t {image.width} * channels;
+
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * image.height);
+    Deflate::InflateZlib(compressed, raw);
+    if (raw.size() < (stride + 1) * image.height)
+        throw std::runtime_error("PNG image data is truncated");
+
+    Unfilter(raw.data(), image.height, stride, channels);
+
+    image.pixels.resize(size_t {image.width} * image.height * 4);
+    uint8_t* dst = image.pixels.data();
+    for (uint32_t y = 0; y < image.height; ++y) {
+        const uint8_t* src = raw.data() + y * (stride + 1) + 1;
+        for (uint32_t x = 0; x < image.width; ++x, dst += 4, src += channels) {
+            switch (colorType) {
+                case kGrey:
+                    dst[0] = dst[1] = dst[2] = src[0];
+                    dst[3]                   = 0xFF;
+                    break;
+                case kGreyAlpha:
+                    dst[0] = dst[1] = dst[2] = src[0];
+                    dst[3]                   = src[1];
+                    break;
+                case kRgb:
+                    std::memcpy(dst, src, 3);
+                    dst[3] = 0xFF;
+                    break;
+                case kPalette:
+                    std::memcpy(dst, &palette[src[0] * 4], 4);
+                    break;
+                default:
+                    std::memcpy(dst, src, 4);
+                    break;
+            }
+        }
+    }
+
+    return image;
+}
+
+std::vector<std::byte> EncodePng(const Image& image, const uint32_t maxChain) {
+    const size_t stride = image.GetRowPitch();
+    std::vector<uint8_t> filtered;
+    filtered.reserve((stride + 1) * image.height);
+    std::array<std::vector<uint8_t>, 5> candidates;
+    for (uint32_t y = 0; y < image.height; ++y) {
+        const uint8_t* row  = image.pixels.data() + y * stride;
+        const uint8_t* prev = y ? row - stride : nullptr;
+        FilterRow(row, prev, stride, 4, candidates, filtered);
+    }
+
+    std::vector<uint8_t> compressed;
+    Deflate::DeflateZlib(filtered, compressed, maxChain);
+
+    std::vector<std::byte> file;
+    file.reserve(compressed.size() + 64);
+    for (const uint8_t b : kSignature)
+        file.push_back(static_cast<std::byte>(b));
+
+    uint8_t header[13] = {};
+    for (int i = 0; i < 4; ++i) {
+        header[i]     = static_cast<uint8_t>(image.width >> (24 - i * 8));
+        header[4 + i] = static_cast<uint8_t>(image.height >> (24 - i * 8));
+    }
+    header[8] = 8;  // bits per channel
+    header[9] = kRgba;
+    WriteChunk(file, "IHDR", header);
+    WriteChunk(file, "IDAT", compressed);
+    WriteChunk(file, "IEND", {});
+    return file;
+}
@@ -0,0 +1,20 @@
+//
+// Png.h - PNG decoding to and encoding from 8-bit RGBA
+//
+
+#pragma once
+
+#include "Image.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/// Decodes a non-interlaced, 8-bit-per-channel PNG (greyscale, RGB, palette, with or without
+/// alpha) into straight-alpha RGBA8. Throws std::runtime_error on malformed or unsupported files.
+Image DecodePng(std::span<const std::byte> file);
+
+/// Encodes straight-alpha RGBA8 as an 8-bit RGBA PNG. Each row takes whichever filter leaves the
+/// smallest residuals; `maxChain` is passed on to Deflate::DeflateZlib.
+std::vector<std::byte> EncodePng(const Image& image, uint32_t maxChain = 16);
@@ -0,0 +1,102 @@
+//
+// RenderList.cpp - A frame's drawing as a list of plain-data commands
+//
+
+#include "RenderList.h"
+#include "Effects.h"
+#include "Palette.h"
+#include "Sim.h"
+
+#include <cstdio>
+
+namespace {
+    // The score's top edge, in court units
+    constexpr float kScoreTop = 24.f;
+}  // namespace
+
+void RenderList::AddClear(const uint32_t color) {
+    RenderCommand command = {};
+    command.type          = RenderCommandType::Clear;
+    command.color         = color;
+    m_Commands.push_back(command);
+}
+
+void RenderList::AddSprite(const RenderMaterial material,
+                           const float x0,
+                           const float y0,
+                           const float x1,
+                           const float y1,
+                           const uint32_t color,
+                           const float fade) {
+    m_Commands.push_back(
+      {RenderCommandType::Sprite, material, color, fade, x0, y0, x1, y1, 0, 0});
+}
+
+void RenderList::AddText(const float x,
+                         const float y,
+                         const std::string_view text,
+                         const uint32_t color) {
+    const auto offset = static_cast<uint32_t>(m_Text.size());
+    m_Text.append(text);
+    m_Commands.push_back({RenderCommandType::Text,
+                          RenderMaterial::Solid,
+                          color,
+                          1.f,
+                          x,
+                          y,
+                          x,
+                          y,
+                          offset,
+                          static_cast<uint32_t>(text.size())});
+}
+
+void RecordCourt(RenderList& list, Sim& sim, const CourtEffects* pEffects) {
+    list.Reset();
+    list.AddClear(kClearColor);
+
+    sim.ForEachSprite([&](const Transform& transform, const Extent& extent, const Sprite& sprite) {
+        const float x0 = transform.x - extent.halfWidth;
+        const float y0 = transform.y - extent.halfHeight;
+        const float x1 = transform.x + extent.halfWidth;
+        const float y1 = transform.y + extent.halfHeight;
+        switch (sprite.id) {
+            case kSpritePaddle:
+                list.AddSprite(RenderMaterial::Paddle, x0, y0, x1, y1);
+                break;
+            case kSpriteBall:
+                list.AddSprite(RenderMaterial::Ball, x0, y0, x1, y1);
+                break;
+            case kSpriteBrick:
+                list.AddSprite(
+                  RenderMaterial::Solid, x0, y0, x1, y1, GetBrickColor(transform.y));
+                break;
+        }
+    });
+
+    if (pEffects) {
+        const auto recordParticles = [&](const ParticleSystem& particles) {
+            particles.ForEachChunk([&](const ParticleChunkView& chunk) {
+                for (uint32_t i = 0; i < chunk.count; ++i) {
+                    const float half = chunk.size[i] * 0.5f;
+                    list.AddSprite(RenderMaterial::Solid,
+                                   chunk.x[i] - half,
+                                   chunk.y[i] - half,
+                                   chunk.x[i] + half,
+                                   chunk.y[i] + half,
+                                   chunk.color[i],
+                                   chunk.alpha[i]);
+                }
+            });
+        };
+        recordParticles(pEffects->GetTrail());
+        recordParticles(pEffects->GetSparks());
+    }
+
+    const Score& score = sim.GetScore();
+    char text[32];
+    const int length = std::snprintf(text, sizeof(text), "%d   %d", score.left, score.right);
+    list.AddText(kCourtWidth * 0.5f,
+                 kScoreTop,
+                 std::string_view(text, static_cast<size_t>(length)),
+                 0xFFFFFFFF);
+}
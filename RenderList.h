@@ -0,0 +1,78 @@
+//
+// RenderList.h - A frame's drawing as a list of plain-data commands
+//
+// RecordCourt turns the sim and its effects into clears, sprites and text in court units, with
+// materials and colors in place of textures and no pointers into the sim, so a recorded list
+// stays valid while the sim moves on. Renderers draw lists rather than the sim: the commands can
+// be reordered, sorted or batched first, and drawn on another thread than the one that recorded
+// them (see TripleBuffer).
+//
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class CourtEffects;
+class Sim;
+
+enum class RenderCommandType : uint8_t { Clear, Sprite, Text };
+
+/// How a sprite is filled: with a sprite texture, falling back to kPlaceholderColor while it
+/// loads, or with the command's color.
+enum class RenderMaterial : uint8_t { Solid, Paddle, Ball };
+
+struct RenderCommand {
+    RenderCommandType type;
+    RenderMaterial material;  // sprites
+    uint32_t color;           // 0xAARRGGBB, straight alpha; clears, solid sprites and text
+    float fade;               // scales the alpha of solid sprites
+    float x0, y0;             // sprite corners in court units; text is centred on x0, below y0
+    float x1, y1;
+    uint32_t textOffset;  // into the list's text
+    uint32_t textLength;
+};
+
+/// Commands in drawing order. Clearing keeps the capacity, so a list recorded every frame stops
+/// allocating once it has held the largest frame.
+class RenderList {
+public:
+    void Reset() noexcept {
+        m_Commands.clear();
+        m_Text.clear();
+    }
+
+    /// Fills the whole target, covering everything drawn before.
+    void AddClear(uint32_t color);
+    void AddSprite(RenderMaterial material,
+                   float x0,
+                   float y0,
+                   float x1,
+                   float y1,
+                   uint32_t color = 0xFFFFFFFF,
+                   float fade     = 1.f);
+    /// UTF-8 text, drawn by renderers that have a font.
+    void AddText(float x, float y, std::string_view text, uint32_t color);
+
+    std::span<const RenderCommand> GetCommands() const noexcept {
+        return m_Commands;
+    }
+    std::span<RenderCommand> GetCommands() noexcept {
+        return m_Commands;
+    }
+
+    std::string_view GetText(const RenderCommand& command) const noexcept {
+        return std::string_view(m_Text).substr(command.textOffset, command.textLength);
+    }
+
+private:
+    std::vector<RenderCommand> m_Commands;
+    std::string m_Text;
+};
+
+/// Records the court as the game draws it into `list`, replacing its contents: the clear, every
+/// sprite, the ball trail and sparks when `pEffects` is given, then the score.
+void RecordCourt(RenderList& list, Sim& sim, const CourtEffects* pEffects);
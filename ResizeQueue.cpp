@@ -0,0 +1,26 @@
+//
+// ResizeQueue.cpp - Window size changes coalesced into at most one surface rebuild per frame
+//
+
+#include "ResizeQueue.h"
+
+void ResizeQueue::Request(const SurfaceSize size) noexcept {
+    ++m_Stats.requests;
+    if (m_Pending)
+        ++m_Stats.coalesced;
+    m_Pending = size;
+}
+
+std::optional<SurfaceSize> ResizeQueue::Take(const SurfaceSize current) noexcept {
+    if (!m_Pending)
+        return std::nullopt;
+
+    const SurfaceSize size = *m_Pending;
+    m_Pending.reset();
+    if (size == current || size.width == 0 || size.height == 0) {
+        ++m_Stats.unchanged;
+        return std::nullopt;
+    }
+    ++m_Stats.rebuilds;
+    return size;
+}
@@ -0,0 +1,54 @@
+//
+// ResizeQueue.h - Window size changes coalesced into at most one surface rebuild per frame
+//
+// Windows sends WM_SIZE many times a frame while a window is dragged or maximized, often with
+// the size it already has, and WM_MOVE on every move. Rebuilding the swap chain buffers and
+// the surfaces drawn into them on each message wastes a ResizeBuffers per message and, done
+// halfway, leaves surfaces released until the next real change. Messages only record the size
+// they ask for here; once per frame, before drawing, the latest request is taken and surfaces
+// are rebuilt only if it differs from the size they have.
+//
+// Nothing here touches the platform, so the policy can be replayed against a mock device (see
+// PongResizeBench).
+//
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+struct SurfaceSize {
+    uint32_t width  = 0;
+    uint32_t height = 0;
+
+    friend bool operator==(const SurfaceSize&, const SurfaceSize&) = default;
+};
+
+struct ResizeStats {
+    uint64_t requests  = 0;
+    uint64_t coalesced = 0;  // requests replaced by a later one before a frame took them
+    uint64_t unchanged = 0;  // requests taken for the size the surfaces already had
+    uint64_t rebuilds  = 0;
+};
+
+class ResizeQueue {
+public:
+    /// Asks for the surfaces to be `size`, replacing any request not taken yet.
+    void Request(SurfaceSize size) noexcept;
+
+    /// Call once per frame before drawing, with the size the surfaces have: returns the size to
+    /// rebuild them at, if one was asked for since the last call and differs from `current`.
+    /// Zero-area requests, made while minimized, leave the surfaces as they are.
+    std::optional<SurfaceSize> Take(SurfaceSize current) noexcept;
+
+    bool HasRequest() const noexcept {
+        return m_Pending.has_value();
+    }
+    const ResizeStats& GetStats() const noexcept {
+        return m_Stats;
+    }
+
+private:
+    std::optional<SurfaceSize> m_Pending;
+    ResizeStats m_Stats;
+};
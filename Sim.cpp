@@ -0,0 +1,526 @@
+//
+// Sim.cpp - Pong rules on top of the ECS: paddles, ball, scoring and the AI opponent
+//
+
+#include "Sim.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    constexpr float kPaddleMargin   = 40.f;
+    constexpr float kPaddleSpeed    = 900.f;  // court units per second at full axis
+    constexpr float kServeSpeed     = 600.f;
+    constexpr float kMaxBallSpeed   = 1500.f;
+    constexpr float kSpeedUp        = 1.05f;  // per paddle hit
+    constexpr float kMaxBounceAngle = 1.f;    // radians, when hitting the paddle's edge
+    constexpr float kMaxServeAngle  = 0.5f;
+
+    // Breakout mode: a wall of kBrickColumns x kBrickRows bricks either side of the centre line,
+    // kBrickWallGap from it
+    constexpr float kBrickWidth      = 8.f;
+    constexpr float kBrickHeight     = 12.f;
+    constexpr uint32_t kBrickColumns = 24;
+    constexpr uint32_t kBrickRows    = static_cast<uint32_t>(kCourtHeight / kBrickHeight);
+    constexpr float kBrickWallGap    = 208.f;
+    constexpr float kBrickCellSize   = 16.f;
+    constexpr uint32_t kBrickTotal   = kBrickColumns * kBrickRows * 2;
+    // A fast ball can break several bricks in one step; past this many it stops for the step
+    constexpr uint32_t kMaxBrickHits = 4;
+
+    // The most events one ball raises in a step: a wall, a paddle, a goal and its brick hits.
+    // Reserved up front, so steps never allocate, however rare the step that reaches it.
+    constexpr uint32_t kMaxStepEvents = 3 + kMaxBrickHits;
+
+    // Snapshot sections. Paddles are stored by Side, and bricks as one bit per grid item, set
+    // while the brick stands.
+    constexpr uint32_t kStateSection   = MakeSnapshotTag("STAT");
+    constexpr uint32_t kAiSection      = MakeSnapshotTag("AISE");
+    constexpr uint32_t kPaddlesSection = MakeSnapshotTag("PADL");
+    constexpr uint32_t kBallSection    = MakeSnapshotTag("BALL");
+    constexpr uint32_t kBricksSection  = MakeSnapshotTag("BRIK");
+
+    struct SnapshotState {
+        int32_t leftScore;
+        int32_t rightScore;
+        uint32_t serveState;
+        uint32_t brickTotal;  // grid items, standing or not; 0 outside breakout
+    };
+
+    struct SnapshotPaddle {
+        float x, y;
+        float axis;
+        uint32_t ai;
+    };
+
+    struct SnapshotBall {
+        float x, y;
+        float velocityX, velocityY;
+        float speed;
+    };
+
+    static_assert(sizeof(AiSettings) == 16, "Bump Sim::kSnapshotSchema when AiSettings changes");
+
+    constexpr uint32_t GetBrickWords(const uint32_t bricks) noexcept {
+        return (bricks + 31) / 32;
+    }
+
+    /// How far along the move (dx, dy) a box of half size `extent` centred at (x, y) first
+    /// touches `box`, from 0 to 1, or a value above 1 if it does not. Boxes it already overlaps
+    /// or only grazes are ignored. `alongX` is set when it hits a left or right face.
+    float Sweep(const float x,
+                const float y,
+                const float dx,
+                const float dy,
+                const GridBox& box,
+                const Extent& extent,
+                bool& alongX) {
+        // Slab test of the centre's path against the box grown by the half size
+        float tEnter    = -1.f;
+        float tExit     = 2.f;
+        const auto slab = [&](const float start,
+                              const float delta,
+                              const float lo,
+                              const float hi,
+                              const bool isX) {
+            if (delta == 0.f)
+                return start > lo && start < hi;
+            const float t0 = ((delta > 0.f ? lo : hi) - start) / delta;
+            const float t1 = ((delta > 0.f ? hi : lo) - start) / delta;
+            if (t0 > tEnter) {
+                tEnter = t0;
+                alongX = isX;
+            }
+            tExit = std::min(tExit, t1);
+            return true;
+        };
+        if (!slab(x, dx, box.minX - extent.halfWidth, box.maxX + extent.halfWidth, true) ||
+            !slab(y, dy, box.minY - extent.halfHeight, box.maxY + extent.halfHeight, false))
+            return 2.f;
+
+        return tEnter >= 0.f && tEnter < tExit ? tEnter : 2.f;
+    }
+}  // namespace
+
+Sim::Sim(JobSystem* pJobs, const SimOptions& options)
+    : m_Controllers(m_World),
+      m_Paddles(m_World),
+      m_BallsToTrack(m_World),
+      m_MovingBalls(m_World),
+      m_Balls(m_World),
+      m_PaddleBounds(m_World),
+      m_Sprites(m_World),
+      m_Scheduler(m_World, pJobs),
+      m_ServeState(options.seed),
+      m_AiSettings {options.leftAiSettings, options.rightAiSettings},
+      m_BrickGrid(0.f,
+                  0.f,
+                  kBrickCellSize,
+                  static_cast<uint32_t>(std::ceil(kCourtWidth / kBrickCellSize)),
+                  static_cast<uint32_t>(std::ceil(kCourtHeight / kBrickCellSize))) {
+    Spawn(options);
+    m_Events.reserve(kMaxStepEvents);
+    m_BrokenBricks.reserve(kMaxBrickHits);
+
+    // Paddles and balls are separate archetypes, so MovePaddles and MoveBalls share a stage.
+    m_Scheduler.Add("ControlPaddles",
+                    SystemAccess().Uses(m_Controllers).Uses(m_BallsToTrack),
+                    [this] { ControlPaddles(); });
+    m_Scheduler.Add("MovePaddles", SystemAccess().Uses(m_Paddles), [this] { MovePaddles(); });
+    m_Scheduler.Add("MoveBalls", SystemAccess().Uses(m_MovingBalls), [this] { MoveBalls(); });
+    m_Scheduler.Add("CollideBalls",
+                    SystemAccess()
+                      .Uses(m_Balls)
+                      .Uses(m_PaddleBounds)
+                      .Writes<Score>()
+                      .Writes<SimEvent>()
+                      .Writes<Brick>(),
+                    [this] { CollideBalls(); });
+}
+
+void Sim::Reset(const SimOptions& options) {
+    m_World.Clear();
+    m_Score      = {};
+    m_ServeState = options.seed;
+    m_AiSettings = {options.leftAiSettings, options.rightAiSettings};
+    m_Events.clear();
+    Spawn(options);
+}
+
+void Sim::Spawn(const SimOptions& options) {
+    const Extent paddleExtent = {kPaddleWidth * 0.5f, kPaddleHeight * 0.5f};
+    const float paddleX       = kPaddleMargin + paddleExtent.halfWidth;
+    m_World.Create(Transform {paddleX, kCourtHeight * 0.5f},
+                   paddleExtent,
+                   Paddle {Side::Left, options.leftAi, 0.f},
+                   Sprite {kSpritePaddle});
+    m_World.Create(Transform {kCourtWidth - paddleX, kCourtHeight * 0.5f},
+                   paddleExtent,
+                   Paddle {Side::Right, options.rightAi, 0.f},
+                   Sprite {kSpritePaddle});
+
+    Transform ballTransform;
+    Velocity ballVelocity;
+    Ball ball;
+    Serve(ballTransform, ballVelocity, ball, Side::Right);
+    m_World.Create(ballTransform,
+                   ballVelocity,
+                   ball,
+                   Extent {kBallSize * 0.5f, kBallSize * 0.5f},
+                   Sprite {kSpriteBall});
+
+    m_BrickEntities.clear();
+    m_BrickBoxes.clear();
+    if (options.breakout)
+        BuildBricks();
+    m_BrickGrid.Build(m_BrickBoxes, kBallSize * 0.5f);
+    m_BrickCount = static_cast<uint32_t>(m_BrickBoxes.size());
+
+    m_StandingBricks.assign(GetBrickWords(m_BrickCount), 0u);
+    for (uint32_t item = 0; item < m_BrickCount; ++item)
+        m_StandingBricks[item / 32] |= 1u << item % 32;
+}
+
+void Sim::BuildBricks() {
+    const float wallWidth = kBrickWidth * static_cast<float>(kBrickColumns);
+    for (const float wallX : {kCourtWidth * 0.5f - kBrickWallGap - wallWidth,
+                              kCourtWidth * 0.5f + kBrickWallGap}) {
+        for (uint32_t row = 0; row < kBrickRows; ++row) {
+            for (uint32_t column = 0; column < kBrickColumns; ++column) {
+                const float minX = wallX + kBrickWidth * static_cast<float>(column);
+                const float minY = kBrickHeight * static_cast<float>(row);
+                const auto item  = static_cast<uint32_t>(m_BrickBoxes.size());
+                m_BrickBoxes.push_back({minX, minY, minX + kBrickWidth, minY + kBrickHeight});
+                m_BrickEntities.push_back(CreateBrick(item));
+            }
+        }
+    }
+}
+
+Entity Sim::CreateBrick(const uint32_t item) {
+    const Extent extent = {kBrickWidth * 0.5f, kBrickHeight * 0.5f};
+    const GridBox& box  = m_BrickBoxes[item];
+    return m_World.Create(Transform {box.minX + extent.halfWidth, box.minY + extent.halfHeight},
+                          extent,
+                          Brick {item},
+                          Sprite {kSpriteBrick});
+}
+
+void Sim::Step(const SimInput& input, const float dt) {
+    m_Input = input;
+    m_Dt    = std::min(dt, kMaxStep);
+    m_Events.clear();
+    m_Scheduler.Run();
+
+    for (const Entity brick : m_BrokenBricks)
+        m_World.Destroy(brick);
+    m_BrokenBricks.clear();
+}
+
+void Sim::ControlPaddles() {
+    m_Controllers.ForEach([&](Paddle& paddle, const Transform& transform) {
+        if (!paddle.ai) {
+            const float axis = paddle.side == Side::Left ? m_Input.leftAxis : m_Input.rightAxis;
+            paddle.axis      = std::clamp(axis, -1.f, 1.f);
+            return;
+        }
+
+        // Follow the nearest ball heading this way, otherwise drift back to the middle
+        const AiSettings& ai = m_AiSettings[static_cast<size_t>(paddle.side)];
+        const float towards  = paddle.side == Side::Left ? -1.f : 1.f;
+        float targetY        = kCourtHeight * 0.5f;
+        float nearest        = ai.reach;
+        m_BallsToTrack.ForEach([&](const Transform& ball, const Velocity& velocity, const Ball&) {
+            const float distance = std::abs(ball.x - transform.x);
+            if (velocity.x * towards > 0.f && distance < nearest) {
+                // The aim point is derived from the ball's velocity, so it changes with every
+                // bounce yet stays deterministic
+                const uint32_t hash = std::bit_cast<uint32_t>(velocity.y) * 2654435761u;
+                const float unit    = static_cast<float>(hash >> 8) / 16777216.f;
+                const float aim     = (unit * 2.f - 1.f) * ai.aimSpread * kPaddleHeight * 0.5f;
+                nearest             = distance;
+                targetY             = ball.y - aim;
+            }
+        });
+
+        const float error = (targetY - transform.y) / ai.deadZone;
+        paddle.axis       = std::clamp(error, -1.f, 1.f) * ai.maxAxis;
+    });
+}
+
+void Sim::MovePaddles() {
+    m_Paddles.ForEach([&](Transform& transform, const Extent& extent, const Paddle& paddle) {
+        transform.y += paddle.axis * kPaddleSpeed * m_Dt;
+        transform.y = std::clamp(transform.y, extent.halfHeight, kCourtHeight - extent.halfHeight);
+    });
+}
+
+void Sim::MoveBalls() {
+    m_MovingBalls.ForEachChunk(
+      [&](const uint32_t count, Transform* transforms, const Velocity* velocities, const Ball*) {
+          for (uint32_t i = 0; i < count; ++i) {
+              transforms[i].x += velocities[i].x * m_Dt;
+              transforms[i].y += velocities[i].y * m_Dt;
+          }
+      });
+}
+
+void Sim::CollideBalls() {
+    const auto collide = [&](Transform& transform,
+                             Velocity& velocity,
+                             Ball& ball,
+                             const Extent& extent) {
+        if (m_BrickCount)
+            CollideBricks(transform, velocity, extent);
+
+        if (transform.y - extent.halfHeight < 0.f) {
+            transform.y = extent.halfHeight;
+            velocity.y  = std::abs(velocity.y);
+            m_Events.push_back({SimEventType::WallHit, Side::Left, transform.x, 0.f});
+        } else if (transform.y + extent.halfHeight > kCourtHeight) {
+            transform.y = kCourtHeight - extent.halfHeight;
+            velocity.y  = -std::abs(velocity.y);
+            m_Events.push_back({SimEventType::WallHit, Side::Left, transform.x, kCourtHeight});
+        }
+
+        m_PaddleBounds.ForEach([&](const Transform& paddleTransform,
+                                   const Extent& paddleExtent,
+                                   const Paddle& paddle) {
+            // Only bounce balls moving into the paddle's face
+            const float away = paddle.side == Side::Left ? 1.f : -1.f;
+            if (velocity.x * away >= 0.f)
+                return;
+
+            const float reachX = extent.halfWidth + paddleExtent.halfWidth;
+            const float reachY = extent.halfHeight + paddleExtent.halfHeight;
+            const float dy     = transform.y - paddleTransform.y;
+            if (std::abs(transform.x - paddleTransform.x) >= reachX || std::abs(dy) >= reachY)
+                return;
+            if (!ShapesTouch(
+                  kSpriteBall, transform, extent, kSpritePaddle, paddleTransform, paddleExtent))
+                return;
+
+            // The further from the paddle's centre, the steeper the return
+            const float angle = std::clamp(dy / reachY, -1.f, 1.f) * kMaxBounceAngle;
+            ball.speed        = std::min(ball.speed * kSpeedUp, kMaxBallSpeed);
+            transform.x       = paddleTransform.x + away * reachX;
+            velocity.x        = away * ball.speed * std::cos(angle);
+            velocity.y        = ball.speed * std::sin(angle);
+
+            const float faceX = paddleTransform.x + away * paddleExtent.halfWidth;
+            m_Events.push_back({SimEventType::PaddleHit, paddle.side, faceX, transform.y});
+        });
+
+        // The player who conceded receives the next serve
+        if (transform.x + extent.halfWidth < 0.f) {
+            m_Score.right++;
+            m_Events.push_back({SimEventType::Goal, Side::Left, 0.f, transform.y});
+            Serve(transform, velocity, ball, Side::Left);
+        } else if (transform.x - extent.halfWidth > kCourtWidth) {
+            m_Score.left++;
+            m_Events.push_back({SimEventType::Goal, Side::Right, kCourtWidth, transform.y});
+            Serve(transform, velocity, ball, Side::Right);
+        }
+    };
+
+    m_Balls.ForEach(collide);
+}
+
+bool Sim::ShapesTouch(const SpriteId spriteA,
+                      const Transform& transformA,
+                      const Extent& extentA,
+                      const SpriteId spriteB,
+                      const Transform& transformB,
+                      const Extent& extentB) const noexcept {
+    const CollisionMask* pMaskA = m_CollisionMasks[spriteA].get();
+    const CollisionMask* pMaskB = m_CollisionMasks[spriteB].get();
+    if (!pMaskA || !pMaskB)
+        return true;
+
+    const auto corner = [](const float centre, const float half) {
+        return static_cast<int32_t>(std::lround(centre - half));
+    };
+    return CollisionMask::Overlaps(*pMaskA,
+                                   corner(transformA.x, extentA.halfWidth),
+                                   corner(transformA.y, extentA.halfHeight),
+                                   *pMaskB,
+                                   corner(transformB.x, extentB.halfWidth),
+                                   corner(transformB.y, extentB.halfHeight));
+}
+
+void Sim::CollideBricks(Transform& transform, Velocity& velocity, const Extent& extent) {
+    // MoveBalls has already advanced the ball, so this step's path ends where it is now
+    float fromX = transform.x - velocity.x * m_Dt;
+    float fromY = transform.y - velocity.y * m_Dt;
+
+    for (uint32_t hits = 0; hits < kMaxBrickHits; ++hits) {
+        const float dx = transform.x - fromX;
+        const float dy = transform.y - fromY;
+
+        // Find the first brick the ball's box touches
+        float firstT     = 1.f;
+        uint32_t first   = UINT32_MAX;
+        bool firstAlongX = false;
+        m_BrickGrid.Traverse(
+          fromX,
+          fromY,
+          transform.x,
+          transform.y,
+          [&](const std::span<const uint32_t> items, float, const float tExit) {
+              for (const uint32_t item : items) {
+                  bool alongX   = false;
+                  const float t = Sweep(fromX, fromY, dx, dy, m_BrickBoxes[item], extent, alongX);
+                  // Ties go to the lower item, so the order of a cell's items never matters
+                  if (t < firstT || (t == firstT && item < first)) {
+                      firstT      = t;
+                      first       = item;
+                      firstAlongX = alongX;
+                  }
+              }
+              // Later cells are entered after this one is left, so cannot hold an earlier hit
+              return first == UINT32_MAX || firstT > tExit;
+          });
+        if (first == UINT32_MAX)
+            return;
+
+        // Stop at the contact point, then spend the rest of the step moving away from the brick
+        const GridBox& box = m_BrickBoxes[first];
+        const float hitX   = fromX + dx * firstT;
+        const float hitY   = fromY + dy * firstT;
+        float restX        = dx * (1.f - firstT);
+        float restY        = dy * (1.f - firstT);
+        if (firstAlongX) {
+            velocity.x = -velocity.x;
+            restX      = -restX;
+        } else {
+            velocity.y = -velocity.y;
+            restY      = -restY;
+        }
+        fromX       = hitX;
+        fromY       = hitY;
+        transform.x = hitX + restX;
+        transform.y = hitY + restY;
+
+        m_BrickGrid.Remove(first);
+        m_BrokenBricks.push_back(m_BrickEntities[first]);
+        m_StandingBricks[first / 32] &= ~(1u << first % 32);
+        m_BrickCount--;
+
+        const float brickX = (box.minX + box.maxX) * 0.5f;
+        const float brickY = (box.minY + box.maxY) * 0.5f;
+        const Side wall    = brickX < kCourtWidth * 0.5f ? Side::Left : Side::Right;
+        m_Events.push_back({SimEventType::BrickBroken, wall, brickX, brickY});
+    }
+}
+
+void Sim::Serve(Transform& transform, Velocity& velocity, Ball& ball, const Side towards) {
+    m_ServeState      = m_ServeState * 1664525u + 1013904223u;
+    const float unit  = static_cast<float>(m_ServeState >> 8) / 16777216.f;
+    const float angle = (unit * 2.f - 1.f) * kMaxServeAngle;
+    const float dir   = towards == Side::Left ? -1.f : 1.f;
+
+    transform  = {kCourtWidth * 0.5f, kCourtHeight * 0.5f};
+    ball.speed = kServeSpeed;
+    velocity   = {dir * kServeSpeed * std::cos(angle), kServeSpeed * std::sin(angle)};
+}
+
+void Sim::SaveSnapshot(std::vector<std::byte>& snapshot) {
+    const SnapshotState state = {
+      m_Score.left, m_Score.right, m_ServeState, static_cast<uint32_t>(m_BrickBoxes.size())};
+
+    std::array<SnapshotPaddle, 2> paddles = {};
+    m_PaddleBounds.ForEach([&](const Transform& transform, const Extent&, const Paddle& paddle) {
+        paddles[static_cast<size_t>(paddle.side)] = {
+          transform.x, transform.y, paddle.axis, paddle.ai};
+    });
+
+    SnapshotBall ball = {};
+    m_BallsToTrack.ForEach(
+      [&](const Transform& transform, const Velocity& velocity, const Ball& saved) {
+          ball = {transform.x, transform.y, velocity.x, velocity.y, saved.speed};
+      });
+
+    SnapshotWriter writer(snapshot, kSnapshotSchema);
+    writer.Write(kStateSection, state);
+    writer.Write(kAiSection, std::span<const AiSettings>(m_AiSettings));
+    writer.Write(kPaddlesSection, std::span<const SnapshotPaddle>(paddles));
+    writer.Write(kBallSection, ball);
+    writer.Write(kBricksSection, std::span<const uint32_t>(m_StandingBricks));
+    writer.Finish();
+}
+
+void Sim::RestoreSnapshot(const std::span<const std::byte> snapshot) {
+    // Read and check everything before changing anything
+    const SnapshotReader reader(snapshot, kSnapshotSchema);
+    SnapshotState state;
+    std::array<AiSettings, 2> aiSettings;
+    std::array<SnapshotPaddle, 2> paddles;
+    SnapshotBall ball;
+    reader.Read(kStateSection, state);
+    reader.Read(kAiSection, std::span<AiSettings>(aiSettings));
+    reader.Read(kPaddlesSection, std::span<SnapshotPaddle>(paddles));
+    reader.Read(kBallSection, ball);
+    if (state.brickTotal != 0 && state.brickTotal != kBrickTotal)
+        throw std::runtime_error("Snapshot has an unknown brick layout");
+
+    m_RestoreBricks.resize(GetBrickWords(state.brickTotal));
+    reader.Read(kBricksSection, std::span<uint32_t>(m_RestoreBricks));
+    if (state.brickTotal % 32 && m_RestoreBricks.back() >> state.brickTotal % 32)
+        throw std::runtime_error("Snapshot has bricks past the end of its layout");
+
+    if (state.brickTotal != m_BrickBoxes.size()) {
+        // Saved in the other mode, so start from a fresh court of that kind
+        m_World.Clear();
+        SimOptions options;
+        options.rightAi  = false;
+        options.seed     = state.serveState;
+        options.breakout = state.brickTotal != 0;
+        Spawn(options);
+    }
+
+    // Break or rebuild only the bricks whose state differs
+    for (size_t word = 0; word < m_RestoreBricks.size(); ++word) {
+        const uint32_t standing = m_RestoreBricks[word];
+        uint32_t changed        = standing ^ m_StandingBricks[word];
+        for (; changed; changed &= changed - 1) {
+            const auto bit = static_cast<uint32_t>(std::countr_zero(changed));
+            RestoreBrick(static_cast<uint32_t>(word) * 32 + bit, (standing >> bit & 1) != 0);
+        }
+        m_StandingBricks[word] = standing;
+    }
+
+    m_Paddles.ForEach([&](Transform& transform, const Extent&, const Paddle& paddle) {
+        const SnapshotPaddle& saved = paddles[static_cast<size_t>(paddle.side)];
+        transform                   = {saved.x, saved.y};
+    });
+    m_Controllers.ForEach([&](Paddle& paddle, const Transform&) {
+        const SnapshotPaddle& saved = paddles[static_cast<size_t>(paddle.side)];
+        paddle.ai                   = saved.ai != 0;
+        paddle.axis                 = saved.axis;
+    });
+    m_Balls.ForEach([&](Transform& transform, Velocity& velocity, Ball& live, const Extent&) {
+        transform  = {ball.x, ball.y};
+        velocity   = {ball.velocityX, ball.velocityY};
+        live.speed = ball.speed;
+    });
+
+    m_Score      = {state.leftScore, state.rightScore};
+    m_ServeState = state.serveState;
+    m_AiSettings = aiSettings;
+    m_Events.clear();
+}
+
+void Sim::RestoreBrick(const uint32_t item, const bool standing) {
+    if (standing) {
+        m_BrickGrid.Reinsert(item);
+        m_BrickEntities[item] = CreateBrick(item);
+        m_BrickCount++;
+    } else {
+        m_BrickGrid.Remove(item);
+        m_World.Destroy(m_BrickEntities[item]);
+        m_BrickCount--;
+    }
+}
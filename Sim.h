@@ -0,0 +1,234 @@
+//
+// Sim.h - Pong rules on top of the ECS: paddles, ball, scoring and the AI opponent
+//
+// In breakout mode two walls of destructible bricks stand between the paddles. Bricks are
+// bucketed in a UniformGrid, and the ball's path over each step is swept through it, so a step
+// only tests the bricks in the cells the ball crosses.
+//
+// The simulation works in court units (kCourtWidth x kCourtHeight, y down) and knows nothing
+// about rendering; the renderer scales the court to the viewport and draws every Sprite.
+//
+
+#pragma once
+
+#include "CollisionMask.h"
+#include "Ecs.h"
+#include "UniformGrid.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+inline constexpr float kCourtWidth  = 1280.f;
+inline constexpr float kCourtHeight = 720.f;
+
+// Sprite sizes, also the resolution of their collision masks
+inline constexpr float kPaddleWidth  = 32.f;
+inline constexpr float kPaddleHeight = 200.f;
+inline constexpr float kBallSize     = 32.f;
+
+// Components. Positions are entity centres.
+struct Transform {
+    float x, y;
+};
+
+struct Velocity {
+    float x, y;
+};
+
+struct Extent {
+    float halfWidth, halfHeight;
+};
+
+enum class Side : uint8_t { Left, Right };
+
+struct Paddle {
+    Side side;
+    bool ai;
+    float axis;  // -1 (up) to 1 (down), set each step from input or the AI
+};
+
+struct Ball {
+    float speed;
+};
+
+struct Brick {
+    uint32_t item;  // id in the Sim's brick grid
+};
+
+enum SpriteId : uint32_t {
+    kSpritePaddle,
+    kSpriteBall,
+    kSpriteBrick,
+};
+
+inline constexpr uint32_t kSpriteIdCount = kSpriteBrick + 1;
+
+struct Sprite {
+    SpriteId id;
+};
+
+// Resources
+struct Score {
+    int left  = 0;
+    int right = 0;
+};
+
+// Something the renderer or audio may want to react to, in court units
+enum class SimEventType : uint8_t { PaddleHit, WallHit, Goal, BrickBroken };
+
+struct SimEvent {
+    SimEventType type;
+    Side side;  // the paddle hit, the side whose goal was scored on, or the brick's wall
+    float x, y;
+};
+
+/// Per-step control for paddles that are not AI driven.
+struct SimInput {
+    float leftAxis  = 0.f;
+    float rightAxis = 0.f;
+
+    friend bool operator==(const SimInput&, const SimInput&) = default;
+};
+
+/// How an AI paddle plays. The defaults are the game's opponent.
+struct AiSettings {
+    float maxAxis   = 0.8f;                 // top speed, as a fraction of a player's
+    float deadZone  = 24.f;                 // eases off within this distance of its target
+    float reach     = kCourtWidth * 0.55f;  // only reacts once the ball is this close
+    float aimSpread = 0.8f;                 // largest aim offset, as a fraction of half its height
+
+    friend bool operator==(const AiSettings&, const AiSettings&) = default;
+};
+
+struct SimOptions {
+    bool leftAi   = false;
+    bool rightAi  = true;
+    uint32_t seed = 1;  // serve angles; the simulation is otherwise deterministic
+    bool breakout = false;
+    AiSettings leftAiSettings;
+    AiSettings rightAiSettings;
+};
+
+class Sim {
+public:
+    /// Systems run in parallel stages on `pJobs` when given, otherwise on the calling thread.
+    explicit Sim(JobSystem* pJobs, const SimOptions& options = {});
+
+    Sim(Sim const&)            = delete;
+    Sim& operator=(Sim const&) = delete;
+
+    /// Starts a new match, keeping the systems and their schedule.
+    void Reset(const SimOptions& options);
+
+    /// Writes the match (entities, score, serve sequence and AI settings) to `snapshot`,
+    /// replacing its contents; once the buffer has held a snapshot this does not allocate. Not
+    /// during Step.
+    void SaveSnapshot(std::vector<std::byte>& snapshot);
+
+    /// Returns the match to where a snapshot was saved. Entities are updated in place and only
+    /// the bricks that differ are broken or rebuilt, unless the snapshot is of the other mode.
+    /// Collision masks and the schedule are kept. Throws std::runtime_error, leaving the match
+    /// as it was, if the snapshot is invalid or from another schema. Not during Step.
+    void RestoreSnapshot(std::span<const std::byte> snapshot);
+
+    /// Gives a sprite a pixel-accurate shape, one bit per court unit over its extent. The ball
+    /// bounces off a paddle once their boxes overlap only if both have masks and their solid
+    /// pixels touch; without masks it bounces as soon as the boxes overlap. Not during Step.
+    void SetCollisionMask(const SpriteId sprite, std::shared_ptr<const CollisionMask> pMask) {
+        m_CollisionMasks[sprite] = std::move(pMask);
+    }
+
+    /// Advances the simulation; steps longer than kMaxStep are clamped so the ball cannot pass
+    /// through a paddle.
+    void Step(const SimInput& input, float dt);
+
+    const Score& GetScore() const noexcept {
+        return m_Score;
+    }
+    uint32_t GetBrickCount() const noexcept {
+        return m_BrickCount;
+    }
+    bool IsBreakout() const noexcept {
+        return !m_BrickBoxes.empty();
+    }
+
+    /// Events raised during the last Step, in the order they happened.
+    const std::vector<SimEvent>& GetEvents() const noexcept {
+        return m_Events;
+    }
+
+    World& GetWorld() noexcept {
+        return m_World;
+    }
+    const Scheduler& GetScheduler() const noexcept {
+        return m_Scheduler;
+    }
+
+    /// Calls func(const Transform&, const Extent&, const Sprite&) for everything to draw.
+    template<typename TFunc>
+    void ForEachSprite(const TFunc& func) {
+        m_Sprites.ForEach(func);
+    }
+
+    static constexpr float kMaxStep = 1.f / 30.f;
+
+    /// Layout version of SaveSnapshot's sections; bump it whenever one of them changes.
+    static constexpr uint32_t kSnapshotSchema = 1;
+
+private:
+    void Spawn(const SimOptions& options);
+    void BuildBricks();
+    Entity CreateBrick(uint32_t item);
+    void ControlPaddles();
+    void MovePaddles();
+    void MoveBalls();
+    void CollideBalls();
+    bool ShapesTouch(SpriteId spriteA,
+                     const Transform& transformA,
+                     const Extent& extentA,
+                     SpriteId spriteB,
+                     const Transform& transformB,
+                     const Extent& extentB) const noexcept;
+    void CollideBricks(Transform& transform, Velocity& velocity, const Extent& extent);
+    void RestoreBrick(uint32_t item, bool standing);
+    void Serve(Transform& transform, Velocity& velocity, Ball& ball, Side towards);
+
+    World m_World;
+
+    Query<Paddle, const Transform> m_Controllers;
+    Query<Transform, const Extent, const Paddle> m_Paddles;
+    Query<const Transform, const Velocity, const Ball> m_BallsToTrack;
+    Query<Transform, const Velocity, const Ball> m_MovingBalls;
+    Query<Transform, Velocity, Ball, const Extent> m_Balls;
+    Query<const Transform, const Extent, const Paddle> m_PaddleBounds;
+    Query<const Transform, const Extent, const Sprite> m_Sprites;
+
+    Scheduler m_Scheduler;
+
+    // Set by Step before the systems run, and read-only while they do
+    SimInput m_Input;
+    float m_Dt = 0.f;
+
+    // Written by CollideBalls, which declares Score and SimEvent as resources it writes
+    Score m_Score;
+    std::vector<SimEvent> m_Events;
+    uint32_t m_ServeState;
+    std::array<AiSettings, 2> m_AiSettings;  // by Side
+
+    // Also written by CollideBalls, under the Brick resource. Broken bricks leave the grid
+    // straight away but their entities are destroyed after the systems finish.
+    UniformGrid m_BrickGrid;
+    std::vector<Entity> m_BrickEntities;  // by grid item
+    std::vector<GridBox> m_BrickBoxes;    // by grid item
+    std::vector<Entity> m_BrokenBricks;
+    std::vector<uint32_t> m_StandingBricks;  // one bit per grid item, for snapshots
+    std::vector<uint32_t> m_RestoreBricks;   // RestoreSnapshot's copy of the snapshot's bits
+    uint32_t m_BrickCount = 0;
+
+    std::array<std::shared_ptr<const CollisionMask>, kSpriteIdCount> m_CollisionMasks;
+};
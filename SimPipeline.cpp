@@ -0,0 +1,128 @@
+//
+// SimPipeline.cpp - Runs sim updates serially or on a thread of their own, handing frames over
+//
+
+#include "SimPipeline.h"
+
+#include <algorithm>
+
+SimPipeline::SimPipeline(const std::chrono::nanoseconds period, UpdateFunc update)
+    : m_Period(period), m_Update(std::move(update)) {}
+
+SimPipeline::~SimPipeline() {
+    Stop();
+}
+
+void SimPipeline::Start() {
+    if (IsThreaded())
+        return;
+    m_Stopping.store(false, std::memory_order_relaxed);
+    m_Thread = std::thread([this] { ThreadMain(); });
+}
+
+void SimPipeline::Stop() noexcept {
+    if (!IsThreaded())
+        return;
+    m_Stopping.store(true, std::memory_order_relaxed);
+    m_Thread.join();
+}
+
+void SimPipeline::Update(const float seconds) {
+    RunUpdate(seconds);
+}
+
+void SimPipeline::ThreadMain() {
+    using Clock = std::chrono::steady_clock;
+
+    auto last = Clock::now();
+    auto next = last;
+    while (!m_Stopping.load(std::memory_order_relaxed)) {
+        next += m_Period;
+        std::this_thread::sleep_until(next);
+        const auto now = Clock::now();
+        if (now - next > m_Period)
+            next = now;
+
+        try {
+            RunUpdate(std::chrono::duration<float>(now - last).count());
+        } catch (...) {
+            m_pError = std::current_exception();
+            m_Failed.store(true, std::memory_order_release);
+            return;
+        }
+        last = now;
+    }
+}
+
+void SimPipeline::RunUpdate(const float seconds) {
+    std::lock_guard lock(m_UpdateMutex);
+    const int64_t start = GetInputTime();
+    m_UpdateStart.store(start, std::memory_order_relaxed);
+
+    SimFrame& frame = m_Frames.GetWriteSlot();
+    try {
+        m_Update(frame, seconds);
+    } catch (...) {
+        m_UpdateStart.store(0, std::memory_order_relaxed);
+        throw;
+    }
+
+    const int64_t end = GetInputTime();
+    frame.sequence    = m_Published.load(std::memory_order_relaxed);
+    frame.publishTime = end;
+    if (m_Frames.Publish())
+        m_Dropped.fetch_add(1, std::memory_order_relaxed);
+    m_Published.fetch_add(1, std::memory_order_relaxed);
+
+    m_UpdateStart.store(0, std::memory_order_relaxed);
+    m_UpdateTime.fetch_add(end - start, std::memory_order_relaxed);
+}
+
+const SimFrame& SimPipeline::AcquireFrame() {
+    if (m_Failed.load(std::memory_order_acquire))
+        std::rethrow_exception(m_pError);
+
+    if (m_Frames.Acquire()) {
+        const SimFrame& frame = m_Frames.GetReadSlot();
+        const auto queued     = static_cast<float>(GetInputTime() - frame.publishTime) * 1e-6f;
+        m_QueueLatency[m_Taken % kQueueHistory] = queued;
+        ++m_Taken;
+    }
+    return m_Frames.GetReadSlot();
+}
+
+void SimPipeline::BeginRender() noexcept {
+    m_RenderStart       = GetInputTime();
+    m_UpdateTimeAtStart = GetUpdateTime(m_RenderStart);
+}
+
+void SimPipeline::EndRender() noexcept {
+    const int64_t end      = GetInputTime();
+    const int64_t duration = end - m_RenderStart;
+    m_RenderTime += duration;
+    // The two counters are read without a lock, so a sample can be off by part of an update
+    m_OverlapTime += std::clamp(GetUpdateTime(end) - m_UpdateTimeAtStart, int64_t {0}, duration);
+}
+
+SimPipelineStats SimPipeline::GetStats() const {
+    SimPipelineStats stats;
+    stats.published = m_Published.load(std::memory_order_relaxed);
+    stats.taken     = m_Taken;
+    stats.dropped   = m_Dropped.load(std::memory_order_relaxed);
+    if (m_RenderTime > 0)
+        stats.overlap = static_cast<double>(m_OverlapTime) / static_cast<double>(m_RenderTime);
+
+    const auto count = static_cast<uint32_t>(std::min<uint64_t>(m_Taken, kQueueHistory));
+    if (count) {
+        std::array<float, kQueueHistory> sorted = m_QueueLatency;
+        std::sort(sorted.begin(), sorted.begin() + count);
+        stats.queueP50 = sorted[count / 2];
+        stats.queueP99 = sorted[count * 99 / 100];
+    }
+    return stats;
+}
+
+int64_t SimPipeline::GetUpdateTime(const int64_t now) const noexcept {
+    const int64_t start = m_UpdateStart.load(std::memory_order_relaxed);
+    return m_UpdateTime.load(std::memory_order_relaxed) + (start ? now - start : 0);
+}
@@ -0,0 +1,120 @@
+//
+// SimPipeline.h - Runs sim updates serially or on a thread of their own, handing frames over
+//
+// Every update advances the sim and records a SimFrame: the render list and whatever else the
+// renderer shows, copied out of the sim so the frame never changes once published. Frames pass
+// through a TripleBuffer, so neither side waits for the other: the renderer draws the newest
+// frame, and frames it never took are dropped.
+//
+// Serially, the render thread runs one update per frame before drawing, as the game always has.
+// Threaded, updates run every `period` on the pipeline's thread, so a slow present no longer
+// holds up the sim, nor a long update the frame.
+//
+
+#pragma once
+
+#include "Input.h"
+#include "RenderList.h"
+#include "TripleBuffer.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct SimFrame {
+    RenderList list;
+    std::string status;       // a line of UTF-8 about the sim, for the HUD
+    uint64_t sequence   = 0;  // frames published before this one
+    int64_t publishTime = 0;  // GetInputTime() nanoseconds
+};
+
+struct SimPipelineStats {
+    uint64_t published = 0;
+    uint64_t taken     = 0;
+    uint64_t dropped   = 0;    // replaced by a newer frame before the renderer took them
+    double overlap     = 0.0;  // fraction of the time spent rendering that an update also ran
+    double queueP50    = 0.0;  // milliseconds from publish until the renderer took the frame,
+    double queueP99    = 0.0;  // over the last kQueueHistory frames taken
+};
+
+class SimPipeline {
+public:
+    /// Fills `frame` after advancing the sim by `seconds` of wall time.
+    using UpdateFunc = std::function<void(SimFrame& frame, float seconds)>;
+
+    static constexpr uint32_t kQueueHistory = 256;
+
+    SimPipeline(std::chrono::nanoseconds period, UpdateFunc update);
+    /// Stops the thread if it is running.
+    ~SimPipeline();
+
+    SimPipeline(SimPipeline const&)            = delete;
+    SimPipeline& operator=(SimPipeline const&) = delete;
+
+    /// Moves updates to the pipeline's thread, which runs one every period until Stop. After a
+    /// stall it runs one update at once and carries on from there; catching up is the update's job.
+    void Start();
+    /// Lets the update in progress finish and joins the thread.
+    void Stop() noexcept;
+    bool IsThreaded() const noexcept {
+        return m_Thread.joinable();
+    }
+
+    /// Serial mode: runs one update on the calling thread and publishes its frame.
+    void Update(float seconds);
+
+    /// Runs `func` between two updates, for changes to state the updates own.
+    template<typename TFunc>
+    void RunExclusive(const TFunc& func) {
+        std::lock_guard lock(m_UpdateMutex);
+        func();
+    }
+
+    // Render thread
+
+    /// Takes the newest frame if one was published since the last call, and returns the frame
+    /// to draw, empty until the first publish. Rethrows an exception an update threw on the
+    /// pipeline's thread, which then stopped updating.
+    const SimFrame& AcquireFrame();
+
+    /// Bracket drawing and presenting a frame, for the overlap statistic.
+    void BeginRender() noexcept;
+    void EndRender() noexcept;
+
+    SimPipelineStats GetStats() const;
+
+private:
+    void ThreadMain();
+    void RunUpdate(float seconds);
+    /// Nanoseconds spent in updates so far, the one in progress included.
+    int64_t GetUpdateTime(int64_t now) const noexcept;
+
+    std::chrono::nanoseconds m_Period;
+    UpdateFunc m_Update;
+    TripleBuffer<SimFrame> m_Frames;
+    std::mutex m_UpdateMutex;  // held by every update
+    std::thread m_Thread;
+    std::atomic<bool> m_Stopping {false};
+
+    // Written by the updating thread
+    std::atomic<int64_t> m_UpdateTime {0};   // in finished updates
+    std::atomic<int64_t> m_UpdateStart {0};  // of the update in progress, 0 between updates
+    std::atomic<uint64_t> m_Published {0};
+    std::atomic<uint64_t> m_Dropped {0};
+    std::exception_ptr m_pError;
+    std::atomic<bool> m_Failed {false};  // set once m_pError is
+
+    // Render thread only
+    uint64_t m_Taken            = 0;
+    int64_t m_RenderStart       = 0;
+    int64_t m_UpdateTimeAtStart = 0;
+    int64_t m_RenderTime        = 0;
+    int64_t m_OverlapTime       = 0;
+    std::array<float, kQueueHistory> m_QueueLatency {};  // ring buffer, milliseconds
+};
@@ -0,0 +1,15 @@
+//
+// Simd.h - Compile-time selection of the SSE2 code paths
+//
+// PONG_SSE2 is 1 when SSE2 can be used unconditionally (every x64 target); code guarded by it
+// keeps a scalar fallback for other architectures.
+//
+
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define PONG_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define PONG_SSE2 0
+#endif
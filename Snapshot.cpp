@@ -0,0 +1,88 @@
+//
+// Snapshot.cpp - Versioned binary snapshots made of plain-data sections
+//
+
+#include "Snapshot.h"
+
+#include <bit>
+
+static_assert(std::endian::native == std::endian::little,
+              "Snapshots are little-endian and copied in place");
+
+namespace {
+    constexpr size_t PadSize(const size_t size) noexcept {
+        return (size + 3) & ~size_t {3};
+    }
+}  // namespace
+
+SnapshotWriter::SnapshotWriter(std::vector<std::byte>& buffer, const uint32_t schema)
+    : m_pBuffer(&buffer) {
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.schema  = schema;
+
+    buffer.resize(sizeof(header));
+    std::memcpy(buffer.data(), &header, sizeof(header));
+}
+
+void SnapshotWriter::WriteBytes(const uint32_t tag, const void* pData, const size_t size) {
+    if (size > UINT32_MAX)
+        throw std::length_error("Snapshot section is too large");
+
+    const SnapshotSection section = {tag, static_cast<uint32_t>(size)};
+    const size_t offset           = m_pBuffer->size();
+    m_pBuffer->resize(offset + sizeof(section) + PadSize(size));
+    std::byte* p = m_pBuffer->data() + offset;
+    std::memcpy(p, &section, sizeof(section));
+    if (size)
+        std::memcpy(p + sizeof(section), pData, size);
+    ++m_SectionCount;
+}
+
+void SnapshotWriter::Finish() noexcept {
+    const auto size = static_cast<uint32_t>(m_pBuffer->size());
+    std::byte* p    = m_pBuffer->data();
+    std::memcpy(p + offsetof(SnapshotHeader, size), &size, sizeof(size));
+    std::memcpy(p + offsetof(SnapshotHeader, sectionCount), &m_SectionCount, sizeof(uint32_t));
+}
+
+SnapshotReader::SnapshotReader(const std::span<const std::byte> bytes, const uint32_t schema)
+    : m_Bytes(bytes) {
+    SnapshotHeader header;
+    if (bytes.size() < sizeof(header))
+        throw std::runtime_error("Snapshot is truncated");
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 ||
+        header.version != kSnapshotVersion || header.size != bytes.size())
+        throw std::runtime_error("Invalid snapshot");
+    if (header.schema != schema)
+        throw std::runtime_error("Snapshot is from an incompatible version");
+
+    // Check every section lies inside the snapshot, so Find need not
+    size_t offset = sizeof(header);
+    for (uint32_t i = 0; i < header.sectionCount; ++i) {
+        SnapshotSection section;
+        if (bytes.size() - offset < sizeof(section))
+            throw std::runtime_error("Snapshot is truncated");
+        std::memcpy(&section, bytes.data() + offset, sizeof(section));
+        offset += sizeof(section);
+        if (bytes.size() - offset < PadSize(section.size))
+            throw std::runtime_error("Snapshot is truncated");
+        offset += PadSize(section.size);
+    }
+    m_SectionCount = header.sectionCount;
+}
+
+std::span<const std::byte> SnapshotReader::Find(const uint32_t tag) const {
+    size_t offset = sizeof(SnapshotHeader);
+    for (uint32_t i = 0; i < m_SectionCount; ++i) {
+        SnapshotSection section;
+        std::memcpy(&section, m_Bytes.data() + offset, sizeof(section));
+        offset += sizeof(section);
+        if (section.tag == tag)
+            return m_Bytes.subspan(offset, section.size);
+        offset += PadSize(section.size);
+    }
+    throw std::runtime_error("Snapshot is missing a section");
+}
@@ -0,0 +1,113 @@
+//
+// Snapshot.h - Versioned binary snapshots made of plain-data sections
+//
+// Layout (all integers little-endian):
+//   SnapshotHeader
+//   per section: SnapshotSection, then its payload padded to a multiple of 4 bytes
+//
+// A payload is an array of one plain-data type, copied in and out with memcpy, so writing or
+// reading a snapshot costs a handful of small copies. The header's schema version belongs to
+// whoever writes the sections and is bumped whenever the layout of one of them changes; readers
+// only accept the schema they were built for.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+inline constexpr char kSnapshotMagic[4]    = {'P', 'S', 'N', 'P'};
+inline constexpr uint32_t kSnapshotVersion = 1;  // of the container; sections have `schema`
+
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t schema;
+    uint32_t size;  // of the whole snapshot, header included
+    uint32_t sectionCount;
+    uint32_t reserved;
+};
+static_assert(sizeof(SnapshotHeader) == 24);
+
+struct SnapshotSection {
+    uint32_t tag;   // four characters, from MakeSnapshotTag
+    uint32_t size;  // of the payload, without padding
+};
+static_assert(sizeof(SnapshotSection) == 8);
+
+constexpr uint32_t MakeSnapshotTag(const char (&name)[5]) noexcept {
+    return static_cast<uint32_t>(static_cast<uint8_t>(name[0])) |
+           static_cast<uint32_t>(static_cast<uint8_t>(name[1])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(name[2])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(name[3])) << 24;
+}
+
+/// Writes sections into a byte buffer, replacing its contents but keeping its capacity, so
+/// writing into the same buffer again does not allocate.
+class SnapshotWriter {
+public:
+    SnapshotWriter(std::vector<std::byte>& buffer, uint32_t schema);
+
+    template<typename T>
+    void Write(const uint32_t tag, const std::span<const T> items) {
+        static_assert(std::is_trivially_copyable_v<T>, "Snapshot sections must be plain data");
+        WriteBytes(tag, items.data(), items.size_bytes());
+    }
+    template<typename T>
+    void Write(const uint32_t tag, const T& item) {
+        Write(tag, std::span<const T>(&item, 1));
+    }
+
+    /// Completes the header; the buffer then holds the snapshot.
+    void Finish() noexcept;
+
+private:
+    void WriteBytes(uint32_t tag, const void* pData, size_t size);
+
+    std::vector<std::byte>* m_pBuffer;
+    uint32_t m_SectionCount = 0;
+};
+
+/// Reads sections from a snapshot in memory, which must outlive the reader.
+class SnapshotReader {
+public:
+    /// Throws std::runtime_error if `bytes` is not a whole snapshot with the given schema.
+    SnapshotReader(std::span<const std::byte> bytes, uint32_t schema);
+
+    /// The number of T in a section. Throws std::runtime_error if the section is missing or its
+    /// size is not a whole number of T.
+    template<typename T>
+    uint32_t GetCount(const uint32_t tag) const {
+        const size_t size = Find(tag).size();
+        if (size % sizeof(T) != 0)
+            throw std::runtime_error("Snapshot section has the wrong size");
+        return static_cast<uint32_t>(size / sizeof(T));
+    }
+
+    /// Copies a section into `items`, which must be exactly its size. Throws std::runtime_error
+    /// if the section is missing or of another size.
+    template<typename T>
+    void Read(const uint32_t tag, const std::span<T> items) const {
+        static_assert(std::is_trivially_copyable_v<T>, "Snapshot sections must be plain data");
+        const std::span<const std::byte> payload = Find(tag);
+        if (payload.size() != items.size_bytes())
+            throw std::runtime_error("Snapshot section has the wrong size");
+        if (!payload.empty())
+            std::memcpy(items.data(), payload.data(), payload.size());
+    }
+    template<typename T>
+    void Read(const uint32_t tag, T& item) const {
+        Read(tag, std::span<T>(&item, 1));
+    }
+
+private:
+    std::span<const std::byte> Find(uint32_t tag) const;
+
+    std::span<const std::byte> m_Bytes;
+    uint32_t m_SectionCount = 0;
+};
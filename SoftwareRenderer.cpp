@@ -0,0 +1,226 @@
+//
+// SoftwareRenderer.cpp - CPU rasterizer for the court, for headless runs
+//
+
+#include "SoftwareRenderer.h"
+#include "Palette.h"
+#include "Sim.h"
+#include "Simd.h"
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    /// `color` with its alpha scaled by `fade`, premultiplied.
+    uint32_t Premultiply(const uint32_t color, const float fade) noexcept {
+        const auto alpha = static_cast<uint32_t>(
+          std::lround(static_cast<float>(color >> 24) * std::clamp(fade, 0.f, 1.f)));
+        const auto scale = [&](const uint32_t shift) {
+            return (((color >> shift) & 0xFF) * alpha + 127) / 255 << shift;
+        };
+        return alpha << 24 | scale(16) | scale(8) | scale(0);
+    }
+
+    /// x * y / 255 for x, y in 0-255, rounded to nearest.
+    uint32_t MulDiv255(const uint32_t x, const uint32_t y) noexcept {
+        const uint32_t t = x * y + 128;
+        return (t + (t >> 8)) >> 8;
+    }
+
+    /// Premultiplied source-over: dst = src + dst * (1 - src alpha).
+    uint32_t Blend(const uint32_t src, const uint32_t dst) noexcept {
+        const uint32_t inverse = 255 - (src >> 24);
+        uint32_t result        = 0;
+        for (uint32_t shift = 0; shift < 32; shift += 8) {
+            const uint32_t channel =
+              ((src >> shift) & 0xFF) + MulDiv255((dst >> shift) & 0xFF, inverse);
+            result |= std::min(channel, 255u) << shift;
+        }
+        return result;
+    }
+
+    /// The texel under pixel `pixel`'s centre, for a texture stretched from `edge`.
+    uint32_t SampleTexel(const float pixel,
+                         const float edge,
+                         const float texelsPerPixel,
+                         const uint32_t size) noexcept {
+        const auto texel = static_cast<int64_t>((pixel + 0.5f - edge) * texelsPerPixel);
+        return static_cast<uint32_t>(std::clamp<int64_t>(texel, 0, int64_t {size} - 1));
+    }
+
+#if PONG_SSE2
+    /// Four pixels of Blend; each pixel's alpha is broadcast to its four 16-bit lanes.
+    __m128i Blend4(const __m128i src, const __m128i dst) noexcept {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i k255 = _mm_set1_epi16(255);
+        const __m128i k128 = _mm_set1_epi16(128);
+
+        const auto blendHalf = [&](const __m128i src16, const __m128i dst16) {
+            const __m128i alpha =
+              _mm_shufflehi_epi16(_mm_shufflelo_epi16(src16, _MM_SHUFFLE(3, 3, 3, 3)),
+                                  _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i t = _mm_add_epi16(_mm_mullo_epi16(dst16, _mm_sub_epi16(k255, alpha)), k128);
+            t         = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+            return t;
+        };
+        const __m128i lo = blendHalf(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+        const __m128i hi = blendHalf(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+        return _mm_adds_epu8(src, _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    /// Blends `count` source pixels over `dst`.
+    void BlendRow(uint32_t* dst, const uint32_t* src, const uint32_t count) noexcept {
+        uint32_t i = 0;
+#if PONG_SSE2
+        for (; i + 4 <= count; i += 4) {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Blend4(s, d));
+        }
+#endif
+        for (; i < count; ++i)
+            dst[i] = Blend(src[i], dst[i]);
+    }
+
+    /// Blends one source pixel over `count` pixels.
+    void BlendSpan(uint32_t* dst, const uint32_t src, const uint32_t count) noexcept {
+        if (src >> 24 == 0xFF) {
+            std::fill(dst, dst + count, src);
+            return;
+        }
+        uint32_t i = 0;
+#if PONG_SSE2
+        const __m128i s = _mm_set1_epi32(static_cast<int>(src));
+        for (; i + 4 <= count; i += 4) {
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Blend4(s, d));
+        }
+#endif
+        for (; i < count; ++i)
+            dst[i] = Blend(src, dst[i]);
+    }
+}  // namespace
+
+SoftwareRenderer::SoftwareRenderer(const uint32_t width, const uint32_t height)
+    : m_Width(width), m_Height(height) {
+    if (width == 0 || height == 0)
+        throw std::invalid_argument("Framebuffer dimensions must be non-zero");
+    m_Pixels.resize(size_t {width} * height);
+    m_Columns.reserve(width);
+    m_Row.reserve(width);
+}
+
+void SoftwareRenderer::Clear(const uint32_t color) noexcept {
+    std::fill(m_Pixels.begin(), m_Pixels.end(), color);
+}
+
+SoftwareRenderer::PixelSpan SoftwareRenderer::Cover(const float x0,
+                                                    const float y0,
+                                                    const float x1,
+                                                    const float y1) const noexcept {
+    // Pixel i's centre is at i + 0.5, so it is covered when x0 <= i + 0.5 < x1
+    const auto first = [](const float edge, const uint32_t size) {
+        const float pixel = std::clamp(std::ceil(edge - 0.5f), 0.f, static_cast<float>(size));
+        return static_cast<uint32_t>(pixel);
+    };
+    PixelSpan span = {
+      first(x0, m_Width), first(y0, m_Height), first(x1, m_Width), first(y1, m_Height)};
+    span.x1 = std::max(span.x0, span.x1);
+    span.y1        = std::max(span.y0, span.y1);
+    return span;
+}
+
+void SoftwareRenderer::FillRect(const float x0,
+                                const float y0,
+                                const float x1,
+                                const float y1,
+                                const uint32_t color,
+                                const float fade) {
+    const PixelSpan span = Cover(x0, y0, x1, y1);
+    const uint32_t src   = Premultiply(color, fade);
+    if (src >> 24 == 0)
+        return;
+
+    for (uint32_t y = span.y0; y < span.y1; ++y)
+        BlendSpan(&m_Pixels[size_t {y} * m_Width + span.x0], src, span.x1 - span.x0);
+}
+
+void SoftwareRenderer::DrawTexture(const TextureData& texture,
+                                   const float x0,
+                                   const float y0,
+                                   const float x1,
+                                   const float y1) {
+    const PixelSpan span = Cover(x0, y0, x1, y1);
+    if (span.x0 == span.x1 || span.y0 == span.y1 || texture.mipCount == 0)
+        return;
+
+    // Each covered pixel samples the texel under its centre
+    const TextureMip& mip  = texture.mips[0];
+    const auto pixels      = texture.GetMip(0);
+    const float texelsPerX = static_cast<float>(mip.width) / (x1 - x0);
+    const float texelsPerY = static_cast<float>(mip.height) / (y1 - y0);
+
+    m_Columns.resize(span.x1 - span.x0);
+    for (uint32_t x = span.x0; x < span.x1; ++x)
+        m_Columns[x - span.x0] = SampleTexel(static_cast<float>(x), x0, texelsPerX, mip.width);
+
+    m_Row.resize(m_Columns.size());
+    for (uint32_t y = span.y0; y < span.y1; ++y) {
+        const uint32_t texelRow = SampleTexel(static_cast<float>(y), y0, texelsPerY, mip.height);
+        const std::byte* row    = pixels.data() + size_t {texelRow} * mip.rowPitch;
+        for (size_t i = 0; i < m_Columns.size(); ++i)
+            std::memcpy(&m_Row[i], row + size_t {m_Columns[i]} * 4, sizeof(uint32_t));
+        BlendRow(&m_Pixels[size_t {y} * m_Width + span.x0],
+                 m_Row.data(),
+                 static_cast<uint32_t>(m_Row.size()));
+    }
+}
+
+void SoftwareRenderer::Draw(const RenderList& list, const CourtTextures& textures) {
+    const float scaleX = static_cast<float>(m_Width) / kCourtWidth;
+    const float scaleY = static_cast<float>(m_Height) / kCourtHeight;
+
+    for (const RenderCommand& command : list.GetCommands()) {
+        const float x0 = command.x0 * scaleX;
+        const float y0 = command.y0 * scaleY;
+        const float x1 = command.x1 * scaleX;
+        const float y1 = command.y1 * scaleY;
+
+        const TextureData* pTexture = nullptr;
+        switch (command.type) {
+            case RenderCommandType::Clear:
+                Clear(command.color);
+                continue;
+            case RenderCommandType::Text:
+                continue;
+            case RenderCommandType::Sprite:
+                break;
+        }
+        switch (command.material) {
+            case RenderMaterial::Solid:
+                FillRect(x0, y0, x1, y1, command.color, command.fade);
+                continue;
+            case RenderMaterial::Paddle:
+                pTexture = textures.pPaddle;
+                break;
+            case RenderMaterial::Ball:
+                pTexture = textures.pBall;
+                break;
+        }
+        if (pTexture)
+            DrawTexture(*pTexture, x0, y0, x1, y1);
+        else
+            FillRect(x0, y0, x1, y1, kPlaceholderColor);
+    }
+}
+
+void SoftwareRenderer::DrawCourt(Sim& sim,
+                                 const CourtEffects* pEffects,
+                                 const CourtTextures& textures) {
+    RecordCourt(m_List, sim, pEffects);
+    Draw(m_List, textures);
+}
@@ -0,0 +1,73 @@
+//
+// SoftwareRenderer.h - CPU rasterizer for the court, for headless runs
+//
+// Draws the same RenderLists as Game::Render into a BGRA framebuffer, scaled from court units to
+// the framebuffer. Blending is premultiplied source-over, as with SpriteBatch's default blend
+// state, and textures are point sampled from their top mip. Text is not drawn.
+//
+
+#pragma once
+
+#include "RenderList.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class CourtEffects;
+class Sim;
+struct TextureData;
+
+/// Sprite textures for Draw; sprites without one are drawn in kPlaceholderColor.
+struct CourtTextures {
+    const TextureData* pPaddle = nullptr;
+    const TextureData* pBall   = nullptr;
+};
+
+class SoftwareRenderer {
+public:
+    /// Throws std::invalid_argument if either dimension is zero.
+    SoftwareRenderer(uint32_t width, uint32_t height);
+
+    /// Pixels are 0xAARRGGBB (B, G, R, A in memory), rows tightly packed.
+    std::span<const uint32_t> GetPixels() const noexcept {
+        return m_Pixels;
+    }
+    uint32_t GetWidth() const noexcept {
+        return m_Width;
+    }
+    uint32_t GetHeight() const noexcept {
+        return m_Height;
+    }
+
+    void Clear(uint32_t color) noexcept;
+
+    /// Blends `color` (0xAARRGGBB, straight alpha) with its alpha scaled by `fade` over the
+    /// pixels whose centres lie inside the rectangle.
+    void FillRect(float x0, float y0, float x1, float y1, uint32_t color, float fade = 1.f);
+
+    /// Stretches the top mip of a premultiplied BGRA texture over the rectangle and blends it.
+    void DrawTexture(const TextureData& texture, float x0, float y0, float x1, float y1);
+
+    /// Draws every command in the list, in order.
+    void Draw(const RenderList& list, const CourtTextures& textures);
+
+    /// Records the court into a list of its own and draws it. `pEffects` may be null.
+    void DrawCourt(Sim& sim, const CourtEffects* pEffects, const CourtTextures& textures);
+
+private:
+    struct PixelSpan {
+        uint32_t x0, y0;
+        uint32_t x1, y1;  // exclusive
+    };
+
+    /// The pixels whose centres lie inside a rectangle, clipped to the framebuffer.
+    PixelSpan Cover(float x0, float y0, float x1, float y1) const noexcept;
+
+    uint32_t m_Width;
+    uint32_t m_Height;
+    std::vector<uint32_t> m_Pixels;
+    std::vector<uint32_t> m_Columns;  // texel column per pixel column, reused by DrawTexture
+    std::vector<uint32_t> m_Row;      // one row of sampled texels, reused by DrawTexture
+    RenderList m_List;                // DrawCourt's, reused every call
+};
@@ -0,0 +1,65 @@
+//
+// Sounds.cpp - Procedural sound effects for the court, driven by the simulation's events
+//
+
+#include "Sounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float kTwoPi = 6.2831853f;
+
+    /// A tone gliding from `startHz` to `endHz` with an exponential decay, plus `noise` of white
+    /// noise decaying twice as fast for a sharper attack.
+    AudioClip Synthesize(const uint32_t sampleRate,
+                         const float seconds,
+                         const float startHz,
+                         const float endHz,
+                         const float decay,
+                         const float noise) {
+        const auto length = static_cast<uint32_t>(seconds * static_cast<float>(sampleRate));
+        const float dt    = 1.f / static_cast<float>(sampleRate);
+
+        std::vector<float> samples(length);
+        float phase    = 0.f;
+        uint32_t state = 1;
+        for (uint32_t i = 0; i < length; ++i) {
+            const float t        = static_cast<float>(i) * dt;
+            const float progress = static_cast<float>(i) / static_cast<float>(length);
+            const float hz       = startHz + (endHz - startHz) * progress;
+            phase                = std::fmod(phase + kTwoPi * hz * dt, kTwoPi);
+
+            state              = state * 1664525u + 1013904223u;
+            const float random = static_cast<float>(state >> 8) / 8388608.f - 1.f;
+
+            // A short linear attack avoids a click at the start
+            const float attack = std::min(1.f, t * 1000.f);
+            const float tone   = std::sin(phase) * std::exp(-decay * t);
+            const float hiss   = noise * random * std::exp(-2.f * decay * t);
+            samples[i]         = attack * (tone + hiss) * 0.5f;
+        }
+        return MakeClip(sampleRate, std::move(samples));
+    }
+}  // namespace
+
+CourtSounds::CourtSounds(const uint32_t sampleRate) {
+    m_Clips[static_cast<size_t>(SimEventType::PaddleHit)] =
+      Synthesize(sampleRate, 0.12f, 520.f, 480.f, 30.f, 0.3f);
+    m_Clips[static_cast<size_t>(SimEventType::WallHit)] =
+      Synthesize(sampleRate, 0.06f, 300.f, 260.f, 60.f, 0.2f);
+    m_Clips[static_cast<size_t>(SimEventType::Goal)] =
+      Synthesize(sampleRate, 0.6f, 660.f, 180.f, 5.f, 0.f);
+    m_Clips[static_cast<size_t>(SimEventType::BrickBroken)] =
+      Synthesize(sampleRate, 0.05f, 900.f, 700.f, 70.f, 0.6f);
+}
+
+void CourtSounds::Emit(AudioMixer& mixer, const Sim& sim) const {
+    for (const SimEvent& event : sim.GetEvents()) {
+        // Higher up the court plays slightly higher, so rallies do not repeat one note
+        const float pan    = event.x / kCourtWidth * 2.f - 1.f;
+        const float pitch  = 1.1f - 0.2f * event.y / kCourtHeight;
+        const float volume = event.type == SimEventType::BrickBroken ? 0.5f : 0.8f;
+        mixer.Play(GetClip(event.type), volume, pitch, pan * 0.8f);
+    }
+}
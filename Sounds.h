@@ -0,0 +1,28 @@
+//
+// Sounds.h - Procedural sound effects for the court, driven by the simulation's events
+//
+
+#pragma once
+
+#include "AudioMixer.h"
+#include "Sim.h"
+
+#include <array>
+
+/// Paddle hits, wall bounces, goals and broken bricks, synthesized at startup so they need no
+/// assets. Like CourtEffects, it reacts to the events of each sim step.
+class CourtSounds {
+public:
+    explicit CourtSounds(uint32_t sampleRate);
+
+    /// Plays a sound for each event of the sim's last step, panned to where it happened. Call
+    /// once per step from the thread that posts the mixer's commands.
+    void Emit(AudioMixer& mixer, const Sim& sim) const;
+
+    const AudioClip& GetClip(const SimEventType type) const noexcept {
+        return m_Clips[static_cast<size_t>(type)];
+    }
+
+private:
+    std::array<AudioClip, 4> m_Clips;  // by SimEventType
+};
@@ -0,0 +1,76 @@
+//
+// SpscQueue.h - Bounded lock-free single-producer single-consumer ring
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+/// One thread pushes and one other thread pops, without locks or allocation. Each side keeps a
+/// cached copy of the other's index and only reloads it when the ring looks full or empty, and
+/// the indices sit on separate cache lines, so the two threads rarely share a line.
+template<typename T, uint32_t kCapacity>
+class SpscQueue {
+    static_assert(kCapacity && (kCapacity & (kCapacity - 1)) == 0,
+                  "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    /// Producer side. Returns false, dropping the item, if the ring is full.
+    bool TryPush(const T& item) noexcept {
+        const uint32_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_CachedHead == kCapacity) {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+            if (tail - m_CachedHead == kCapacity)
+                return false;
+        }
+
+        m_Items[tail & (kCapacity - 1)] = item;
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer side. The oldest item, or null if the ring is empty; valid until Pop.
+    const T* Peek() noexcept {
+        const uint32_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_CachedTail) {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+            if (head == m_CachedTail)
+                return nullptr;
+        }
+        return &m_Items[head & (kCapacity - 1)];
+    }
+
+    /// Consumer side. Removes the item returned by Peek.
+    void Pop() noexcept {
+        m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// Consumer side.
+    bool TryPop(T& item) noexcept {
+        const T* pItem = Peek();
+        if (!pItem)
+            return false;
+        item = *pItem;
+        Pop();
+        return true;
+    }
+
+    static constexpr uint32_t GetCapacity() noexcept {
+        return kCapacity;
+    }
+
+private:
+    // Written by the consumer
+    alignas(64) std::atomic<uint32_t> m_Head {0};
+    uint32_t m_CachedTail = 0;
+
+    // Written by the producer
+    alignas(64) std::atomic<uint32_t> m_Tail {0};
+    uint32_t m_CachedHead = 0;
+
+    alignas(64) std::array<T, kCapacity> m_Items {};
+};
@@ -0,0 +1,171 @@
+//
+// TextureFile.cpp - Pre-decoded, GPU-ready texture container (.ptex)
+//
+
+#include "TextureFile.h"
+#include "AssetPack.h"
+#include "Png.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    constexpr uint64_t kMipAlignment = 64;
+
+    uint64_t AlignUp(const uint64_t value) noexcept {
+        return (value + kMipAlignment - 1) & ~(kMipAlignment - 1);
+    }
+
+    // Fills in mip dimensions and offsets; returns the total storage size.
+    uint64_t LayoutMips(TextureData& texture, const uint64_t firstOffset) noexcept {
+        uint64_t offset = firstOffset;
+        uint32_t width  = texture.width;
+        uint32_t height = texture.height;
+        for (uint32_t level = 0; level < texture.mipCount; ++level) {
+            auto& mip    = texture.mips[level];
+            mip.width    = width;
+            mip.height   = height;
+            mip.rowPitch = width * 4;
+            mip.offset   = AlignUp(offset);
+            mip.size     = uint64_t {mip.rowPitch} * height;
+            offset       = mip.offset + mip.size;
+
+            width  = std::max(1u, width / 2);
+            height = std::max(1u, height / 2);
+        }
+        return offset;
+    }
+
+    // 2x2 box filter; odd edges reuse the last row/column. Correct for premultiplied alpha.
+    void Downsample(const std::byte* src,
+                    const TextureMip& srcMip,
+                    std::byte* dst,
+                    const TextureMip& dstMip) {
+        for (uint32_t y = 0; y < dstMip.height; ++y) {
+            const uint32_t y0 = std::min(y * 2, srcMip.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, srcMip.height - 1);
+            for (uint32_t x = 0; x < dstMip.width; ++x) {
+                const uint32_t x0 = std::min(x * 2, srcMip.width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, srcMip.width - 1);
+                for (uint32_t c = 0; c < 4; ++c) {
+                    const auto texel = [&](const uint32_t sx, const uint32_t sy) {
+                        return static_cast<uint32_t>(src[sy * srcMip.rowPitch + sx * 4 + c]);
+                    };
+                    const uint32_t sum =
+                      texel(x0, y0) + texel(x1, y0) + texel(x0, y1) + texel(x1, y1);
+                    dst[y * dstMip.rowPitch + x * 4 + c] = static_cast<std::byte>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+}  // namespace
+
+TextureData ParseTexture(const std::span<const std::byte> file) {
+    TextureFileHeader header;
+    if (file.size() < sizeof(header))
+        throw std::runtime_error("Texture file is truncated");
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, kTextureMagic, sizeof(kTextureMagic)) != 0 ||
+        header.version != kTextureVersion || header.format != kTextureFormatBgra ||
+        header.mipCount == 0 || header.mipCount > kMaxTextureMips)
+        throw std::runtime_error("Invalid texture file");
+
+    const size_t tableSize = sizeof(TextureMip) * header.mipCount;
+    if (file.size() < sizeof(header) + tableSize)
+        throw std::runtime_error("Texture file is truncated");
+
+    TextureData texture;
+    texture.width    = header.width;
+    texture.height   = header.height;
+    texture.mipCount = header.mipCount;
+    texture.mapped   = file;
+    std::memcpy(texture.mips, file.data() + sizeof(header), tableSize);
+
+    for (uint32_t level = 0; level < texture.mipCount; ++level) {
+        const auto& mip = texture.mips[level];
+        if (mip.offset + mip.size > file.size() || mip.size < uint64_t {mip.rowPitch} * mip.height)
+            throw std::runtime_error("Texture mip is out of bounds");
+    }
+    return texture;
+}
+
+TextureData ConvertImage(const Image& image, const bool generateMips) {
+    TextureData texture;
+    texture.width    = image.width;
+    texture.height   = image.height;
+    texture.mipCount = 1;
+    if (generateMips) {
+        for (uint32_t size = std::max(image.width, image.height); size > 1; size /= 2)
+            ++texture.mipCount;
+        texture.mipCount = std::min(texture.mipCount, kMaxTextureMips);
+    }
+
+    texture.owned.resize(static_cast<size_t>(LayoutMips(texture, 0)));
+
+    const uint8_t* src = image.pixels.data();
+    auto* dst          = texture.owned.data();
+    for (size_t i = 0, count = size_t {image.width} * image.height; i < count; ++i) {
+        const uint32_t a = src[i * 4 + 3];
+        dst[i * 4 + 0]   = static_cast<std::byte>((src[i * 4 + 2] * a + 127) / 255);
+        dst[i * 4 + 1]   = static_cast<std::byte>((src[i * 4 + 1] * a + 127) / 255);
+        dst[i * 4 + 2]   = static_cast<std::byte>((src[i * 4 + 0] * a + 127) / 255);
+        dst[i * 4 + 3]   = static_cast<std::byte>(a);
+    }
+
+    for (uint32_t level = 1; level < texture.mipCount; ++level) {
+        const auto& srcMip = texture.mips[level - 1];
+        const auto& dstMip = texture.mips[level];
+        Downsample(texture.owned.data() + srcMip.offset,
+                   srcMip,
+                   texture.owned.data() + dstMip.offset,
+                   dstMip);
+    }
+
+    return texture;
+}
+
+std::vector<std::byte> WriteTexture(const TextureData& texture) {
+    TextureFileHeader header = {};
+    std::memcpy(header.magic, kTextureMagic, sizeof(kTextureMagic));
+    header.version  = kTextureVersion;
+    header.width    = texture.width;
+    header.height   = texture.height;
+    header.mipCount = texture.mipCount;
+    header.format   = kTextureFormatBgra;
+
+    TextureData layout = {};
+    layout.width       = texture.width;
+    layout.height      = texture.height;
+    layout.mipCount    = texture.mipCount;
+    const uint64_t size =
+      LayoutMips(layout, sizeof(header) + sizeof(TextureMip) * uint64_t {texture.mipCount});
+
+    std::vector<std::byte> file(static_cast<size_t>(size));
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(header), layout.mips, sizeof(TextureMip) * texture.mipCount);
+    for (uint32_t level = 0; level < texture.mipCount; ++level) {
+        const auto src = texture.GetMip(level);
+        std::memcpy(file.data() + layout.mips[level].offset, src.data(), src.size());
+    }
+    return file;
+}
+
+TextureData LoadPackedTexture(const AssetPack& pack, const std::string_view name) {
+    const std::string base(name);
+
+    std::vector<std::byte> scratch;
+    if (pack.Find(base + ".ptex")) {
+        auto texture = ParseTexture(pack.Load(base + ".ptex", scratch));
+        if (!scratch.empty()) {
+            // Compressed in the pack; the mip offsets are file-relative, so keep the whole file.
+            texture.mapped = {};
+            texture.owned  = std::move(scratch);
+        }
+        return texture;
+    }
+
+    return ConvertImage(DecodePng(pack.Load(base + ".png", scratch)), false);
+}
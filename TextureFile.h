@@ -0,0 +1,80 @@
+//
+// TextureFile.h - Pre-decoded, GPU-ready texture container (.ptex)
+//
+// A .ptex file is a TextureFileHeader, a TextureMip table and the pixel data of every mip level,
+// each level starting on a 64-byte boundary. Pixels are premultiplied BGRA8, laid out exactly as
+// DXGI_FORMAT_B8G8R8A8_UNORM subresources, so a mapped file can be uploaded without conversion.
+//
+
+#pragma once
+
+#include "Image.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+class AssetPack;
+
+inline constexpr char kTextureMagic[4]       = {'P', 'T', 'E', 'X'};
+inline constexpr uint32_t kTextureVersion    = 1;
+inline constexpr uint32_t kTextureFormatBgra = 87;  // DXGI_FORMAT_B8G8R8A8_UNORM
+inline constexpr uint32_t kMaxTextureMips    = 16;
+
+struct TextureFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    uint32_t format;
+    uint32_t reserved[2];
+};
+static_assert(sizeof(TextureFileHeader) == 32);
+
+struct TextureMip {
+    uint32_t width;
+    uint32_t height;
+    uint32_t rowPitch;
+    uint32_t reserved;
+    uint64_t offset;  // from the start of the pixel storage
+    uint64_t size;
+};
+static_assert(sizeof(TextureMip) == 32);
+
+/// A texture ready for upload. The pixels either live in a mapped .ptex file (zero-copy) or in
+/// `owned` when they had to be decoded or decompressed at load time.
+struct TextureData {
+    uint32_t width    = 0;
+    uint32_t height   = 0;
+    uint32_t mipCount = 0;
+    TextureMip mips[kMaxTextureMips] {};
+
+    std::span<const std::byte> mapped;
+    std::vector<std::byte> owned;
+
+    std::span<const std::byte> GetStorage() const noexcept {
+        return owned.empty() ? mapped : std::span<const std::byte>(owned);
+    }
+
+    std::span<const std::byte> GetMip(const uint32_t level) const noexcept {
+        return GetStorage().subspan(static_cast<size_t>(mips[level].offset),
+                                    static_cast<size_t>(mips[level].size));
+    }
+};
+
+/// Views a .ptex file in place; the result references `file`. Throws std::runtime_error if the
+/// file is malformed.
+TextureData ParseTexture(std::span<const std::byte> file);
+
+/// Converts straight-alpha RGBA to premultiplied BGRA, optionally with a box-filtered mip chain.
+TextureData ConvertImage(const Image& image, bool generateMips);
+
+/// Serializes a texture as a .ptex file.
+std::vector<std::byte> WriteTexture(const TextureData& texture);
+
+/// Loads `<name>.ptex` from the pack, falling back to decoding `<name>.png` only if the converted
+/// texture is missing. Throws std::runtime_error if neither exists.
+TextureData LoadPackedTexture(const AssetPack& pack, std::string_view name);
@@ -0,0 +1,58 @@
+//
+// TripleBuffer.h - Lock-free handoff of the latest value from one thread to another
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/// Three slots of T shared by one writer and one reader, neither of which ever waits: the writer
+/// fills its slot and publishes it, and the reader takes the newest published slot whenever it
+/// wants one. Values the reader never took are overwritten, so it always sees the latest, and
+/// slots are reused in place, so T's buffers keep their capacity.
+template<typename T>
+class TripleBuffer {
+public:
+    /// The writer's slot, to fill before Publish.
+    T& GetWriteSlot() noexcept {
+        return m_Slots[m_Write];
+    }
+
+    /// Makes the write slot the newest value and hands the writer a free slot, which holds
+    /// whatever it last held. Returns true if the value published before was never taken.
+    bool Publish() noexcept {
+        const uint8_t previous = m_Latest.exchange(m_Write | kFresh, std::memory_order_acq_rel);
+        m_Write                = previous & kIndexMask;
+        return (previous & kFresh) != 0;
+    }
+
+    /// Takes the newest published value into the read slot. Returns false, keeping the read
+    /// slot as it was, if nothing was published since the last call.
+    bool Acquire() noexcept {
+        if (!(m_Latest.load(std::memory_order_relaxed) & kFresh))
+            return false;
+        m_Read = m_Latest.exchange(m_Read, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    /// The reader's slot, valid until the next Acquire.
+    T& GetReadSlot() noexcept {
+        return m_Slots[m_Read];
+    }
+    const T& GetReadSlot() const noexcept {
+        return m_Slots[m_Read];
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh     = 0x4;  // set while the latest slot has not been taken
+
+    std::array<T, 3> m_Slots {};
+
+    // Each side's index is only touched by that side; the shared one is swapped atomically
+    alignas(64) uint8_t m_Write = 0;
+    alignas(64) std::atomic<uint8_t> m_Latest {1};
+    alignas(64) uint8_t m_Read = 2;
+};
@@ -0,0 +1,119 @@
+//
+// UniformGrid.cpp - Static uniform-grid broadphase with removal and segment traversal
+//
+
+#include "UniformGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+UniformGrid::UniformGrid(const float originX,
+                         const float originY,
+                         const float cellSize,
+                         const uint32_t columns,
+                         const uint32_t rows)
+    : m_OriginX(originX),
+      m_OriginY(originY),
+      m_CellSize(cellSize),
+      m_InvCellSize(1.f / cellSize),
+      m_Columns(columns),
+      m_Rows(rows) {
+    if (cellSize <= 0.f || columns == 0 || rows == 0 || columns > UINT16_MAX ||
+        rows > UINT16_MAX)
+        throw std::invalid_argument("Invalid uniform grid dimensions");
+
+    m_CellStart.assign(size_t {columns} * rows + 1, 0);
+    m_CellCount.assign(size_t {columns} * rows, 0);
+}
+
+void UniformGrid::Build(const std::span<const GridBox> boxes, const float margin) {
+    m_ItemCells.resize(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        const GridBox& box = boxes[i];
+        m_ItemCells[i]     = {static_cast<uint16_t>(ToColumn(box.minX - margin)),
+                              static_cast<uint16_t>(ToRow(box.minY - margin)),
+                              static_cast<uint16_t>(ToColumn(box.maxX + margin)),
+                              static_cast<uint16_t>(ToRow(box.maxY + margin)),
+                              true};
+    }
+
+    // Two passes: count per cell, then fill each cell's slice
+    std::fill(m_CellCount.begin(), m_CellCount.end(), 0u);
+    for (const auto& range : m_ItemCells) {
+        for (uint32_t row = range.row0; row <= range.row1; ++row) {
+            for (uint32_t column = range.column0; column <= range.column1; ++column)
+                m_CellCount[row * m_Columns + column]++;
+        }
+    }
+
+    for (size_t cell = 0; cell < m_CellCount.size(); ++cell)
+        m_CellStart[cell + 1] = m_CellStart[cell] + m_CellCount[cell];
+    m_CellItems.resize(m_CellStart.back());
+
+    std::fill(m_CellCount.begin(), m_CellCount.end(), 0u);
+    for (uint32_t item = 0; item < m_ItemCells.size(); ++item) {
+        const CellRange& range = m_ItemCells[item];
+        for (uint32_t row = range.row0; row <= range.row1; ++row) {
+            for (uint32_t column = range.column0; column <= range.column1; ++column) {
+                const uint32_t cell = row * m_Columns + column;
+                m_CellItems[m_CellStart[cell] + m_CellCount[cell]++] = item;
+            }
+        }
+    }
+}
+
+bool UniformGrid::Remove(const uint32_t item) {
+    if (!Contains(item))
+        return false;
+
+    CellRange& range = m_ItemCells[item];
+    for (uint32_t row = range.row0; row <= range.row1; ++row) {
+        for (uint32_t column = range.column0; column <= range.column1; ++column) {
+            const uint32_t cell = row * m_Columns + column;
+            uint32_t* items     = m_CellItems.data() + m_CellStart[cell];
+            uint32_t& count     = m_CellCount[cell];
+
+            // Swap with the last live item so the live items stay packed
+            const auto it = std::find(items, items + count, item);
+            if (it != items + count)
+                std::swap(*it, items[--count]);
+        }
+    }
+
+    range.live = false;
+    return true;
+}
+
+bool UniformGrid::Reinsert(const uint32_t item) {
+    if (item >= m_ItemCells.size() || Contains(item))
+        return false;
+
+    CellRange& range = m_ItemCells[item];
+    for (uint32_t row = range.row0; row <= range.row1; ++row) {
+        for (uint32_t column = range.column0; column <= range.column1; ++column) {
+            const uint32_t cell = row * m_Columns + column;
+            uint32_t* items     = m_CellItems.data() + m_CellStart[cell];
+            uint32_t* end       = m_CellItems.data() + m_CellStart[cell + 1];
+            uint32_t& count     = m_CellCount[cell];
+
+            // Removed items sit after the live ones; swap it to the front of them
+            const auto it = std::find(items + count, end, item);
+            if (it != end)
+                std::swap(*it, items[count++]);
+        }
+    }
+
+    range.live = true;
+    return true;
+}
+
+uint32_t UniformGrid::ToColumn(const float x) const noexcept {
+    const float column = std::floor((x - m_OriginX) * m_InvCellSize);
+    return static_cast<uint32_t>(std::clamp(column, 0.f, static_cast<float>(m_Columns - 1)));
+}
+
+uint32_t UniformGrid::ToRow(const float y) const noexcept {
+    const float row = std::floor((y - m_OriginY) * m_InvCellSize);
+    return static_cast<uint32_t>(std::clamp(row, 0.f, static_cast<float>(m_Rows - 1)));
+}
@@ -0,0 +1,147 @@
+//
+// UniformGrid.h - Static uniform-grid broadphase with removal and segment traversal
+//
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct GridBox {
+    float minX, minY;
+    float maxX, maxY;
+};
+
+/// Buckets a fixed set of boxes by the square cells they overlap. The set is built once; items
+/// can then only be removed and reinserted, which is cheap because each cell keeps its live items
+/// packed at the front of its slice. Queries walk the cells along a segment, so their cost depends on the
+/// cells crossed rather than on the number of items.
+class UniformGrid {
+public:
+    /// The grid covers `columns` x `rows` cells from the origin. Boxes reaching past it are
+    /// bucketed into the border cells.
+    UniformGrid(float originX, float originY, float cellSize, uint32_t columns, uint32_t rows);
+
+    /// Replaces the contents with `boxes`, each grown by `margin` on every side before bucketing;
+    /// pass the half size of the moving object so a segment through its centre finds every box
+    /// it could touch. Item ids are indices into `boxes`.
+    void Build(std::span<const GridBox> boxes, float margin);
+
+    /// Removes an item from every cell holding it. Returns false if it was already removed.
+    bool Remove(uint32_t item);
+
+    /// Puts a removed item back into its cells. Returns false if it was not removed.
+    bool Reinsert(uint32_t item);
+
+    bool Contains(const uint32_t item) const noexcept {
+        return item < m_ItemCells.size() && m_ItemCells[item].live;
+    }
+
+    /// Visits the cells crossed by the segment from (x0, y0) to (x1, y1) in order, calling
+    /// visit(std::span<const uint32_t> items, float tEnter, float tExit) with the segment
+    /// parameters (0 to 1) where the segment enters and leaves the cell. Stops early when visit
+    /// returns false, typically once a hit closer than tExit has been found. Only the part of the
+    /// segment inside the grid is walked.
+    template<typename TVisit>
+    void Traverse(float x0, float y0, float x1, float y1, const TVisit& visit) const;
+
+    uint32_t GetColumns() const noexcept {
+        return m_Columns;
+    }
+    uint32_t GetRows() const noexcept {
+        return m_Rows;
+    }
+
+private:
+    struct CellRange {
+        uint16_t column0, row0;
+        uint16_t column1, row1;
+        bool live;
+    };
+
+    std::span<const uint32_t> GetCellItems(uint32_t column, uint32_t row) const noexcept {
+        const uint32_t cell = row * m_Columns + column;
+        return {m_CellItems.data() + m_CellStart[cell], m_CellCount[cell]};
+    }
+
+    uint32_t ToColumn(float x) const noexcept;
+    uint32_t ToRow(float y) const noexcept;
+
+    float m_OriginX;
+    float m_OriginY;
+    float m_CellSize;
+    float m_InvCellSize;
+    uint32_t m_Columns;
+    uint32_t m_Rows;
+
+    std::vector<uint32_t> m_CellStart;  // slice of m_CellItems per cell
+    std::vector<uint32_t> m_CellCount;  // live items at the front of the slice
+    std::vector<uint32_t> m_CellItems;
+    std::vector<CellRange> m_ItemCells;
+};
+
+template<typename TVisit>
+void UniformGrid::Traverse(const float x0,
+                           const float y0,
+                           const float x1,
+                           const float y1,
+                           const TVisit& visit) const {
+    // Amanatides-Woo: step into whichever neighbouring cell the segment reaches first
+    const float dx = x1 - x0;
+    const float dy = y1 - y0;
+
+    // Clip the segment to the grid's bounds
+    const float maxX = m_OriginX + m_CellSize * static_cast<float>(m_Columns);
+    const float maxY = m_OriginY + m_CellSize * static_cast<float>(m_Rows);
+    float tEnter     = 0.f;
+    float tLeave     = 1.f;
+    const auto clip  = [&](const float start, const float delta, const float lo, const float hi) {
+        if (delta == 0.f)
+            return start >= lo && start <= hi;
+        float t0 = (lo - start) / delta;
+        float t1 = (hi - start) / delta;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tEnter = t0 > tEnter ? t0 : tEnter;
+        tLeave = t1 < tLeave ? t1 : tLeave;
+        return tEnter <= tLeave;
+    };
+    if (!clip(x0, dx, m_OriginX, maxX) || !clip(y0, dy, m_OriginY, maxY))
+        return;
+
+    uint32_t column = ToColumn(x0 + dx * tEnter);
+    uint32_t row    = ToRow(y0 + dy * tEnter);
+
+    constexpr float kNever = 3.0e38f;
+    const int stepX        = dx > 0.f ? 1 : -1;
+    const int stepY        = dy > 0.f ? 1 : -1;
+    const float deltaX     = dx != 0.f ? m_CellSize / (dx > 0.f ? dx : -dx) : kNever;
+    const float deltaY     = dy != 0.f ? m_CellSize / (dy > 0.f ? dy : -dy) : kNever;
+
+    const auto boundary = [&](const float origin, const uint32_t cell, const int step) {
+        return origin + m_CellSize * static_cast<float>(step > 0 ? cell + 1 : cell);
+    };
+    float nextX = dx != 0.f ? (boundary(m_OriginX, column, stepX) - x0) / dx : kNever;
+    float nextY = dy != 0.f ? (boundary(m_OriginY, row, stepY) - y0) / dy : kNever;
+
+    for (;;) {
+        const float tExit = nextX < nextY ? (nextX < tLeave ? nextX : tLeave)
+                                          : (nextY < tLeave ? nextY : tLeave);
+        if (!visit(GetCellItems(column, row), tEnter, tExit) || tExit >= tLeave)
+            return;
+
+        if (nextX < nextY) {
+            if ((stepX < 0 && column == 0) || (stepX > 0 && column + 1 == m_Columns))
+                return;
+            column += stepX;
+            nextX += deltaX;
+        } else {
+            if ((stepY < 0 && row == 0) || (stepY > 0 && row + 1 == m_Rows))
+                return;
+            row += stepY;
+            nextY += deltaY;
+        }
+        tEnter = tExit;
+    }
+}
@@ -0,0 +1,163 @@
+//
+// Utf.cpp - Conversion between UTF-8 and wide strings
+//
+
+#include "Utf.h"
+#include "Simd.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    constexpr uint32_t kReplacement = 0xFFFD;
+
+    wchar_t* PutWide(uint32_t c, wchar_t* out) noexcept {
+        if (sizeof(wchar_t) == 2 && c >= 0x10000) {
+            c -= 0x10000;
+            out[0] = static_cast<wchar_t>(0xD800 + (c >> 10));
+            out[1] = static_cast<wchar_t>(0xDC00 + (c & 0x3FF));
+            return out + 2;
+        }
+        *out = static_cast<wchar_t>(c);
+        return out + 1;
+    }
+
+#if PONG_SSE2
+    void WidenAscii(const __m128i bytes, wchar_t* out) noexcept {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lo   = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i hi   = _mm_unpackhi_epi8(bytes, zero);
+        auto* pOut         = reinterpret_cast<__m128i*>(out);
+        if constexpr (sizeof(wchar_t) == 2) {
+            _mm_storeu_si128(pOut, lo);
+            _mm_storeu_si128(pOut + 1, hi);
+        } else {
+            _mm_storeu_si128(pOut, _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(pOut + 1, _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(pOut + 2, _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(pOut + 3, _mm_unpackhi_epi16(hi, zero));
+        }
+    }
+#endif
+}  // namespace
+
+size_t DecodeUtf8(const std::string_view text, wchar_t* out) noexcept {
+    const auto* p         = reinterpret_cast<const uint8_t*>(text.data());
+    const auto* const end = p + text.size();
+    wchar_t* const start  = out;
+
+    while (p != end) {
+#if PONG_SSE2
+        while (end - p >= 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(bytes))
+                break;
+            WidenAscii(bytes, out);
+            p += 16;
+            out += 16;
+        }
+#else
+        while (end - p >= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            if (word & 0x8080808080808080)
+                break;
+            for (int i = 0; i < 8; ++i)
+                out[i] = static_cast<wchar_t>(p[i]);
+            p += 8;
+            out += 8;
+        }
+#endif
+        if (p == end)
+            break;
+
+        const uint32_t lead = *p++;
+        if (lead < 0x80) {
+            *out++ = static_cast<wchar_t>(lead);
+            continue;
+        }
+
+        if (lead < 0xC2 || lead > 0xF4) {
+            *out++ = static_cast<wchar_t>(kReplacement);
+            continue;
+        }
+
+        // The second byte's range also rules out overlong forms, surrogates and values past
+        // U+10FFFF
+        uint32_t c;
+        uint32_t length;
+        uint8_t lo = 0x80;
+        uint8_t hi = 0xBF;
+        if (lead < 0xE0) {
+            c      = lead & 0x1F;
+            length = 1;
+        } else if (lead < 0xF0) {
+            c      = lead & 0x0F;
+            length = 2;
+            lo     = lead == 0xE0 ? 0xA0 : 0x80;
+            hi     = lead == 0xED ? 0x9F : 0xBF;
+        } else {
+            c      = lead & 0x07;
+            length = 3;
+            lo     = lead == 0xF0 ? 0x90 : 0x80;
+            hi     = lead == 0xF4 ? 0x8F : 0xBF;
+        }
+
+        bool valid = true;
+        for (uint32_t i = 0; i < length; ++i) {
+            if (p == end || *p < lo || *p > hi) {
+                valid = false;  // the bytes so far are the invalid subsequence
+                break;
+            }
+            c  = c << 6 | (*p++ & 0x3F);
+            lo = 0x80;
+            hi = 0xBF;
+        }
+        out = PutWide(valid ? c : kReplacement, out);
+    }
+
+    return static_cast<size_t>(out - start);
+}
+
+size_t EncodeUtf8(const std::wstring_view text, char* out) noexcept {
+    const wchar_t* p         = text.data();
+    const wchar_t* const end = p + text.size();
+    char* const start        = out;
+
+    while (p != end) {
+        uint32_t c = static_cast<uint32_t>(*p++);
+        if (c < 0x80) {
+            *out++ = static_cast<char>(c);
+            continue;
+        }
+
+        if (sizeof(wchar_t) == 2 && c >= 0xD800 && c < 0xDC00 && p != end) {
+            const auto next = static_cast<uint32_t>(*p);
+            if (next >= 0xDC00 && next < 0xE000) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (next - 0xDC00);
+                ++p;
+            }
+        }
+        if ((c >= 0xD800 && c < 0xE000) || c > 0x10FFFF)
+            c = kReplacement;
+
+        if (c < 0x800) {
+            out[0] = static_cast<char>(0xC0 | c >> 6);
+            out[1] = static_cast<char>(0x80 | (c & 0x3F));
+            out += 2;
+        } else if (c < 0x10000) {
+            out[0] = static_cast<char>(0xE0 | c >> 12);
+            out[1] = static_cast<char>(0x80 | (c >> 6 & 0x3F));
+            out[2] = static_cast<char>(0x80 | (c & 0x3F));
+            out += 3;
+        } else {
+            out[0] = static_cast<char>(0xF0 | c >> 18);
+            out[1] = static_cast<char>(0x80 | (c >> 12 & 0x3F));
+            out[2] = static_cast<char>(0x80 | (c >> 6 & 0x3F));
+            out[3] = static_cast<char>(0x80 | (c & 0x3F));
+            out += 4;
+        }
+    }
+
+    return static_cast<size_t>(out - start);
+}
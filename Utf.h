@@ -0,0 +1,47 @@
+//
+// Utf.h - Conversion between UTF-8 and wide strings
+//
+// Text is UTF-8 inside the game (exception messages, paths in packs, JSON output) and wide at
+// the Win32 and DirectWrite boundary. Wide strings are UTF-16 where wchar_t is 16 bits, as on
+// Windows, and UTF-32 elsewhere.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+/// Code units DecodeUtf8 may write for `bytes` of UTF-8: never more than one per byte.
+constexpr size_t GetMaxWideLength(const size_t bytes) noexcept {
+    return bytes;
+}
+
+/// Bytes EncodeUtf8 may write for `units` wide code units.
+constexpr size_t GetMaxUtf8Length(const size_t units) noexcept {
+    return units * (sizeof(wchar_t) == 2 ? 3 : 4);
+}
+
+/// Writes `text` to `out` as wide code units and returns how many were written; `out` must hold
+/// GetMaxWideLength(text.size()). Malformed sequences become U+FFFD, one per maximal invalid
+/// subsequence. Runs of ASCII are widened 16 bytes at a time with SSE2 where available.
+size_t DecodeUtf8(std::string_view text, wchar_t* out) noexcept;
+
+/// Writes `text` to `out` as UTF-8 and returns the byte count; `out` must hold
+/// GetMaxUtf8Length(text.size()). Unpaired surrogates and values past U+10FFFF become U+FFFD.
+size_t EncodeUtf8(std::wstring_view text, char* out) noexcept;
+
+/// Appends UTF-8 `text` to any wide string type, std::pmr::wstring included.
+template<typename TWideString>
+void AppendWide(const std::string_view text, TWideString& out) {
+    const size_t start = out.size();
+    out.resize(start + GetMaxWideLength(text.size()));
+    out.resize(start + DecodeUtf8(text, out.data() + start));
+}
+
+/// Appends wide `text` to any narrow string type as UTF-8.
+template<typename TString>
+void AppendUtf8(const std::wstring_view text, TString& out) {
+    const size_t start = out.size();
+    out.resize(start + GetMaxUtf8Length(text.size()));
+    out.resize(start + EncodeUtf8(text, out.data() + start));
+}
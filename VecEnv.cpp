@@ -0,0 +1,160 @@
+//
+// VecEnv.cpp - Batched Pong environments for training paddle agents
+//
+
+#include "VecEnv.h"
+
+#include <stdexcept>
+
+namespace {
+    // Normalises ball velocities; serves start at 600 and the ball tops out at 1500
+    constexpr float kVelocityScale = 1.f / 1500.f;
+
+    constexpr float kHalfWidth  = kCourtWidth * 0.5f;
+    constexpr float kHalfHeight = kCourtHeight * 0.5f;
+}  // namespace
+
+struct VecEnv::Env {
+    explicit Env(const SimOptions& options)
+        : sim(nullptr, options), paddles(sim.GetWorld()), balls(sim.GetWorld()) {}
+
+    Sim sim;
+    Query<const Transform, const Paddle> paddles;
+    Query<const Transform, const Velocity, const Ball> balls;
+    uint32_t seed  = 0;  // of the match in progress
+    uint32_t ticks = 0;
+};
+
+VecEnv::VecEnv(const VecEnvOptions& options) : m_Options(options) {
+    if (options.ticksPerStep == 0 || options.maxTicks == 0 || options.pointsToWin <= 0)
+        throw std::invalid_argument("VecEnv needs at least one tick per step and a match limit");
+}
+
+VecEnv::~VecEnv() = default;
+
+void VecEnv::Reset(const uint32_t envCount, const std::span<float> observations) {
+    if (observations.size() != size_t {envCount} * GetAgentsPerEnv() * kObservationSize)
+        throw std::invalid_argument("Observation buffer does not match the agent count");
+
+    while (m_Envs.size() < envCount)
+        m_Envs.push_back(std::make_unique<Env>(GetSimOptions(m_Options.seed)));
+    m_EnvCount = envCount;
+
+    for (uint32_t i = 0; i < envCount; ++i) {
+        m_Envs[i]->seed = m_Options.seed + i;
+        ResetEnv(*m_Envs[i]);
+    }
+    m_FullBrickCount = envCount ? m_Envs[0]->sim.GetBrickCount() : 0;
+
+    const uint32_t agentsPerEnv = GetAgentsPerEnv();
+    for (uint32_t i = 0; i < envCount; ++i)
+        Observe(*m_Envs[i], observations.data() + size_t {i} * agentsPerEnv * kObservationSize);
+}
+
+void VecEnv::Step(const std::span<const float> actions,
+                  const std::span<float> observations,
+                  const std::span<float> rewards,
+                  const std::span<uint8_t> dones) {
+    const uint32_t agents = GetAgentCount();
+    if (actions.size() != agents || rewards.size() != agents || dones.size() != agents ||
+        observations.size() != size_t {agents} * kObservationSize)
+        throw std::invalid_argument("Step buffers do not match the agent count");
+
+    const uint32_t agentsPerEnv = GetAgentsPerEnv();
+    for (uint32_t i = 0; i < m_EnvCount; ++i) {
+        Env& env             = *m_Envs[i];
+        const uint32_t agent = i * agentsPerEnv;
+        const SimInput input = {actions[agent], m_Options.selfPlay ? actions[agent + 1] : 0.f};
+        const Score before   = env.sim.GetScore();
+
+        bool done = false;
+        for (uint32_t tick = 0; tick < m_Options.ticksPerStep && !done; ++tick) {
+            env.sim.Step(input, kTick);
+            ++env.ticks;
+            done = IsMatchOver(env);
+        }
+
+        const Score& after = env.sim.GetScore();
+        const auto reward  = static_cast<float>((after.left - before.left) -
+                                               (after.right - before.right));
+        rewards[agent]     = reward;
+        dones[agent]       = done;
+        if (m_Options.selfPlay) {
+            rewards[agent + 1] = -reward;
+            dones[agent + 1]   = done;
+        }
+
+        if (done) {
+            env.seed += m_EnvCount;
+            ResetEnv(env);
+            ++m_FinishedMatches;
+        }
+        Observe(env, observations.data() + size_t {agent} * kObservationSize);
+    }
+}
+
+bool VecEnv::IsMatchOver(const Env& env) const noexcept {
+    const Score& score = env.sim.GetScore();
+    return env.ticks >= m_Options.maxTicks || score.left >= m_Options.pointsToWin ||
+           score.right >= m_Options.pointsToWin;
+}
+
+SimOptions VecEnv::GetSimOptions(const uint32_t seed) const noexcept {
+    SimOptions options;
+    options.leftAi   = false;
+    options.rightAi  = !m_Options.selfPlay;
+    options.seed     = seed;
+    options.breakout = m_Options.breakout;
+    return options;
+}
+
+void VecEnv::ResetEnv(Env& env) {
+    env.sim.Reset(GetSimOptions(env.seed));
+    env.ticks = 0;
+}
+
+void VecEnv::Observe(Env& env, float* pObservations) const {
+    float leftY  = 0.f;
+    float rightY = 0.f;
+    env.paddles.ForEach([&](const Transform& transform, const Paddle& paddle) {
+        (paddle.side == Side::Left ? leftY : rightY) = transform.y / kHalfHeight - 1.f;
+    });
+
+    Transform ball        = {kHalfWidth, kHalfHeight};
+    Velocity ballVelocity = {0.f, 0.f};
+    env.balls.ForEach([&](const Transform& transform, const Velocity& velocity, const Ball&) {
+        ball         = transform;
+        ballVelocity = velocity;
+    });
+
+    const float bricks = m_FullBrickCount ? static_cast<float>(env.sim.GetBrickCount()) /
+                                              static_cast<float>(m_FullBrickCount)
+                                          : 0.f;
+    const float time   = static_cast<float>(env.ticks) / static_cast<float>(m_Options.maxTicks);
+    const float ballX  = ball.x / kHalfWidth - 1.f;
+    const float ballY  = ball.y / kHalfHeight - 1.f;
+
+    float* p = pObservations;
+    p[0]     = leftY;
+    p[1]     = rightY;
+    p[2]     = ballX;
+    p[3]     = ballY;
+    p[4]     = ballVelocity.x * kVelocityScale;
+    p[5]     = ballVelocity.y * kVelocityScale;
+    p[6]     = bricks;
+    p[7]     = time;
+    if (!m_Options.selfPlay)
+        return;
+
+    // The right agent's view, mirrored so that it too defends the left edge
+    p += kObservationSize;
+
+    p[0] = rightY;
+    p[1] = leftY;
+    p[2] = -ballX;
+    p[3] = ballY;
+    p[4] = -ballVelocity.x * kVelocityScale;
+    p[5] = ballVelocity.y * kVelocityScale;
+    p[6] = bricks;
+    p[7] = time;
+}
@@ -0,0 +1,97 @@
+//
+// VecEnv.h - Batched Pong environments for training paddle agents
+//
+// A gym-style interface over many independent Sims stepped together: Reset and Step read
+// actions from, and write observations, rewards and done flags to, contiguous buffers the caller
+// owns, laid out agent-major so they can be handed to a training framework without copying.
+// After the first Reset of a given size, neither allocates.
+//
+// One VecEnv steps its environments on the calling thread; to use more cores, run one VecEnv per
+// thread with disjoint seeds.
+//
+
+#pragma once
+
+#include "Ecs.h"
+#include "Sim.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+struct VecEnvOptions {
+    bool selfPlay         = true;  // an agent on each side; otherwise the right paddle is the AI
+    bool breakout         = false;
+    uint32_t seed         = 1;  // env i serves from seed + i, then continues the sequence
+    int pointsToWin       = 5;
+    uint32_t maxTicks     = 120 * 120;  // matches are cut short after two minutes of sim time
+    uint32_t ticksPerStep = 4;          // sim ticks per Step, each with the same action
+};
+
+class VecEnv {
+public:
+    /// Floats per agent observation. Every agent sees the court as if it were the left paddle,
+    /// mirrored horizontally for the right one, with positions scaled to -1..1:
+    ///  0: own paddle y         1: opponent paddle y
+    ///  2: ball x               3: ball y
+    ///  4: ball x velocity      5: ball y velocity, as fractions of the maximum ball speed
+    ///  6: bricks left, as a fraction of a full set (0 outside breakout)
+    ///  7: match time used, as a fraction of maxTicks
+    static constexpr uint32_t kObservationSize = 8;
+
+    /// The sim tick each Step advances by ticksPerStep times.
+    static constexpr float kTick = 1.f / 120.f;
+
+    explicit VecEnv(const VecEnvOptions& options = {});
+    ~VecEnv();
+
+    VecEnv(VecEnv const&)            = delete;
+    VecEnv& operator=(VecEnv const&) = delete;
+
+    /// Starts a new match in each of `envCount` environments and writes every agent's first
+    /// observation: GetAgentCount() * kObservationSize floats. Environments are created only when
+    /// the count grows.
+    void Reset(uint32_t envCount, std::span<float> observations);
+
+    /// Holds each agent's action, a paddle axis from -1 (up) to 1 (down), for ticksPerStep ticks.
+    /// Rewards are +1 per point the agent wins and -1 per point it loses. A match that ends in
+    /// the step, by reaching pointsToWin or maxTicks, sets its agents' done flags and restarts at
+    /// once, so their observations are the new match's first. Agent 2i is environment i's left
+    /// paddle and, in self play, agent 2i + 1 its right; otherwise agent i is the left paddle.
+    /// Throws std::invalid_argument if a buffer has the wrong size.
+    void Step(std::span<const float> actions,
+              std::span<float> observations,
+              std::span<float> rewards,
+              std::span<uint8_t> dones);
+
+    uint32_t GetEnvCount() const noexcept {
+        return m_EnvCount;
+    }
+    uint32_t GetAgentsPerEnv() const noexcept {
+        return m_Options.selfPlay ? 2 : 1;
+    }
+    uint32_t GetAgentCount() const noexcept {
+        return m_EnvCount * GetAgentsPerEnv();
+    }
+
+    /// Matches finished since construction, by either limit.
+    uint64_t GetFinishedMatchCount() const noexcept {
+        return m_FinishedMatches;
+    }
+
+private:
+    struct Env;
+
+    bool IsMatchOver(const Env& env) const noexcept;
+    /// Options for an environment's Sim: agents on the paddles they control, the AI elsewhere.
+    SimOptions GetSimOptions(uint32_t seed) const noexcept;
+    void ResetEnv(Env& env);
+    void Observe(Env& env, float* pObservations) const;
+
+    VecEnvOptions m_Options;
+    std::vector<std::unique_ptr<Env>> m_Envs;  // Sims and queries stay put as the batch grows
+    uint32_t m_EnvCount        = 0;
+    uint64_t m_FinishedMatches = 0;
+    uint32_t m_FullBrickCount  = 0;
+};
@@ -0,0 +1,101 @@
+//
+// WavFile.cpp - 16-bit PCM WAV output for headless audio
+//
+
+#include "WavFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    constexpr uint32_t kHeaderSize     = 44;
+    constexpr uint32_t kBytesPerSample = 2;
+
+    // WAV is little-endian whatever the host is
+    void Put16(std::byte* p, const uint32_t value) noexcept {
+        p[0] = static_cast<std::byte>(value);
+        p[1] = static_cast<std::byte>(value >> 8);
+    }
+
+    void Put32(std::byte* p, const uint32_t value) noexcept {
+        Put16(p, value);
+        Put16(p + 2, value >> 16);
+    }
+
+    void PutTag(std::byte* p, const char (&tag)[5]) noexcept {
+        for (int i = 0; i < 4; ++i)
+            p[i] = static_cast<std::byte>(tag[i]);
+    }
+
+    void MakeHeader(std::byte* header,
+                    const uint32_t sampleRate,
+                    const uint32_t channels,
+                    const uint32_t dataSize) noexcept {
+        PutTag(header, "RIFF");
+        Put32(header + 4, kHeaderSize - 8 + dataSize);
+        PutTag(header + 8, "WAVE");
+        PutTag(header + 12, "fmt ");
+        Put32(header + 16, 16);
+        Put16(header + 20, 1);  // PCM
+        Put16(header + 22, channels);
+        Put32(header + 24, sampleRate);
+        Put32(header + 28, sampleRate * channels * kBytesPerSample);
+        Put16(header + 32, channels * kBytesPerSample);
+        Put16(header + 34, kBytesPerSample * 8);
+        PutTag(header + 36, "data");
+        Put32(header + 40, dataSize);
+    }
+}  // namespace
+
+WavWriter::WavWriter(const std::filesystem::path& path,
+                     const uint32_t sampleRate,
+                     const uint32_t channels)
+    : m_Path(path), m_SampleRate(sampleRate), m_Channels(channels) {
+    if (sampleRate == 0 || channels == 0)
+        throw std::invalid_argument("WAV files need a sample rate and at least one channel");
+    m_File.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_File)
+        throw std::runtime_error("Failed to create " + path.string());
+
+    // Sizes are zero until Close rewrites the header
+    std::byte header[kHeaderSize];
+    MakeHeader(header, sampleRate, channels, 0);
+    m_File.write(reinterpret_cast<const char*>(header), kHeaderSize);
+}
+
+WavWriter::~WavWriter() {
+    if (m_File.is_open()) {
+        try {
+            Close();
+        } catch (const std::exception&) {
+        }
+    }
+}
+
+void WavWriter::Write(const std::span<const float> samples) {
+    m_Buffer.resize(samples.size() * kBytesPerSample);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const float sample = std::clamp(samples[i], -1.f, 1.f);
+        const auto value   = static_cast<int32_t>(std::lround(sample * 32767.f));
+        Put16(&m_Buffer[i * kBytesPerSample], static_cast<uint32_t>(value));
+    }
+    m_File.write(reinterpret_cast<const char*>(m_Buffer.data()),
+                 static_cast<std::streamsize>(m_Buffer.size()));
+    if (!m_File)
+        throw std::runtime_error("Failed to write " + m_Path.string());
+    m_SampleCount += samples.size();
+}
+
+void WavWriter::Close() {
+    const uint64_t dataSize = m_SampleCount * kBytesPerSample;
+    std::byte header[kHeaderSize];
+    MakeHeader(header, m_SampleRate, m_Channels, static_cast<uint32_t>(dataSize));
+    m_File.seekp(0);
+    m_File.write(reinterpret_cast<const char*>(header), kHeaderSize);
+    m_File.close();
+    if (!m_File)
+        throw std::runtime_error("Failed to finish " + m_Path.string());
+    if (dataSize > UINT32_MAX - kHeaderSize)
+        throw std::runtime_error(m_Path.string() + " is too long for a WAV file");
+}
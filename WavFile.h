@@ -0,0 +1,41 @@
+//
+// WavFile.h - 16-bit PCM WAV output for headless audio
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+/// Streams interleaved float samples to a WAV file. The header's sizes are filled in by Close.
+class WavWriter {
+public:
+    /// Creates `path`. Throws std::runtime_error if it cannot be created.
+    WavWriter(const std::filesystem::path& path, uint32_t sampleRate, uint32_t channels);
+    /// Closes the file if Close has not been called, ignoring errors.
+    ~WavWriter();
+
+    WavWriter(WavWriter const&)            = delete;
+    WavWriter& operator=(WavWriter const&) = delete;
+
+    /// Appends samples, clamped to [-1, 1] and rounded to 16 bits.
+    void Write(std::span<const float> samples);
+
+    /// Completes the header and closes the file. Throws std::runtime_error on failure.
+    void Close();
+
+    uint64_t GetFrameCount() const noexcept {
+        return m_SampleCount / m_Channels;
+    }
+
+private:
+    std::filesystem::path m_Path;
+    std::ofstream m_File;
+    uint32_t m_SampleRate;
+    uint32_t m_Channels;
+    uint64_t m_SampleCount = 0;
+    std::vector<std::byte> m_Buffer;
+};
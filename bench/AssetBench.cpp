@@ -0,0 +1,218 @@
+//
+// AssetBench.cpp - Startup cost of loose data/ files versus the mapped asset pack
+//
+// Usage: PongAssetBench <data dir> <data.pak> [iterations]
+//
+// Each iteration performs the full startup load: every asset is opened and its bytes touched
+// (hashed), as the renderer would when creating textures and fonts. The loose and pack loads
+// cover the entries that also exist under the data dir; build outputs such as the .ptex textures
+// are only in the pack.
+//
+// The texture section compares decoding paddle/ball PNGs at runtime against viewing the
+// pre-converted .ptex entries in place, when the pack contains them.
+//
+// The decode section compares time-to-first-frame when PNG decoding and font parsing happen on
+// the frame thread before rendering starts against kicking them off on the AssetLoader.
+//
+
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "FontFile.h"
+#include "Hash.h"
+#include "Png.h"
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t LoadLoose(const std::filesystem::path& dir, const std::vector<std::string>& names) {
+        uint64_t hash = 0;
+        std::vector<std::byte> buffer;
+        for (const auto& name : names) {
+            FILE* file = std::fopen((dir / name).string().c_str(), "rb");
+            if (!file)
+                throw std::runtime_error("Missing loose asset " + name);
+            std::fseek(file, 0, SEEK_END);
+            buffer.resize(static_cast<size_t>(std::ftell(file)));
+            std::fseek(file, 0, SEEK_SET);
+            const size_t read = std::fread(buffer.data(), 1, buffer.size(), file);
+            std::fclose(file);
+            if (read != buffer.size())
+                throw std::runtime_error("Short read on loose asset " + name);
+            hash ^= Hash::Fnv1a(buffer);
+        }
+        return hash;
+    }
+
+    uint64_t LoadPack(const std::filesystem::path& path, const std::vector<std::string>& names) {
+        AssetPack pack;
+        pack.Open(path);
+
+        uint64_t hash = 0;
+        for (const auto& name : names) {
+            const PackEntry* entry = pack.Find(name);
+            if (!entry)
+                throw std::runtime_error("Missing packed asset " + name);
+            if (entry->flags & kPackEntryCompressed)
+                hash ^= Hash::Fnv1a(pack.Read(*entry));
+            else
+                hash ^= Hash::Fnv1a(pack.GetStoredBytes(*entry));
+        }
+        return hash;
+    }
+
+    uint64_t DecodeAsset(const AssetPack& pack, const std::string& name) {
+        std::vector<std::byte> scratch;
+        const auto bytes = pack.Load(name, scratch);
+        if (name.ends_with(".png"))
+            return DecodePng(bytes).pixels.size();
+        if (name.ends_with(".font"))
+            return ParseFont(bytes).glyphs.size();
+        return bytes.size();
+    }
+
+    uint64_t DecodeSync(const AssetPack& pack, const std::vector<std::string>& names) {
+        uint64_t total = 0;
+        for (const auto& name : names)
+            total += DecodeAsset(pack, name);
+        return total;
+    }
+
+    std::vector<AssetHandle<uint64_t>> DecodeAsync(AssetLoader& loader,
+                                                   const AssetPack& pack,
+                                                   const std::vector<std::string>& names) {
+        std::vector<AssetHandle<uint64_t>> handles;
+        handles.reserve(names.size());
+        for (const auto& name : names)
+            handles.push_back(loader.Load([&pack, name] { return DecodeAsset(pack, name); }));
+        return handles;
+    }
+
+    template<typename TLoad>
+    void Measure(const char* label, const int iterations, const TLoad& load) {
+        std::vector<double> samples;
+        samples.reserve(static_cast<size_t>(iterations));
+
+        uint64_t sink = load();  // warm the page cache
+        for (int i = 0; i < iterations; ++i) {
+            const auto start = Clock::now();
+            sink ^= load();
+            const std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+            samples.push_back(elapsed.count());
+        }
+
+        std::sort(samples.begin(), samples.end());
+        std::printf("%-6s min %9.2f us  median %9.2f us  p90 %9.2f us  (%016llx)\n",
+                    label,
+                    samples.front(),
+                    samples[samples.size() / 2],
+                    samples[samples.size() * 9 / 10],
+                    static_cast<unsigned long long>(sink));
+    }
+
+    // Reports both the time until the frame thread is free to render (kickoff) and the time until
+    // every asset is ready.
+    template<typename TKickoff>
+    void MeasureAsync(const int iterations, const TKickoff& kickoff) {
+        std::vector<double> kickoffSamples;
+        std::vector<double> readySamples;
+
+        for (int i = 0; i < iterations; ++i) {
+            const auto start   = Clock::now();
+            const auto handles = kickoff();
+            const std::chrono::duration<double, std::micro> kicked = Clock::now() - start;
+            for (const auto& handle : handles)
+                handle.Get();
+            const std::chrono::duration<double, std::micro> ready = Clock::now() - start;
+
+            kickoffSamples.push_back(kicked.count());
+            readySamples.push_back(ready.count());
+        }
+
+        for (auto* samples : {&kickoffSamples, &readySamples})
+            std::sort(samples->begin(), samples->end());
+        std::printf("%-6s min %9.2f us  median %9.2f us  (all ready: median %9.2f us)\n",
+                    "async",
+                    kickoffSamples.front(),
+                    kickoffSamples[kickoffSamples.size() / 2],
+                    readySamples[readySamples.size() / 2]);
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <data dir> <data.pak> [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    const std::filesystem::path dataDir = argv[1];
+    const std::filesystem::path pakPath = argv[2];
+    const int iterations                = argc > 3 ? std::max(1, std::atoi(argv[3])) : 200;
+
+    try {
+        std::vector<std::string> names;
+        std::vector<std::string> looseNames;
+        {
+            AssetPack pack;
+            pack.Open(pakPath);
+            for (const auto& entry : pack.GetEntries()) {
+                const std::string& name = names.emplace_back(pack.GetName(entry));
+                if (std::filesystem::is_regular_file(dataDir / name))
+                    looseNames.push_back(name);
+            }
+        }
+        if (looseNames.empty())
+            throw std::runtime_error("No packed asset found in " + dataDir.string());
+
+        std::printf("%zu assets, %zu of them loose, %d iterations\n",
+                    names.size(),
+                    looseNames.size(),
+                    iterations);
+        Measure("loose", iterations, [&] { return LoadLoose(dataDir, looseNames); });
+        Measure("pack", iterations, [&] { return LoadPack(pakPath, looseNames); });
+
+        AssetPack pack;
+        pack.Open(pakPath);
+
+        if (pack.Find("paddle.ptex") && pack.Find("ball.ptex")) {
+            std::printf("\ntextures\n");
+            Measure("png", iterations, [&] {
+                std::vector<std::byte> scratch;
+                uint64_t hash = 0;
+                for (const char* name : {"paddle.png", "ball.png"}) {
+                    const auto image = DecodePng(pack.Load(name, scratch));
+                    hash ^= Hash::Fnv1a(ConvertImage(image, false).owned);
+                }
+                return hash;
+            });
+            Measure("ptex", iterations, [&] {
+                uint64_t hash = 0;
+                for (const char* name : {"paddle", "ball"})
+                    hash ^= Hash::Fnv1a(LoadPackedTexture(pack, name).GetMip(0));
+                return hash;
+            });
+        }
+
+        JobSystem jobs;
+        AssetLoader loader(jobs);
+
+        std::printf("\ntime to first frame, %u workers\n", jobs.GetWorkerCount());
+        Measure("sync", iterations, [&] { return DecodeSync(pack, names); });
+        MeasureAsync(iterations, [&] { return DecodeAsync(loader, pack, names); });
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "PongAssetBench: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
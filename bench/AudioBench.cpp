@@ -0,0 +1,132 @@
+//
+// AudioBench.cpp - Mixer throughput and a headless WAV render of an AI match
+//
+// Usage: PongAudioBench [seconds] [out.wav]
+//
+// Throughput: keeps 1 to 256 voices of a 44.1 kHz clip playing at assorted pitches, so every
+// voice is resampled to the mixer's 48 kHz, and mixes `seconds` of audio (10 by default) as
+// fast as one thread can. Voices per core is how many voices one core could mix in real time.
+//
+// With an output path, also plays an AI-vs-AI match for `seconds` through the full pipeline:
+// the sim's events post commands to the mixer, the AudioThread mixes into an AudioRing, and the
+// main thread drains the ring into a WAV file as a sound device would.
+//
+
+#include "AudioMixer.h"
+#include "AudioRing.h"
+#include "Sim.h"
+#include "Sounds.h"
+#include "WavFile.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t kSampleRate  = 48000;
+    constexpr uint32_t kBlockFrames = 256;
+    constexpr uint32_t kTickRate    = 120;
+
+    AudioClip MakeTone(const uint32_t sampleRate, const float seconds) {
+        std::vector<float> samples(static_cast<size_t>(seconds * static_cast<float>(sampleRate)));
+        for (size_t i = 0; i < samples.size(); ++i)
+            samples[i] = 0.1f * std::sin(static_cast<float>(i) * 0.0627f);
+        return MakeClip(sampleRate, std::move(samples));
+    }
+
+    /// Mixes `seconds` of audio with `voices` voices always playing; returns the wall time.
+    double MixSeconds(const AudioClip& clip,
+                      const uint32_t voices,
+                      const int seconds,
+                      float& checksum) {
+        AudioMixer mixer(kSampleRate, voices);
+        std::vector<float> block(size_t {kBlockFrames} * AudioMixer::kChannels);
+        const uint64_t blocks = uint64_t {kSampleRate} * seconds / kBlockFrames;
+
+        // Producer and consumer share this thread here, which the queue allows as long as they
+        // never run at the same time
+        uint32_t played  = 0;
+        checksum         = 0.f;
+        const auto start = Clock::now();
+        for (uint64_t i = 0; i < blocks; ++i) {
+            for (uint32_t voice = mixer.GetActiveVoiceCount(); voice < voices; ++voice)
+                mixer.Play(clip, 0.5f, 0.5f + static_cast<float>(played++ % 16) * 0.1f);
+            mixer.Mix(block.data(), kBlockFrames);
+            checksum += block[i % block.size()];
+        }
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+        return elapsed.count();
+    }
+
+    /// Plays an AI match through the mixer thread and writes what it hears to `path`.
+    void RenderMatch(const char* path, const int seconds) {
+        AudioMixer mixer(kSampleRate, 32);
+        AudioRing ring(8192);
+        const CourtSounds sounds(kSampleRate);
+        SimOptions simOptions;
+        simOptions.leftAi = true;
+        Sim sim(nullptr, simOptions);
+        WavWriter wav(path, kSampleRate, AudioMixer::kChannels);
+
+        AudioThread thread(mixer, ring, kBlockFrames);
+        std::vector<float> tick(size_t {kSampleRate / kTickRate} * AudioMixer::kChannels);
+        for (uint32_t step = 0; step < seconds * kTickRate; ++step) {
+            sim.Step({}, 1.f / kTickRate);
+            sounds.Emit(mixer, sim);
+
+            // Take one tick's worth of samples, waiting for the mixer when the ring runs dry
+            uint32_t read = 0;
+            while (read < tick.size()) {
+                read += ring.Read(tick.data() + read, static_cast<uint32_t>(tick.size()) - read);
+                thread.Wake();
+                if (read < tick.size())
+                    std::this_thread::yield();
+            }
+            wav.Write(tick);
+        }
+        wav.Close();
+
+        const Score& score = sim.GetScore();
+        std::printf("wrote %s: %d s, score %d-%d, %u commands dropped\n",
+                    path,
+                    seconds,
+                    score.left,
+                    score.right,
+                    mixer.GetDroppedCommandCount());
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int seconds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10;
+
+    const AudioClip clip = MakeTone(44100, 4.f);
+    std::printf("mixing %d s at %u Hz, %u-frame blocks\n", seconds, kSampleRate, kBlockFrames);
+    std::printf("  voices  realtime x  ns/voice-frame  voices/core\n");
+    for (const uint32_t voices : {1u, 16u, 64u, 256u}) {
+        float checksum        = 0.f;
+        const double elapsed  = MixSeconds(clip, voices, seconds, checksum);
+        const double realtime = seconds / elapsed;
+        std::printf("  %6u  %10.1f  %14.2f  %11.0f  (%.3f)\n",
+                    voices,
+                    realtime,
+                    elapsed * 1e9 / (static_cast<double>(kSampleRate) * seconds * voices),
+                    realtime * voices,
+                    checksum);
+    }
+
+    if (argc > 2) {
+        try {
+            RenderMatch(argv[2], seconds);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+    }
+    return 0;
+}
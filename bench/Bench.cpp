@@ -0,0 +1,718 @@
+//
+// Bench.cpp - Microbenchmarks of the per-frame code paths, with JSON output to diff
+//
+// Usage: PongBench [out.json|-] [repetitions] [filter]
+//
+// Covers sim stepping and snapshots, collision, HUD formatting, UTF conversion, .font parsing,
+// software sprite blitting and the allocators. Each benchmark is warmed up for at least
+// kWarmupTime while its batch size doubles until one batch takes kMinSampleTime, then that batch
+// is timed `repetitions` times. Reported per operation: the median, the median absolute deviation
+// (MAD) and the fastest sample. Only benchmarks whose name contains `filter` run.
+//
+// The JSON file holds one benchmark per line in a fixed order, so the output of two commits can
+// be compared with a plain diff.
+//
+
+#include "CollisionMask.h"
+#include "Effects.h"
+#include "FontFile.h"
+#include "FrameArena.h"
+#include "ObjectPool.h"
+#include "Palette.h"
+#include "RenderList.h"
+#include "Sim.h"
+#include "SoftwareRenderer.h"
+#include "TextureFile.h"
+#include "UniformGrid.h"
+#include "Utf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <version>
+#ifdef __cpp_lib_format
+    #include <format>
+    #include <iterator>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::chrono::milliseconds kWarmupTime(200);
+    constexpr std::chrono::milliseconds kMinSampleTime(10);
+    constexpr int kDefaultRepetitions = 15;
+
+    constexpr float kTick      = 1.f / 120.f;
+    constexpr uint32_t kWidth  = 1280;
+    constexpr uint32_t kHeight = 720;
+
+    /// Runs `count` operations and returns something derived from their results, which is kept
+    /// so the work cannot be optimized away.
+    using BenchFunc = std::function<uint64_t(uint32_t count)>;
+
+    struct Benchmark {
+        const char* name;
+        std::function<BenchFunc()> setup;  // only called if the benchmark runs
+    };
+
+    struct Result {
+        const char* name;
+        uint32_t batch;
+        double median;  // nanoseconds per operation
+        double mad;
+        double min;
+    };
+
+    volatile uint64_t g_Sink = 0;
+
+    double GetMedian(std::vector<double> values) {
+        const size_t middle = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + middle, values.end());
+        if (values.size() % 2)
+            return values[middle];
+        const double below = *std::max_element(values.begin(), values.begin() + middle);
+        return (below + values[middle]) * 0.5;
+    }
+
+    Result Measure(const char* name, const BenchFunc& run, const int repetitions) {
+        const auto time = [&](const uint32_t batch) {
+            const auto start = Clock::now();
+            g_Sink           = g_Sink + run(batch);
+            return Clock::now() - start;
+        };
+
+        uint32_t batch       = 1;
+        const auto warmupEnd = Clock::now() + kWarmupTime;
+        for (;;) {
+            const bool tooShort = time(batch) < kMinSampleTime;
+            if (!tooShort && Clock::now() >= warmupEnd)
+                break;
+            if (tooShort && batch < (1u << 30))
+                batch *= 2;
+        }
+
+        std::vector<double> samples(static_cast<size_t>(repetitions));
+        for (double& sample : samples) {
+            const std::chrono::duration<double, std::nano> elapsed = time(batch);
+            sample = elapsed.count() / batch;
+        }
+
+        const double median = GetMedian(samples);
+        std::vector<double> deviations(samples.size());
+        std::transform(samples.begin(), samples.end(), deviations.begin(), [&](const double s) {
+            return s > median ? s - median : median - s;
+        });
+        return {name,
+                batch,
+                median,
+                GetMedian(std::move(deviations)),
+                *std::min_element(samples.begin(), samples.end())};
+    }
+
+    /// Solid where a rounded rectangle with corner `radius` covers the pixel centre.
+    CollisionMask MakeRoundedRect(const uint32_t width, const uint32_t height, const float r) {
+        const auto w = static_cast<float>(width);
+        const auto h = static_cast<float>(height);
+
+        CollisionMask mask(width, height);
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                const float px = static_cast<float>(x) + 0.5f;
+                const float py = static_cast<float>(y) + 0.5f;
+                const float dx = px - std::clamp(px, r, w - r);
+                const float dy = py - std::clamp(py, r, h - r);
+                if (dx * dx + dy * dy <= r * r)
+                    mask.Set(x, y);
+            }
+        }
+        return mask;
+    }
+
+    /// The AI on both paddles.
+    SimOptions GetAiMatchOptions(const bool breakout) {
+        SimOptions options;
+        options.leftAi   = true;
+        options.breakout = breakout;
+        return options;
+    }
+
+    /// One step of an AI match. Breakout matches restart once every brick is broken, so the
+    /// cost does not drift as the walls empty.
+    BenchFunc StepSim(const bool breakout, const bool masks) {
+        const SimOptions options = GetAiMatchOptions(breakout);
+        auto pSim                = std::make_shared<Sim>(nullptr, options);
+        if (masks) {
+            pSim->SetCollisionMask(kSpritePaddle,
+                                   std::make_shared<const CollisionMask>(
+                                     MakeRoundedRect(32, 200, 12.f)));
+            pSim->SetCollisionMask(
+              kSpriteBall, std::make_shared<const CollisionMask>(MakeRoundedRect(32, 32, 16.f)));
+        }
+        return [pSim, options](const uint32_t count) {
+            uint64_t events = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                pSim->Step({}, kTick);
+                events += pSim->GetEvents().size();
+                if (options.breakout && pSim->GetBrickCount() == 0)
+                    pSim->Reset(options);
+            }
+            return events;
+        };
+    }
+
+    /// Saving a mid-match snapshot, or restoring it into the same match, as a rollback would
+    /// every frame.
+    BenchFunc SnapshotSim(const bool breakout, const bool restore) {
+        auto pSim      = std::make_shared<Sim>(nullptr, GetAiMatchOptions(breakout));
+        auto pSnapshot = std::make_shared<std::vector<std::byte>>();
+        for (uint32_t tick = 0; tick < 3000; ++tick)
+            pSim->Step({}, kTick);
+        pSim->SaveSnapshot(*pSnapshot);
+
+        if (restore) {
+            return [pSim, pSnapshot](const uint32_t count) {
+                for (uint32_t i = 0; i < count; ++i)
+                    pSim->RestoreSnapshot(*pSnapshot);
+                return uint64_t {pSim->GetBrickCount()};
+            };
+        }
+        return [pSim, pSnapshot](const uint32_t count) {
+            uint64_t bytes = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                pSim->SaveSnapshot(*pSnapshot);
+                bytes += pSnapshot->size();
+            }
+            return bytes;
+        };
+    }
+
+    struct Offset {
+        int32_t x, y;
+    };
+
+    /// Ball placements whose box overlaps the paddle's, as the narrow phase sees them.
+    std::vector<Offset> MakeOverlaps() {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int32_t> x(-31, 31);
+        std::uniform_int_distribution<int32_t> y(-31, 199);
+        std::vector<Offset> offsets(256);
+        for (auto& offset : offsets)
+            offset = {x(rng), y(rng)};
+        return offsets;
+    }
+
+    template<bool kCount>
+    BenchFunc TestMasks() {
+        auto pPaddle = std::make_shared<CollisionMask>(MakeRoundedRect(32, 200, 12.f));
+        auto pBall   = std::make_shared<CollisionMask>(MakeRoundedRect(32, 32, 16.f));
+        return [pPaddle, pBall, offsets = MakeOverlaps()](const uint32_t count) {
+            uint64_t result = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                const Offset& o = offsets[i % offsets.size()];
+                if constexpr (kCount)
+                    result += CollisionMask::CountOverlap(*pPaddle, 0, 0, *pBall, o.x, o.y);
+                else
+                    result += CollisionMask::Overlaps(*pPaddle, 0, 0, *pBall, o.x, o.y);
+            }
+            return result;
+        };
+    }
+
+    /// One frame's ball path through a full breakout field of 16 x 16 bricks.
+    BenchFunc SweepGrid() {
+        auto pGrid = std::make_shared<UniformGrid>(0.f, 0.f, 32.f, 40, 23);
+        std::vector<GridBox> boxes;
+        for (float x = 240.f; x < 1040.f; x += 20.f) {
+            for (float y = 0.f; y < kCourtHeight; y += 20.f)
+                boxes.push_back({x + 2.f, y + 2.f, x + 18.f, y + 18.f});
+        }
+        pGrid->Build(boxes, kBallSize * 0.5f);
+
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> px(240.f, 1040.f);
+        std::uniform_real_distribution<float> py(0.f, kCourtHeight);
+        std::uniform_real_distribution<float> step(-1500.f / 120.f, 1500.f / 120.f);
+        std::vector<GridBox> paths(256);
+        for (auto& path : paths) {
+            path.minX = px(rng);
+            path.minY = py(rng);
+            path.maxX = path.minX + step(rng);
+            path.maxY = path.minY + step(rng);
+        }
+
+        return [pGrid, paths](const uint32_t count) {
+            uint64_t candidates = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                const GridBox& path = paths[i % paths.size()];
+                pGrid->Traverse(
+                  path.minX, path.minY, path.maxX, path.maxY, [&](const auto items, float, float) {
+                      candidates += items.size();
+                      return true;
+                  });
+            }
+            return candidates;
+        };
+    }
+
+    /// Values for one frame of HUD text; they change every frame as in the game.
+    struct HudValues {
+        int left, right;
+        float frameRate;
+        float arenaUsed, arenaPeak;
+        uint32_t tick;
+        float latency;
+    };
+
+    HudValues GetHudValues(const uint32_t frame) {
+        const auto f = static_cast<float>(frame % 1000);
+        return {static_cast<int>(frame % 11), static_cast<int>(frame % 7), 59.f + f * 0.002f,
+                1.5f + f * 0.001f, 3.25f, frame, 8.f + f * 0.01f};
+    }
+
+#ifdef __cpp_lib_format
+    /// The HUD lines Game::Render formats each frame, into strings on a FrameArena.
+    BenchFunc FormatHud() {
+        auto pArena = std::make_shared<FrameArena>(64 * 1024);
+        return [pArena](const uint32_t count) {
+            uint64_t length = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                pArena->BeginFrame();
+                const HudValues v = GetHudValues(i);
+                std::pmr::wstring score(pArena.get());
+                std::format_to(std::back_inserter(score), L"{}   {}", v.left, v.right);
+                std::pmr::wstring fps(pArena.get());
+                std::format_to(std::back_inserter(fps), L"fRate: {:.2f}", v.frameRate);
+                std::pmr::wstring frameTime(pArena.get());
+                std::format_to(
+                  std::back_inserter(frameTime), L"fTime: {:.2f} ms", 1000.f / v.frameRate);
+                std::pmr::wstring arena(pArena.get());
+                std::format_to(std::back_inserter(arena),
+                               L"arena: {:.1f}/{} KB, peak {:.1f} KB, overflow {:.1f} KB",
+                               v.arenaUsed,
+                               256,
+                               v.arenaPeak,
+                               0.f);
+                std::pmr::wstring ticks(pArena.get());
+                std::format_to(std::back_inserter(ticks), L"tick: {}", v.tick);
+                std::pmr::wstring latency(pArena.get());
+                std::format_to(std::back_inserter(latency),
+                               L"input to sim p50/p99: {:.1f}/{:.1f} ms, "
+                               L"to present {:.1f}/{:.1f} ms",
+                               v.latency * 0.5f,
+                               v.latency,
+                               v.latency * 2.f,
+                               v.latency * 3.f);
+                length += score.size() + fps.size() + frameTime.size() + arena.size() +
+                          ticks.size() + latency.size();
+            }
+            return length;
+        };
+    }
+#endif
+
+    /// The same lines with swprintf, for toolchains without <format>.
+    BenchFunc PrintHud() {
+        auto pArena = std::make_shared<FrameArena>(64 * 1024);
+        return [pArena](const uint32_t count) {
+            uint64_t length = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                pArena->BeginFrame();
+                const HudValues v  = GetHudValues(i);
+                const auto printTo = [&](const wchar_t* format, const auto... args) {
+                    std::pmr::wstring text(128, L'\0', pArena.get());
+                    const int written = std::swprintf(text.data(), text.size(), format, args...);
+                    text.resize(written > 0 ? static_cast<size_t>(written) : 0);
+                    length += text.size();
+                };
+                printTo(L"%d   %d", v.left, v.right);
+                printTo(L"fRate: %.2f", static_cast<double>(v.frameRate));
+                printTo(L"fTime: %.2f ms", 1000.0 / v.frameRate);
+                printTo(L"arena: %.1f/%d KB, peak %.1f KB, overflow %.1f KB",
+                        static_cast<double>(v.arenaUsed),
+                        256,
+                        static_cast<double>(v.arenaPeak),
+                        0.0);
+                printTo(L"tick: %u", v.tick);
+                printTo(L"input to sim p50/p99: %.1f/%.1f ms, to present %.1f/%.1f ms",
+                        v.latency * 0.5,
+                        static_cast<double>(v.latency),
+                        v.latency * 2.0,
+                        v.latency * 3.0);
+            }
+            return length;
+        };
+    }
+
+    constexpr std::string_view kAsciiText =
+      "WARNING: Asset reload failed: Font file is truncated (data/chakra_24.font)";
+    constexpr std::string_view kMixedText =
+      "Sp\xC3\xA4tzle \xE2\x80\x94 \xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E \xD0\xBF\xD1\x80\xD0\xB8"
+      "\xD0\xB2\xD0\xB5\xD1\x82 \xF0\x9F\x8F\x93 caf\xC3\xA9 na\xC3\xAFve r\xC3\xA9sum\xC3\xA9";
+
+    BenchFunc Decode(const std::string_view text) {
+        return [text, wide = std::wstring()](const uint32_t count) mutable {
+            uint64_t length = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                wide.clear();
+                AppendWide(text, wide);
+                length += wide.size();
+            }
+            return length;
+        };
+    }
+
+    BenchFunc Encode(const std::string_view text) {
+        std::wstring wide;
+        AppendWide(text, wide);
+        return [wide, utf8 = std::string()](const uint32_t count) mutable {
+            uint64_t length = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                utf8.clear();
+                AppendUtf8(wide, utf8);
+                length += utf8.size();
+            }
+            return length;
+        };
+    }
+
+    /// A .font file laid out like data/chakra_24.font: 95 ASCII glyphs and a 256 x 148 BC2
+    /// atlas.
+    std::vector<std::byte> MakeFontFile() {
+        std::vector<std::byte> file;
+        const auto append = [&](const auto& value) {
+            const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+            file.insert(file.end(), bytes, bytes + sizeof(value));
+        };
+
+        file.resize(8);
+        std::memcpy(file.data(), "DXTKfont", 8);
+        append(uint32_t {95});
+        for (uint32_t c = 32; c < 127; ++c) {
+            const auto column = static_cast<int32_t>(c % 16) * 16;
+            const auto row    = static_cast<int32_t>(c / 16) * 24;
+            append(FontGlyph {c, column, row, column + 14, row + 24, 0.f, 6.f, 15.f});
+        }
+        append(41.6f);
+        append(uint32_t {0});
+        for (const uint32_t value : {256u, 148u, 74u, 1024u, 37u})
+            append(value);
+        file.resize(file.size() + 1024 * 37, std::byte {0x55});
+        return file;
+    }
+
+    BenchFunc ParseFontFile() {
+        return [file = MakeFontFile()](const uint32_t count) {
+            uint64_t glyphs = 0;
+            for (uint32_t i = 0; i < count; ++i)
+                glyphs += ParseFont(file).glyphs.size();
+            return glyphs;
+        };
+    }
+
+    /// Glyph lookups for a line of HUD text, as SpriteFont does when drawing the score.
+    BenchFunc FindGlyphs() {
+        auto pFont = std::make_shared<FontData>(ParseFont(MakeFontFile()));
+        std::wstring text;
+        AppendWide(kMixedText, text);
+        return [pFont, text](const uint32_t count) {
+            uint64_t advance = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                for (const wchar_t c : text) {
+                    const FontGlyph* pGlyph = pFont->FindGlyph(static_cast<uint32_t>(c));
+                    advance += pGlyph ? static_cast<uint64_t>(pGlyph->xAdvance) : 1;
+                }
+            }
+            return advance;
+        };
+    }
+
+    /// A premultiplied texture of a solid rounded rectangle with a soft edge.
+    TextureData MakeTexture(const uint32_t width, const uint32_t height, const float radius) {
+        Image image {width, height, std::vector<uint8_t>(size_t {width} * height * 4)};
+        const auto w = static_cast<float>(width);
+        const auto h = static_cast<float>(height);
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                const float px   = static_cast<float>(x) + 0.5f;
+                const float py   = static_cast<float>(y) + 0.5f;
+                const float dx   = px - std::clamp(px, radius, w - radius);
+                const float dy   = py - std::clamp(py, radius, h - radius);
+                const float edge = radius - std::sqrt(dx * dx + dy * dy);
+                uint8_t* pPixel  = &image.pixels[(size_t {y} * width + x) * 4];
+                pPixel[0]        = 0xF0;
+                pPixel[1]        = 0xF0;
+                pPixel[2]        = 0xFF;
+                pPixel[3]        = static_cast<uint8_t>(std::clamp(edge, 0.f, 1.f) * 255.f);
+            }
+        }
+        return ConvertImage(image, true);
+    }
+
+    struct RenderState {
+        SoftwareRenderer renderer {kWidth, kHeight};
+        TextureData paddle = MakeTexture(64, 400, 24.f);
+        TextureData ball   = MakeTexture(64, 64, 32.f);
+    };
+
+    template<typename TDraw>
+    BenchFunc Render(const TDraw& draw) {
+        auto pState = std::make_shared<RenderState>();
+        return [pState, draw](const uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i)
+                draw(*pState, i);
+            return uint64_t {pState->renderer.GetPixels()[kWidth * kHeight / 2]};
+        };
+    }
+
+    struct CourtState : RenderState {
+        Sim sim {nullptr, GetAiMatchOptions(true)};
+        CourtEffects effects;
+        RenderList list;
+    };
+
+    /// Two seconds into a breakout match, with sparks and a trail to draw.
+    std::shared_ptr<CourtState> MakeCourtState() {
+        auto pState = std::make_shared<CourtState>();
+        for (int step = 0; step < 240; ++step) {
+            pState->sim.Step({}, kTick);
+            pState->effects.Emit(pState->sim);
+            pState->effects.Update(kTick);
+        }
+        return pState;
+    }
+
+    /// Recording a frame of the court into a render list, which the game does every update.
+    BenchFunc RecordCourtList() {
+        auto pState = MakeCourtState();
+        return [pState](const uint32_t count) {
+            uint64_t commands = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                RecordCourt(pState->list, pState->sim, &pState->effects);
+                commands += pState->list.GetCommands().size();
+            }
+            return commands;
+        };
+    }
+
+    /// A whole frame of the court, recorded and drawn.
+    BenchFunc DrawCourt() {
+        auto pState = MakeCourtState();
+        return [pState](const uint32_t count) {
+            const CourtTextures textures = {&pState->paddle, &pState->ball};
+            for (uint32_t i = 0; i < count; ++i)
+                pState->renderer.DrawCourt(pState->sim, &pState->effects, textures);
+            return uint64_t {pState->renderer.GetPixels()[kWidth * kHeight / 2]};
+        };
+    }
+
+    constexpr uint32_t kAllocationsPerFrame = 64;
+
+    /// Sizes of a frame's transient allocations: mostly small strings and arrays.
+    std::vector<uint32_t> MakeAllocationSizes() {
+        std::mt19937 rng(3);
+        std::uniform_int_distribution<uint32_t> size(16, 512);
+        std::vector<uint32_t> sizes(kAllocationsPerFrame);
+        for (auto& s : sizes)
+            s = size(rng);
+        return sizes;
+    }
+
+    /// One frame of transient allocations from the FrameArena.
+    BenchFunc AllocateFromArena() {
+        auto pArena = std::make_shared<FrameArena>(64 * 1024);
+        return [pArena, sizes = MakeAllocationSizes()](const uint32_t count) {
+            uint64_t touched = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                pArena->BeginFrame();
+                for (const uint32_t size : sizes) {
+                    auto* p = static_cast<std::byte*>(pArena->Allocate(size));
+                    p[0]    = std::byte {1};
+                    touched += static_cast<uint64_t>(p[0]);
+                }
+            }
+            return touched;
+        };
+    }
+
+    /// The same frame from the heap, freed at the end of the frame.
+    BenchFunc AllocateFromHeap() {
+        return [sizes = MakeAllocationSizes(), blocks = std::vector<std::byte*>()](
+                 const uint32_t count) mutable {
+            uint64_t touched = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                for (const uint32_t size : sizes) {
+                    blocks.push_back(new std::byte[size]);
+                    blocks.back()[0] = std::byte {1};
+                    touched += static_cast<uint64_t>(blocks.back()[0]);
+                }
+                for (std::byte* p : blocks)
+                    delete[] p;
+                blocks.clear();
+            }
+            return touched;
+        };
+    }
+
+    struct Spark {
+        float x, y;
+        float vx, vy;
+        float life;
+        uint32_t color;
+    };
+
+    /// Destroying a random live object and creating a replacement, as effects churn.
+    BenchFunc ChurnPool() {
+        auto pPool = std::make_shared<ObjectPool<Spark>>(1024);
+        while (pPool->GetSize() < 1024)
+            pPool->Create(Spark {0.f, 0.f, 1.f, 1.f, 1.f, 0});
+        return [pPool, rng = std::minstd_rand(5)](const uint32_t count) mutable {
+            uint64_t live = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                pPool->Destroy(pPool->GetHandle(rng() % pPool->GetSize()));
+                pPool->Create(Spark {static_cast<float>(i), 0.f, 1.f, 1.f, 1.f, 0});
+                live += pPool->GetSize();
+            }
+            return live;
+        };
+    }
+
+    BenchFunc ChurnHeap() {
+        auto pSparks = std::make_shared<std::vector<std::unique_ptr<Spark>>>();
+        while (pSparks->size() < 1024)
+            pSparks->push_back(std::make_unique<Spark>(Spark {0.f, 0.f, 1.f, 1.f, 1.f, 0}));
+        return [pSparks, rng = std::minstd_rand(5)](const uint32_t count) mutable {
+            auto& sparks  = *pSparks;
+            uint64_t live = 0;
+            for (uint32_t i = 0; i < count; ++i) {
+                sparks[rng() % sparks.size()] = std::move(sparks.back());
+                sparks.pop_back();
+                sparks.push_back(
+                  std::make_unique<Spark>(Spark {static_cast<float>(i), 0.f, 1.f, 1.f, 1.f, 0}));
+                live += sparks.size();
+            }
+            return live;
+        };
+    }
+
+    std::vector<Benchmark> GetBenchmarks() {
+        return {
+          {"sim/step-pong", [] { return StepSim(false, false); }},
+          {"sim/step-pong-masks", [] { return StepSim(false, true); }},
+          {"sim/step-breakout", [] { return StepSim(true, false); }},
+          {"sim/save-pong", [] { return SnapshotSim(false, false); }},
+          {"sim/restore-pong", [] { return SnapshotSim(false, true); }},
+          {"sim/save-breakout", [] { return SnapshotSim(true, false); }},
+          {"sim/restore-breakout", [] { return SnapshotSim(true, true); }},
+          {"collision/mask-overlaps", [] { return TestMasks<false>(); }},
+          {"collision/mask-count", [] { return TestMasks<true>(); }},
+          {"collision/grid-sweep", [] { return SweepGrid(); }},
+#ifdef __cpp_lib_format
+          {"hud/format", [] { return FormatHud(); }},
+#endif
+          {"hud/swprintf", [] { return PrintHud(); }},
+          {"utf/decode-ascii", [] { return Decode(kAsciiText); }},
+          {"utf/decode-mixed", [] { return Decode(kMixedText); }},
+          {"utf/encode-ascii", [] { return Encode(kAsciiText); }},
+          {"utf/encode-mixed", [] { return Encode(kMixedText); }},
+          {"font/parse", [] { return ParseFontFile(); }},
+          {"font/find-glyphs", [] { return FindGlyphs(); }},
+          {"render/clear",
+           [] {
+               return Render([](RenderState& s, uint32_t) { s.renderer.Clear(kClearColor); });
+           }},
+          {"render/fill-rect",
+           [] {
+               return Render([](RenderState& s, const uint32_t i) {
+                   const auto x = static_cast<float>(i % 1000);
+                   s.renderer.FillRect(x, 100.f, x + 32.f, 300.f, 0x80FFFFFF);
+               });
+           }},
+          {"render/blit-ball",
+           [] {
+               return Render([](RenderState& s, const uint32_t i) {
+                   const auto x = static_cast<float>(i % 1000) + 0.25f;
+                   s.renderer.DrawTexture(s.ball, x, 300.f, x + 32.f, 332.f);
+               });
+           }},
+          {"render/blit-paddle",
+           [] {
+               return Render([](RenderState& s, const uint32_t i) {
+                   const auto y = static_cast<float>(i % 500) + 0.25f;
+                   s.renderer.DrawTexture(s.paddle, 40.f, y, 72.f, y + 200.f);
+               });
+           }},
+          {"render/record-court", [] { return RecordCourtList(); }},
+          {"render/court", [] { return DrawCourt(); }},
+          {"alloc/frame-arena", [] { return AllocateFromArena(); }},
+          {"alloc/heap", [] { return AllocateFromHeap(); }},
+          {"alloc/pool-churn", [] { return ChurnPool(); }},
+          {"alloc/unique-ptr-churn", [] { return ChurnHeap(); }},
+        };
+    }
+
+    bool WriteJson(const char* path, const int repetitions, const std::vector<Result>& results) {
+        FILE* pFile = std::fopen(path, "w");
+        if (!pFile)
+            return false;
+        std::fprintf(pFile, "{\n  \"repetitions\": %d,\n  \"benchmarks\": [\n", repetitions);
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            std::fprintf(pFile,
+                         "    {\"name\": \"%s\", \"batch\": %u, \"median_ns\": %.3f, "
+                         "\"mad_ns\": %.3f, \"min_ns\": %.3f}%s\n",
+                         r.name,
+                         r.batch,
+                         r.median,
+                         r.mad,
+                         r.min,
+                         i + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(pFile, "  ]\n}\n");
+        return std::fclose(pFile) == 0;
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* jsonPath  = argc > 1 && std::strcmp(argv[1], "-") != 0 ? argv[1] : nullptr;
+    const int repetitions = argc > 2 ? std::max(3, std::atoi(argv[2])) : kDefaultRepetitions;
+    const char* filter    = argc > 3 ? argv[3] : "";
+
+    std::printf("%-26s %12s %10s %7s %12s %10s\n",
+                "benchmark",
+                "median ns",
+                "MAD ns",
+                "MAD %",
+                "min ns",
+                "batch");
+    std::vector<Result> results;
+    for (const Benchmark& benchmark : GetBenchmarks()) {
+        if (!std::strstr(benchmark.name, filter))
+            continue;
+        const Result r = Measure(benchmark.name, benchmark.setup(), repetitions);
+        std::printf("%-26s %12.1f %10.2f %6.1f%% %12.1f %10u\n",
+                    r.name,
+                    r.median,
+                    r.mad,
+                    r.median > 0.0 ? r.mad / r.median * 100.0 : 0.0,
+                    r.min,
+                    r.batch);
+        std::fflush(stdout);
+        results.push_back(r);
+    }
+
+    if (jsonPath && !WriteJson(jsonPath, repetitions, results)) {
+        std::fprintf(stderr, "Failed to write %s\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
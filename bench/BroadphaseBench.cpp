@@ -0,0 +1,189 @@
+//
+// BroadphaseBench.cpp - Swept ball vs brick cost with and without the uniform grid
+//
+// Usage: PongBroadphaseBench [rounds]
+//
+// Bricks fill the area between the paddles at increasing density. Each round restores every
+// brick, then sweeps a ball along random one-frame paths, breaking the first brick each path
+// hits. Compared: testing every live brick, and walking the grid cells along the path. Both
+// break the same bricks, which the checksum confirms.
+//
+
+#include "UniformGrid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr float kCourtWidth   = 1280.f;
+    constexpr float kCourtHeight  = 720.f;
+    constexpr float kFieldMinX    = 240.f;
+    constexpr float kFieldMaxX    = 1040.f;
+    constexpr float kBallHalfSize = 16.f;
+    constexpr float kMaxStep      = 1500.f / 60.f;  // fastest ball over one frame
+    constexpr float kCellSize     = 16.f;
+    constexpr int kSweepsPerRound = 1000;
+
+    struct Path {
+        float x, y, dx, dy;
+    };
+
+    // First touch of the ball's box moving along `path`, as in Sim's brick collision
+    float Sweep(const Path& path, const GridBox& box) {
+        float tEnter    = -1.f;
+        float tExit     = 2.f;
+        const auto slab = [&](const float start,
+                              const float delta,
+                              const float lo,
+                              const float hi) {
+            if (delta == 0.f)
+                return start > lo && start < hi;
+            tEnter = std::max(tEnter, ((delta > 0.f ? lo : hi) - start) / delta);
+            tExit  = std::min(tExit, ((delta > 0.f ? hi : lo) - start) / delta);
+            return true;
+        };
+        if (!slab(path.x, path.dx, box.minX - kBallHalfSize, box.maxX + kBallHalfSize) ||
+            !slab(path.y, path.dy, box.minY - kBallHalfSize, box.maxY + kBallHalfSize))
+            return 2.f;
+        return tEnter >= 0.f && tEnter < tExit ? tEnter : 2.f;
+    }
+
+    std::vector<GridBox> MakeBricks(const uint32_t columns, const uint32_t rows) {
+        const float width  = (kFieldMaxX - kFieldMinX) / static_cast<float>(columns);
+        const float height = kCourtHeight / static_cast<float>(rows);
+        std::vector<GridBox> bricks;
+        for (uint32_t row = 0; row < rows; ++row) {
+            for (uint32_t column = 0; column < columns; ++column) {
+                const float x = kFieldMinX + width * static_cast<float>(column);
+                const float y = height * static_cast<float>(row);
+                bricks.push_back({x, y, x + width, y + height});
+            }
+        }
+        return bricks;
+    }
+
+    // Paths keep the ball inside the court, as the walls do in the game
+    std::vector<Path> MakePaths(const size_t count) {
+        uint32_t state = 1;
+        const auto unit = [&] {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / 16777216.f;
+        };
+
+        constexpr float kMargin = kBallHalfSize + kMaxStep;
+        std::vector<Path> paths(count);
+        for (Path& path : paths)
+            path = {kMargin + unit() * (kCourtWidth - kMargin * 2.f),
+                    kMargin + unit() * (kCourtHeight - kMargin * 2.f),
+                    (unit() * 2.f - 1.f) * kMaxStep,
+                    (unit() * 2.f - 1.f) * kMaxStep};
+        return paths;
+    }
+
+    // Earliest hit first; ties, such as two bricks sharing an edge, go to the lower index
+    bool IsEarlier(const float t, const uint32_t item, const float firstT, const uint32_t first) {
+        return t < 1.f && (t < firstT || (t == firstT && item < first));
+    }
+
+    struct Result {
+        double nsPerSweep;
+        uint64_t checksum;
+    };
+
+    // sweep(path) breaks and returns the first brick hit, or UINT32_MAX
+    template<typename TRestore, typename TSweep>
+    Result Run(const std::vector<Path>& paths,
+               const int rounds,
+               const TRestore& restore,
+               const TSweep& sweep) {
+        Clock::duration elapsed {};
+        uint64_t checksum = 0;
+        for (int round = 0; round < rounds; ++round) {
+            restore();
+            const auto start = Clock::now();
+            for (int i = 0; i < kSweepsPerRound; ++i) {
+                const uint32_t hit = sweep(paths[static_cast<size_t>(round) * kSweepsPerRound + i]);
+                checksum           = checksum * 31 + hit;
+            }
+            elapsed += Clock::now() - start;
+        }
+
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        return {ns / (static_cast<double>(rounds) * kSweepsPerRound), checksum};
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int rounds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100;
+    const auto paths = MakePaths(size_t {static_cast<uint32_t>(rounds)} * kSweepsPerRound);
+    std::printf("%d sweeps per size\n", rounds * kSweepsPerRound);
+
+    const uint32_t sizes[][2] = {{32, 30}, {64, 60}, {128, 120}, {256, 240}};
+    for (const auto& [columns, rows] : sizes) {
+        const std::vector<GridBox> bricks = MakeBricks(columns, rows);
+
+        std::vector<bool> live;
+        const Result brute = Run(
+          paths,
+          rounds,
+          [&] { live.assign(bricks.size(), true); },
+          [&](const Path& path) {
+              float firstT   = 1.f;
+              uint32_t first = UINT32_MAX;
+              for (uint32_t i = 0; i < bricks.size(); ++i) {
+                  const float t = live[i] ? Sweep(path, bricks[i]) : 2.f;
+                  if (IsEarlier(t, i, firstT, first)) {
+                      firstT = t;
+                      first  = i;
+                  }
+              }
+              if (first != UINT32_MAX)
+                  live[first] = false;
+              return first;
+          });
+
+        UniformGrid grid(0.f,
+                         0.f,
+                         kCellSize,
+                         static_cast<uint32_t>(kCourtWidth / kCellSize),
+                         static_cast<uint32_t>(kCourtHeight / kCellSize));
+        const Result gridded = Run(
+          paths,
+          rounds,
+          [&] { grid.Build(bricks, kBallHalfSize); },
+          [&](const Path& path) {
+              float firstT   = 1.f;
+              uint32_t first = UINT32_MAX;
+              grid.Traverse(path.x,
+                            path.y,
+                            path.x + path.dx,
+                            path.y + path.dy,
+                            [&](const std::span<const uint32_t> items, float, const float tExit) {
+                                for (const uint32_t item : items) {
+                                    const float t = Sweep(path, bricks[item]);
+                                    if (IsEarlier(t, item, firstT, first)) {
+                                        firstT = t;
+                                        first  = item;
+                                    }
+                                }
+                                return first == UINT32_MAX || firstT >= tExit;
+                            });
+              if (first != UINT32_MAX)
+                  grid.Remove(first);
+              return first;
+          });
+
+        std::printf("%6zu bricks  brute %9.1f ns/sweep  grid %7.1f ns/sweep  %s\n",
+                    bricks.size(),
+                    brute.nsPerSweep,
+                    gridded.nsPerSweep,
+                    brute.checksum == gridded.checksum ? "match" : "MISMATCH");
+    }
+
+    return 0;
+}
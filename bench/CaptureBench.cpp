@@ -0,0 +1,134 @@
+//
+// CaptureBench.cpp - Frame capture at a paced frame rate, as the game drives it
+//
+// Usage: PongCaptureBench <out dir> [seconds] [fps]
+//
+// Renders an AI match at 1280x720 with SoftwareRenderer and submits one frame every 1/fps
+// seconds (60 by default) to a FrameCapture for `seconds` (5 by default): first to
+// <out dir>/capture.y4m, then as a PNG sequence in <out dir>/png. Reports how long Submit holds
+// the rendering thread, how many frames were dropped because the writer fell behind, and how
+// long the writer took to finish once capture stopped.
+//
+// Submit only copies the frame into a free buffer, about 0.3 ms at 720p. The writer runs below
+// normal priority, but on a single core it still gets time slices while Submit is running, and
+// those show up in the p99.
+//
+
+#include "Effects.h"
+#include "FrameCapture.h"
+#include "Sim.h"
+#include "SoftwareRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t kWidth    = 1280;
+    constexpr uint32_t kHeight   = 720;
+    constexpr uint32_t kTickRate = 120;
+
+    /// Captures `seconds` of paced frames and prints one line of results.
+    void Capture(const CaptureOptions& options, const char* label, const int seconds) {
+        SimOptions simOptions;
+        simOptions.leftAi = true;
+        Sim sim(nullptr, simOptions);
+        CourtEffects effects;
+        SoftwareRenderer renderer(kWidth, kHeight);
+
+        const uint32_t frames        = static_cast<uint32_t>(seconds) * options.frameRate;
+        const uint32_t ticksPerFrame = std::max(1u, kTickRate / options.frameRate);
+        const auto period            = std::chrono::nanoseconds(1'000'000'000 / options.frameRate);
+        std::vector<float> submitUs;
+        submitUs.reserve(frames);
+
+        std::optional<FrameCapture> capture(std::in_place, options);
+        auto deadline = Clock::now();
+        for (uint32_t frame = 0; frame < frames; ++frame) {
+            for (uint32_t tick = 0; tick < ticksPerFrame; ++tick) {
+                sim.Step({}, 1.f / kTickRate);
+                effects.Emit(sim);
+            }
+            effects.Update(static_cast<float>(ticksPerFrame) / kTickRate);
+            renderer.DrawCourt(sim, &effects, {});
+
+            const auto submitStart = Clock::now();
+            capture->Submit(renderer.GetPixels().data(), kWidth * sizeof(uint32_t));
+            const std::chrono::duration<float, std::micro> elapsed = Clock::now() - submitStart;
+            submitUs.push_back(elapsed.count());
+
+            deadline += period;
+            std::this_thread::sleep_until(deadline);
+        }
+
+        const CaptureStats stats = capture->GetStats();
+        const auto error         = capture->GetError();
+        const auto drainStart    = Clock::now();
+        capture.reset();
+        const std::chrono::duration<double, std::milli> drain = Clock::now() - drainStart;
+        if (error)
+            throw std::runtime_error(*error);
+
+        std::sort(submitUs.begin(), submitUs.end());
+        std::printf("%-12s %6u frames  %6llu dropped  submit p50 %7.1f us  p99 %7.1f us  max "
+                    "%7.1f us  drain %7.1f ms\n",
+                    label,
+                    frames,
+                    static_cast<unsigned long long>(stats.dropped),
+                    submitUs[submitUs.size() / 2],
+                    submitUs[submitUs.size() * 99 / 100],
+                    submitUs.back(),
+                    drain.count());
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <out dir> [seconds] [fps]\n", argv[0]);
+        return 1;
+    }
+    const std::filesystem::path out = argv[1];
+    const int seconds               = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+    const int fps                   = argc > 3 ? std::clamp(std::atoi(argv[3]), 1, 1000) : 60;
+
+    try {
+        std::filesystem::create_directories(out);
+
+        CaptureOptions options;
+        options.width     = kWidth;
+        options.height    = kHeight;
+        options.frameRate = static_cast<uint32_t>(fps);
+
+        const unsigned cores = std::thread::hardware_concurrency();
+        std::printf("capturing %d s at %d fps, %ux%u, %u PNG encoders, %u hardware threads\n",
+                    seconds,
+                    fps,
+                    kWidth,
+                    kHeight,
+                    options.encoders,
+                    cores);
+        if (cores < 2)
+            std::printf("no spare core: submit times include slices the writer takes from the "
+                        "rendering thread\n");
+        options.format = CaptureFormat::Y4m;
+        options.path   = out / "capture.y4m";
+        Capture(options, "y4m", seconds);
+
+        options.format = CaptureFormat::PngSequence;
+        options.path   = out / "png";
+        Capture(options, "png", seconds);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+//
+// EnvBench.cpp - VecEnv throughput in environment steps per second per core
+//
+// Usage: PongEnvBench [steps] [threads]
+//
+// Steps self-play VecEnvs of 1 to 1024 environments `steps` times, with every agent following
+// the ball the way a trained policy might, and reports environment steps, agent steps and sim
+// ticks per second along with the matches finished and the heap allocations Step made after a
+// warm-up. Then runs one 256-environment VecEnv per thread on `threads` threads (the hardware
+// thread count by default) to show how the batch scales across cores.
+//
+// By default the timed steps cover a whole match at the time limit, so every environment
+// finishes one and restarts while timed. Exits with 2 if a run finished no match or Step
+// allocated after the warm-up.
+//
+
+#include "VecEnv.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Per thread, so a run on one thread does not see another setting up its environments
+    thread_local uint64_t g_Allocations = 0;
+}  // namespace
+
+void* operator new(const size_t size) {
+    ++g_Allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t kLargeBatch = 256;
+
+    // Steps before timing, long enough for every kind of event to have grown its buffers
+    constexpr uint32_t kWarmUpSteps = 500;
+
+    struct Buffers {
+        std::vector<float> actions;
+        std::vector<float> observations;
+        std::vector<float> rewards;
+        std::vector<uint8_t> dones;
+
+        explicit Buffers(const uint32_t agents)
+            : actions(agents),
+              observations(size_t {agents} * VecEnv::kObservationSize),
+              rewards(agents),
+              dones(agents) {}
+    };
+
+    struct Result {
+        double seconds       = 0.0;
+        uint64_t allocations = 0;
+        uint64_t matches     = 0;
+        float rewardSum      = 0.f;  // zero-sum in self play; printed so the work is not elided
+    };
+
+    /// Moves every paddle towards the ball, from each agent's own point of view.
+    void Act(Buffers& buffers) {
+        for (size_t agent = 0; agent < buffers.actions.size(); ++agent) {
+            const float* pObservation = &buffers.observations[agent * VecEnv::kObservationSize];
+            const float offset        = pObservation[3] - pObservation[0];  // ball y - own y
+            buffers.actions[agent]    = std::clamp(offset * 8.f, -1.f, 1.f);
+        }
+    }
+
+    Result Run(const uint32_t envs, const uint32_t steps, const uint32_t seed) {
+        VecEnvOptions options;
+        options.seed = seed;
+        VecEnv env(options);
+        Buffers buffers(envs * env.GetAgentsPerEnv());
+        env.Reset(envs, buffers.observations);
+        for (uint32_t step = 0; step < kWarmUpSteps; ++step) {
+            Act(buffers);
+            env.Step(buffers.actions, buffers.observations, buffers.rewards, buffers.dones);
+        }
+
+        Result result;
+        const uint64_t matches     = env.GetFinishedMatchCount();
+        const uint64_t allocations = g_Allocations;
+        const auto start           = Clock::now();
+        for (uint32_t step = 0; step < steps; ++step) {
+            Act(buffers);
+            env.Step(buffers.actions, buffers.observations, buffers.rewards, buffers.dones);
+            result.rewardSum += buffers.rewards[0];
+        }
+        result.seconds     = std::chrono::duration<double>(Clock::now() - start).count();
+        result.allocations = g_Allocations - allocations;
+        result.matches     = env.GetFinishedMatchCount() - matches;
+        return result;
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    const VecEnvOptions defaults;
+    const uint32_t hardware     = std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t matchSteps   = defaults.maxTicks / defaults.ticksPerStep;
+    const uint32_t steps        = argc > 1 ? std::max(1, std::atoi(argv[1])) : matchSteps;
+    const uint32_t threads      = argc > 2 ? std::max(1, std::atoi(argv[2])) : hardware;
+    const uint32_t ticksPerStep = defaults.ticksPerStep;
+    bool regressed              = false;
+
+    std::printf("self play, %u sim ticks per step, %u steps\n", ticksPerStep, steps);
+    std::printf("    envs   env-steps/s  agent-steps/s   sim ticks/s  matches  allocations\n");
+    for (const uint32_t envs : {1u, 16u, 256u, 1024u}) {
+        const Result result   = Run(envs, steps, 1);
+        const double envSteps = static_cast<double>(envs) * steps / result.seconds;
+        std::printf("  %6u  %12.0f  %13.0f  %12.0f  %7llu  %11llu  (%.0f)\n",
+                    envs,
+                    envSteps,
+                    envSteps * 2.0,
+                    envSteps * ticksPerStep,
+                    static_cast<unsigned long long>(result.matches),
+                    static_cast<unsigned long long>(result.allocations),
+                    result.rewardSum);
+        regressed |= result.matches == 0 || result.allocations != 0;
+    }
+
+    // One VecEnv per thread, with disjoint seeds
+    std::vector<Result> results(threads);
+    std::vector<std::thread> workers;
+    const auto start = Clock::now();
+    for (uint32_t thread = 0; thread < threads; ++thread)
+        workers.emplace_back([&, thread] {
+            results[thread] = Run(kLargeBatch, steps, 1 + thread * kLargeBatch);
+        });
+    for (auto& worker : workers)
+        worker.join();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (const Result& result : results)
+        regressed |= result.matches == 0 || result.allocations != 0;
+
+    const double envSteps = static_cast<double>(threads) * kLargeBatch * steps / seconds;
+    const uint32_t cores  = std::min(threads, hardware);
+    std::printf("\n%u threads x %u envs: %.0f env-steps/s, %.0f per core (%u cores)\n",
+                threads,
+                kLargeBatch,
+                envSteps,
+                envSteps / cores,
+                cores);
+
+    if (regressed) {
+        std::fprintf(stderr, "A run finished no match or allocated while stepping\n");
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+//
+// LatencyBench.cpp - Headless input-to-frame latency with synthetic input
+//
+// Usage: PongLatencyBench [seconds] [fps] [data.pak]
+//
+// Runs the game's frame loop without a window: an injector thread presses and releases the left
+// paddle's keys at random intervals, stamping and tracing every event as the window procedure
+// would, while the main thread runs the sim in fixed 120 Hz ticks and draws each frame with the
+// software renderer at the given rate (60 by default). A frame counts as submitted once its
+// pixels have been copied out of the framebuffer. Sprites are drawn as placeholders unless a
+// pack with the paddle and ball textures is given.
+//
+// Reports the latency from each event's timestamp to the end of the tick that applied it, to
+// the end of the first frame drawn after that, and to its submission.
+//
+
+#include "AssetPack.h"
+#include "Effects.h"
+#include "Input.h"
+#include "JobSystem.h"
+#include "LatencyTracer.h"
+#include "Sim.h"
+#include "SoftwareRenderer.h"
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::chrono::nanoseconds kTick(1'000'000'000 / 120);
+    constexpr float kTickSeconds         = std::chrono::duration<float>(kTick).count();
+    constexpr uint32_t kMaxTicksPerFrame = 12;
+    constexpr uint32_t kWidth            = 1280;
+    constexpr uint32_t kHeight           = 720;
+
+    /// Toggles a random one of the left paddle's keys every 15 to 90 ms until `stop` is set.
+    void InjectInput(InputQueue& queue,
+                     LatencyTracer& tracer,
+                     const std::atomic<bool>& stop,
+                     uint64_t& dropped) {
+        uint32_t state  = 1;
+        const auto next = [&] {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8;
+        };
+
+        bool held[2] = {};
+        while (!stop.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(15 + next() % 76));
+
+            const uint32_t key = next() % 2;
+            held[key]          = !held[key];
+            const InputEvent event {GetInputTime(),
+                                    key ? InputAction::LeftDown : InputAction::LeftUp,
+                                    held[key],
+                                    tracer.NextId()};
+            if (!queue.TryPush(event))
+                dropped++;
+        }
+    }
+
+    void PrintSummary(const char* stage, const LatencySummary& summary) {
+        std::printf("  %-10s %6u  %7.2f  %7.2f  %7.2f  %7.2f  %7.2f\n",
+                    stage,
+                    summary.count,
+                    summary.mean,
+                    summary.p50,
+                    summary.p90,
+                    summary.p99,
+                    summary.max);
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int seconds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10;
+    const int fps     = argc > 2 ? std::max(1, std::atoi(argv[2])) : 60;
+
+    std::optional<TextureData> paddle;
+    std::optional<TextureData> ball;
+    AssetPack pack;
+    if (argc > 3) {
+        try {
+            pack.Open(argv[3]);
+            paddle = LoadPackedTexture(pack, "paddle");
+            ball   = LoadPackedTexture(pack, "ball");
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+    }
+    const CourtTextures textures = {paddle ? &*paddle : nullptr, ball ? &*ball : nullptr};
+
+    JobSystem jobs;
+    Sim sim(&jobs);
+    CourtEffects effects;
+    SoftwareRenderer renderer(kWidth, kHeight);
+    std::vector<uint32_t> submitted(renderer.GetPixels().size());
+
+    InputQueue queue;
+    InputTimeline timeline(kTick);
+    LatencyTracer tracer(LatencyStage::Submitted, 1 << 16);
+    std::vector<double> renderMs;
+
+    std::atomic<bool> stop = false;
+    uint64_t dropped       = 0;
+    timeline.Start(GetInputTime());
+    std::thread injector([&] { InjectInput(queue, tracer, stop, dropped); });
+
+    const auto frameLength =
+      std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    const float frameSeconds = 1.f / static_cast<float>(fps);
+    const auto end           = Clock::now() + std::chrono::seconds(seconds);
+    auto nextFrame           = Clock::now();
+    while (Clock::now() < end) {
+        const uint32_t ticks = timeline.GetDueTicks(GetInputTime(), kMaxTicksPerFrame);
+        for (uint32_t tick = 0; tick < ticks; ++tick) {
+            sim.Step(timeline.NextTick(queue, &tracer), kTickSeconds);
+            effects.Emit(sim);
+            tracer.Mark(LatencyStage::Simulated, GetInputTime());
+        }
+        effects.Update(frameSeconds, &jobs);
+
+        const auto renderStart = Clock::now();
+        renderer.DrawCourt(sim, &effects, textures);
+        tracer.Mark(LatencyStage::Rendered, GetInputTime());
+        std::copy(renderer.GetPixels().begin(), renderer.GetPixels().end(), submitted.begin());
+        tracer.Mark(LatencyStage::Submitted, GetInputTime());
+        const std::chrono::duration<double, std::milli> renderTime = Clock::now() - renderStart;
+        renderMs.push_back(renderTime.count());
+
+        nextFrame += frameLength;
+        std::this_thread::sleep_until(nextFrame);
+    }
+
+    stop = true;
+    injector.join();
+
+    std::sort(renderMs.begin(), renderMs.end());
+    std::printf("%d s at %d fps, %zu frames, %llu inputs traced (%zu pending, %llu dropped)\n",
+                seconds,
+                fps,
+                renderMs.size(),
+                static_cast<unsigned long long>(tracer.GetFinishedCount()),
+                tracer.GetPendingCount(),
+                static_cast<unsigned long long>(dropped));
+    std::printf("  render     p50 %.2f ms, max %.2f ms\n",
+                renderMs[renderMs.size() / 2],
+                renderMs.back());
+    std::printf("  ms to       count     mean      p50      p90      p99      max\n");
+    PrintSummary("simulated", tracer.GetSummary(LatencyStage::Simulated));
+    PrintSummary("rendered", tracer.GetSummary(LatencyStage::Rendered));
+    PrintSummary("submitted", tracer.GetSummary(LatencyStage::Submitted));
+    return 0;
+}
@@ -0,0 +1,137 @@
+//
+// PipelineBench.cpp - Serial against pipelined sim updates, rendering to a simulated vsync display
+//
+// Usage: PongPipelineBench [seconds] [update ms] [render ms]
+//
+// Runs a breakout match between two AIs for `seconds` (3 by default) each way. Every update
+// steps the sim at 120 Hz and records the court, then busies its thread for `update ms` more (4
+// by default) to stand in for a heavier game. Every frame takes `render ms` (14 by default) to
+// draw, spent waiting as the CPU does on the GPU, and then waits for the next 60 Hz vblank the
+// way a blocking Present does.
+//
+// Serially the two costs add up and frames miss vblanks; pipelined, updates run while the
+// render thread waits. Reported per mode: frames shown, missed vblanks, updates, the share of
+// rendering overlapped by an update, how long frames waited before the renderer took them, and
+// how old the sim state was when its frame reached the display.
+//
+
+#include "JobSystem.h"
+#include "Sim.h"
+#include "SimPipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr std::chrono::nanoseconds kSimTick(1'000'000'000 / 120);
+    constexpr int64_t kVblankPeriod = 1'000'000'000 / 60;
+
+    void Spin(const int64_t nanoseconds) {
+        const int64_t end = GetInputTime() + nanoseconds;
+        while (GetInputTime() < end) {}
+    }
+
+    void SleepUntil(const int64_t time) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(time - GetInputTime()));
+    }
+
+    struct Result {
+        SimPipelineStats stats;
+        uint64_t frames = 0;
+        uint64_t missed = 0;
+        std::vector<double> ages;  // milliseconds from publish to the vblank that showed it
+    };
+
+    Result Run(const bool pipelined,
+               const double seconds,
+               const int64_t updateCost,
+               const int64_t renderCost) {
+        JobSystem jobs;
+        SimOptions options;
+        options.leftAi   = true;
+        options.breakout = true;
+        Sim sim(&jobs, options);
+
+        // The sim catches up by whole ticks, as the game's does
+        int64_t lastTick = GetInputTime();
+        SimPipeline pipeline(kSimTick, [&](SimFrame& frame, float) {
+            const int64_t now = GetInputTime();
+            for (; lastTick + kSimTick.count() <= now; lastTick += kSimTick.count())
+                sim.Step({}, std::chrono::duration<float>(kSimTick).count());
+            RecordCourt(frame.list, sim, nullptr);
+            Spin(updateCost);
+        });
+
+        Result result;
+        const int64_t start = GetInputTime();
+        const int64_t end   = start + static_cast<int64_t>(seconds * 1e9);
+        int64_t shown       = start;
+        int64_t last        = start;
+        if (pipelined)
+            pipeline.Start();
+        while (shown < end) {
+            const int64_t frameStart = GetInputTime();
+            if (!pipelined)
+                pipeline.Update(static_cast<float>(frameStart - last) * 1e-9f);
+            last = frameStart;
+
+            pipeline.BeginRender();
+            const SimFrame& frame = pipeline.AcquireFrame();
+            SleepUntil(GetInputTime() + renderCost);
+
+            // Present blocks until the first vblank after the frame is ready
+            const int64_t ready  = GetInputTime();
+            const int64_t vblank = start + ((ready - start) / kVblankPeriod + 1) * kVblankPeriod;
+            result.missed += static_cast<uint64_t>((vblank - shown) / kVblankPeriod - 1);
+            if (frame.publishTime)
+                result.ages.push_back(static_cast<double>(vblank - frame.publishTime) * 1e-6);
+            SleepUntil(vblank);
+            pipeline.EndRender();
+            shown = vblank;
+            ++result.frames;
+        }
+        pipeline.Stop();
+        result.stats = pipeline.GetStats();
+        return result;
+    }
+
+    void Print(const char* name, Result& result) {
+        std::sort(result.ages.begin(), result.ages.end());
+        const size_t count = result.ages.size();
+        const auto age     = [&](const size_t index) {
+            return count ? result.ages[std::min(index, count - 1)] : 0.0;
+        };
+        std::printf("  %-9s %6llu %6llu %7llu %7llu %7.0f%%  %6.2f/%-6.2f  %6.2f/%-6.2f\n",
+                    name,
+                    static_cast<unsigned long long>(result.frames),
+                    static_cast<unsigned long long>(result.missed),
+                    static_cast<unsigned long long>(result.stats.published),
+                    static_cast<unsigned long long>(result.stats.dropped),
+                    result.stats.overlap * 100.0,
+                    result.stats.queueP50,
+                    result.stats.queueP99,
+                    age(count / 2),
+                    age(count * 99 / 100));
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    const double seconds  = argc > 1 ? std::atof(argv[1]) : 3.0;
+    const double updateMs = argc > 2 ? std::atof(argv[2]) : 4.0;
+    const double renderMs = argc > 3 ? std::atof(argv[3]) : 14.0;
+    const auto updateCost = static_cast<int64_t>(updateMs * 1e6);
+    const auto renderCost = static_cast<int64_t>(renderMs * 1e6);
+
+    std::printf(
+      "%.1f s each, update %.2f ms, render %.2f ms, 60 Hz vblank\n", seconds, updateMs, renderMs);
+    std::printf("  mode      frames missed updates dropped overlap  queued p50/p99  age p50/p99\n");
+    Result serial = Run(false, seconds, updateCost, renderCost);
+    Print("serial", serial);
+    Result pipelined = Run(true, seconds, updateCost, renderCost);
+    Print("pipelined", pipelined);
+    return 0;
+}
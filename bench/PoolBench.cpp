@@ -0,0 +1,175 @@
+//
+// PoolBench.cpp - Generational ObjectPool versus std::vector<std::unique_ptr<T>>
+//
+// Usage: PongPoolBench [objects] [frames]
+//
+// Simulates a multi-ball / effects workload: each frame integrates every live object, then
+// destroys about a tenth of them at random and spawns replacements, as impacts and power-ups
+// would. Both containers see the same sequence of creates and destroys. After the churn, the
+// iteration pass is timed on its own, since by then the vector's objects are scattered across
+// the heap.
+//
+
+#include "ObjectPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Effect {
+        float x, y;
+        float vx, vy;
+        float life;
+        uint32_t color;
+    };
+
+    constexpr float kDt          = 1.f / 60.f;
+    constexpr int kIteratePasses = 100;
+
+    struct Result {
+        double churnUs;    // per frame
+        double iterateUs;  // per pass
+        float checksum;
+    };
+
+    // Generated up front so random number generation stays out of the timed loops.
+    std::vector<Effect> MakeSpawns(const size_t count) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        std::vector<Effect> spawns(count);
+        for (auto& e : spawns) {
+            e.x     = unit(rng) * 640.f;
+            e.y     = unit(rng) * 360.f;
+            e.vx    = unit(rng) * 200.f;
+            e.vy    = unit(rng) * 200.f;
+            e.life  = 1.f;
+            e.color = 0;
+        }
+        return spawns;
+    }
+
+    void Integrate(Effect& e, const float dt) noexcept {
+        e.x += e.vx * dt;
+        e.y += e.vy * dt;
+        e.life -= dt;
+    }
+
+    // Per frame: which live objects (by position at that moment) die; the same number respawn.
+    std::vector<std::vector<uint32_t>> MakeChurn(const uint32_t objects, const int frames) {
+        std::mt19937 rng(1234);
+        std::vector<std::vector<uint32_t>> churn(static_cast<size_t>(frames));
+        for (auto& kills : churn) {
+            uint32_t live = objects;
+            for (uint32_t i = 0; i < objects / 10; ++i)
+                kills.push_back(std::uniform_int_distribution<uint32_t>(0, --live)(rng));
+        }
+        return churn;
+    }
+
+    template<typename TContainer, typename TOps>
+    Result Run(TContainer& container,
+               const TOps& ops,
+               const uint32_t objects,
+               const std::vector<std::vector<uint32_t>>& churn,
+               const std::vector<Effect>& spawns) {
+        size_t next = 0;
+        while (ops.Size(container) < objects)
+            ops.Create(container, spawns[next++]);
+
+        auto start = Clock::now();
+        for (const auto& kills : churn) {
+            ops.ForEach(container, [](Effect& e) { Integrate(e, kDt); });
+            for (const uint32_t position : kills)
+                ops.Destroy(container, position);
+            for (size_t i = 0; i < kills.size(); ++i)
+                ops.Create(container, spawns[next++]);
+        }
+        const std::chrono::duration<double, std::micro> churnTime = Clock::now() - start;
+
+        start = Clock::now();
+        for (int pass = 0; pass < kIteratePasses; ++pass)
+            ops.ForEach(container, [](Effect& e) { Integrate(e, kDt); });
+        const std::chrono::duration<double, std::micro> iterateTime = Clock::now() - start;
+
+        float checksum = 0.f;
+        ops.ForEach(container, [&](Effect& e) { checksum += e.x; });
+        return {churnTime.count() / churn.size(), iterateTime.count() / kIteratePasses, checksum};
+    }
+
+    struct PoolOps {
+        size_t Size(const ObjectPool<Effect>& pool) const {
+            return pool.GetSize();
+        }
+        void Create(ObjectPool<Effect>& pool, const Effect& e) const {
+            pool.Create(e);
+        }
+        void Destroy(ObjectPool<Effect>& pool, const uint32_t position) const {
+            pool.Destroy(pool.GetHandle(position));
+        }
+        template<typename TFunc>
+        void ForEach(ObjectPool<Effect>& pool, const TFunc& func) const {
+            for (Effect& e : pool)
+                func(e);
+        }
+    };
+
+    // Same swap-and-pop removal as the pool, so only the storage differs.
+    struct VectorOps {
+        using Container = std::vector<std::unique_ptr<Effect>>;
+
+        size_t Size(const Container& effects) const {
+            return effects.size();
+        }
+        void Create(Container& effects, const Effect& e) const {
+            effects.push_back(std::make_unique<Effect>(e));
+        }
+        void Destroy(Container& effects, const uint32_t position) const {
+            effects[position] = std::move(effects.back());
+            effects.pop_back();
+        }
+        template<typename TFunc>
+        void ForEach(Container& effects, const TFunc& func) const {
+            for (const auto& e : effects)
+                func(*e);
+        }
+    };
+
+    void Print(const char* label, const Result& result) {
+        std::printf("%-6s churn %9.2f us/frame  iterate %9.2f us/pass  (checksum %.1f)\n",
+                    label,
+                    result.churnUs,
+                    result.iterateUs,
+                    result.checksum);
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    const uint32_t objects =
+      argc > 1 ? static_cast<uint32_t>(std::max(10, std::atoi(argv[1]))) : 4096;
+    const int frames = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1000;
+
+    std::printf("%u objects, %d frames, %u destroyed and created per frame\n",
+                objects,
+                frames,
+                objects / 10);
+
+    const auto churn  = MakeChurn(objects, frames);
+    const auto spawns = MakeSpawns(objects + size_t {objects / 10} * frames);
+    for (int round = 0; round < 3; ++round) {
+        ObjectPool<Effect> pool(objects);
+        Print("pool", Run(pool, PoolOps {}, objects, churn, spawns));
+
+        VectorOps::Container effects;
+        effects.reserve(objects);
+        Print("vector", Run(effects, VectorOps {}, objects, churn, spawns));
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+//
+// ResizeBench.cpp - Surface rebuilds for a scripted session of window moves and resizes
+//
+// Usage: PongResizeBench
+//
+// Replays the WM_MOVE and WM_SIZE messages of a window being dragged around, resized live,
+// maximized and restored against a mock device that counts swap chain resizes and
+// recreations of the Direct2D target drawn into the back buffer.
+//
+// Compared: handling each message as it arrives, the way the game used to, where every move
+// released the Direct2D target and only a real size change brought it back, and queueing the
+// messages in a ResizeQueue that the frame takes before drawing.
+//
+
+#include "ResizeQueue.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+    enum class MessageType { Move, Size };
+
+    struct Message {
+        MessageType type;
+        SurfaceSize size;
+    };
+
+    /// Stands in for the swap chain and the surfaces created on its buffers.
+    struct MockDevice {
+        SurfaceSize size = {1280, 720};
+        bool overlay     = true;  // the Direct2D target on the back buffer
+
+        uint64_t bufferResizes    = 0;
+        uint64_t overlayCreations = 0;
+        uint64_t framesWithoutHud = 0;
+
+        /// ResizeBuffers, with the target released first and created again on the new buffer.
+        void Resize(const SurfaceSize newSize) {
+            size    = newSize;
+            overlay = true;
+            ++bufferResizes;
+            ++overlayCreations;
+        }
+    };
+
+    std::vector<std::vector<Message>> MakeSession() {
+        std::vector<std::vector<Message>> frames;
+        SurfaceSize size = {1280, 720};
+
+        // Dragging the window: a few moves a frame
+        for (uint32_t frame = 0; frame < 120; ++frame)
+            frames.push_back(std::vector<Message>(4, {MessageType::Move, size}));
+
+        // Live resizing: several sizes a frame, the same one again whenever the mouse pauses
+        for (uint32_t frame = 0; frame < 120; ++frame) {
+            std::vector<Message>& messages = frames.emplace_back();
+            for (uint32_t message = 0; message < 3; ++message) {
+                if ((frame / 10) % 3 != 2) {
+                    size.width += 2;
+                    size.height += 1;
+                }
+                messages.push_back({MessageType::Size, size});
+                messages.push_back({MessageType::Move, size});
+            }
+        }
+
+        // Maximizing sends the new size twice, restoring the old one twice
+        const SurfaceSize restored = size;
+        frames.push_back({{MessageType::Move, {1920, 1080}},
+                          {MessageType::Size, {1920, 1080}},
+                          {MessageType::Size, {1920, 1080}}});
+        frames.resize(frames.size() + 30);
+        frames.push_back({{MessageType::Size, restored},
+                          {MessageType::Move, restored},
+                          {MessageType::Size, restored}});
+        frames.resize(frames.size() + 30);
+        return frames;
+    }
+
+    void Print(const char* name, const MockDevice& device, const uint64_t messages) {
+        std::printf("  %-10s %9llu %10llu %11llu %13llu   %ux%u\n",
+                    name,
+                    static_cast<unsigned long long>(messages),
+                    static_cast<unsigned long long>(device.bufferResizes),
+                    static_cast<unsigned long long>(device.overlayCreations),
+                    static_cast<unsigned long long>(device.framesWithoutHud),
+                    device.size.width,
+                    device.size.height);
+    }
+}  // namespace
+
+int main() {
+    const std::vector<std::vector<Message>> session = MakeSession();
+
+    uint64_t messages = 0;
+    for (const std::vector<Message>& frame : session)
+        messages += frame.size();
+
+    MockDevice immediate;
+    for (const std::vector<Message>& frame : session) {
+        for (const Message& message : frame) {
+            // Moves went through the size change path with the current size, and both released
+            // the target before finding out whether the size changed
+            const SurfaceSize size =
+              message.type == MessageType::Move ? immediate.size : message.size;
+            immediate.overlay = false;
+            if (size != immediate.size)
+                immediate.Resize(size);
+        }
+        immediate.framesWithoutHud += immediate.overlay ? 0 : 1;
+    }
+
+    MockDevice queued;
+    ResizeQueue queue;
+    for (const std::vector<Message>& frame : session) {
+        for (const Message& message : frame) {
+            if (message.type == MessageType::Size)
+                queue.Request(message.size);
+        }
+        if (const auto size = queue.Take(queued.size))
+            queued.Resize(*size);
+        queued.framesWithoutHud += queued.overlay ? 0 : 1;
+    }
+
+    std::printf("%zu frames\n", session.size());
+    std::printf("  policy      messages    resizes d2d targets frames no HUD   final size\n");
+    Print("immediate", immediate, messages);
+    Print("queued", queued, messages);
+    const ResizeStats& stats = queue.GetStats();
+    std::printf("  queue: %llu requests, %llu coalesced, %llu unchanged, %llu rebuilds\n",
+                static_cast<unsigned long long>(stats.requests),
+                static_cast<unsigned long long>(stats.coalesced),
+                static_cast<unsigned long long>(stats.unchanged),
+                static_cast<unsigned long long>(stats.rebuilds));
+    return 0;
+}
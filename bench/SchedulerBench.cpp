@@ -0,0 +1,153 @@
+//
+// SchedulerBench.cpp - Late-latched frame starts against a simulated vsync display
+//
+// Usage: PongSchedulerBench [trace.csv]
+//
+// Replays frame costs through a display that flips on every vblank, where Present blocks until
+// the frame it queued is shown. The costs come from a trace recorded by the game (press T), or
+// from a synthetic one: 4 ms frames with jitter and occasional spikes, rising to 9 ms halfway.
+//
+// Compared: starting each frame as soon as the previous Present returns, and holding the start
+// back with FrameScheduler. Latency runs from the start of a frame, when it samples input, to
+// the vblank that shows it; a stutter is a vblank that shows no new frame. Exits with 2 if the
+// scheduler stutters more than starting at once.
+//
+
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <vector>
+
+namespace {
+    constexpr int64_t kDefaultPeriod    = 1'000'000'000 / 60;
+    constexpr uint32_t kSyntheticFrames = 3600;
+
+    std::vector<int64_t> MakeSyntheticCosts() {
+        uint32_t state     = 1;
+        const auto uniform = [&] {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<double>(state >> 8) / static_cast<double>(1u << 24);
+        };
+
+        std::vector<int64_t> costs(kSyntheticFrames);
+        for (uint32_t frame = 0; frame < kSyntheticFrames; ++frame) {
+            const double base = frame < kSyntheticFrames / 2 ? 4.0 : 9.0;
+            double cost       = base + (uniform() - 0.5) * 2.0;
+            if (uniform() < 0.005)
+                cost *= 2.0;
+            costs[frame] = static_cast<int64_t>(cost * 1e6);
+        }
+        return costs;
+    }
+
+    struct Result {
+        std::vector<double> latencies;  // milliseconds
+        uint64_t stutters = 0;
+    };
+
+    /// Runs every cost through the display. `getStart(now, previousVblank)` picks when each
+    /// frame starts, and `endFrame(time)` is told when its work is done.
+    template<typename TGetStart, typename TEndFrame>
+    Result Replay(const std::vector<int64_t>& costs,
+                  const int64_t period,
+                  const TGetStart& getStart,
+                  const TEndFrame& endFrame) {
+        const auto nextVblank = [&](const int64_t time) {
+            return (time + period - 1) / period * period;
+        };
+
+        Result result;
+        int64_t now   = 0;
+        int64_t shown = 0;
+        for (const int64_t cost : costs) {
+            const int64_t start = getStart(now, shown);
+            const int64_t ready = start + cost;
+            endFrame(ready);
+
+            // Present blocks until the vblank that shows this frame
+            const int64_t vblank = std::max(nextVblank(ready), shown + period);
+            result.stutters += static_cast<uint64_t>((vblank - shown) / period - 1);
+            result.latencies.push_back(static_cast<double>(vblank - start) * 1e-6);
+            shown = vblank;
+            now   = vblank;
+        }
+        return result;
+    }
+
+    void Print(const char* name, Result& result) {
+        std::sort(result.latencies.begin(), result.latencies.end());
+        double sum = 0.0;
+        for (const double latency : result.latencies)
+            sum += latency;
+        const size_t count = result.latencies.size();
+        std::printf("  %-10s %7.2f  %7.2f  %7.2f  %7.2f  %8llu\n",
+                    name,
+                    sum / static_cast<double>(count),
+                    result.latencies[count / 2],
+                    result.latencies[std::min(count - 1, count * 99 / 100)],
+                    result.latencies.back(),
+                    static_cast<unsigned long long>(result.stutters));
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int64_t> costs;
+    int64_t period = kDefaultPeriod;
+    if (argc > 1) {
+        try {
+            const std::vector<FrameRecord> frames = ReadFrameTrace(argv[1]);
+            std::vector<int64_t> periods;
+            for (const FrameRecord& frame : frames) {
+                costs.push_back(frame.submit - frame.start);
+                if (frame.period > 0)
+                    periods.push_back(frame.period);
+            }
+            if (!periods.empty()) {
+                const auto median = periods.begin() + periods.size() / 2;
+                std::nth_element(periods.begin(), median, periods.end());
+                period = *median;
+            }
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            return 1;
+        }
+    } else {
+        costs = MakeSyntheticCosts();
+    }
+    if (costs.empty()) {
+        std::fprintf(stderr, "The trace has no frames\n");
+        return 1;
+    }
+
+    Result immediate = Replay(
+      costs, period, [](const int64_t now, int64_t) { return now; }, [](int64_t) {});
+
+    FrameScheduler scheduler;
+    Result scheduled = Replay(
+      costs,
+      period,
+      [&](const int64_t now, const int64_t vblank) {
+          scheduler.SetVblank(vblank, period);
+          const int64_t start = scheduler.GetFrameStart(now);
+          scheduler.BeginFrame(start);
+          return start;
+      },
+      [&](const int64_t time) { scheduler.EndFrame(time); });
+
+    std::printf("%zu frames at %.2f Hz\n", costs.size(), 1e9 / static_cast<double>(period));
+    std::printf("  ms         mean      p50      p99      max  stutters\n");
+    Print("immediate", immediate);
+    Print("scheduled", scheduled);
+    const FrameSchedulerStats& stats = scheduler.GetStats();
+    std::printf("  scheduler missed %llu, final margin %.2f ms, predicted cost %.2f ms\n",
+                static_cast<unsigned long long>(stats.missed),
+                static_cast<double>(stats.margin) * 1e-6,
+                static_cast<double>(stats.predictedCost) * 1e-6);
+
+    // Holding frames back is only worth it if it never costs a shown frame
+    if (scheduled.stutters > immediate.stutters)
+        return 2;
+    return 0;
+}
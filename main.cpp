@@ -1,7 +1,14 @@
 #include "pch.h"
+#include "CommandLine.h"
 #include "Game.h"
+#include "Utf.h"
+
+#include <shellapi.h>
+#include <timeapi.h>
 
 #include <chrono>
+#include <string>
+#include <vector>
 
 #pragma warning(disable : 4061)
 
@@ -19,6 +26,42 @@ LRESULT CALLBACK WndProc(HWND, UINT, WPARAM, LPARAM);
 namespace {
     auto g_AppName = "Pong <DX11>";
     std::unique_ptr<Game> g_Game;
+
+    // --breakout starts in breakout mode, --demo hands the left paddle to the AI as well,
+    // --seed=N picks the serves, --no-late-latch starts frames immediately, --mute skips
+    // opening the audio device, --capture=PATH records every frame to a .y4m file or a
+    // directory of PNGs and --pipelined runs the sim on its own thread
+    GameOptions ParseCommandLine(const wchar_t* text) {
+        // CommandLineToArgvW takes the first token as the program name, so give it one
+        const std::wstring line = std::wstring(L"Pong ") + text;
+        int argc                = 0;
+        LPWSTR* argv            = ::CommandLineToArgvW(line.c_str(), &argc);
+        if (!argv)
+            throw std::system_error(static_cast<int>(::GetLastError()), std::system_category());
+        std::vector<std::string> arguments(argc > 1 ? static_cast<size_t>(argc - 1) : 0);
+        for (size_t i = 0; i < arguments.size(); ++i)
+            AppendUtf8(argv[i + 1], arguments[i]);
+        ::LocalFree(argv);
+
+        CommandLine commandLine(std::move(arguments));
+        GameOptions options;
+        options.sim.breakout = commandLine.HasFlag("breakout");
+        options.sim.leftAi   = commandLine.HasFlag("demo");
+        options.sim.seed     = commandLine.GetNumber("seed", options.sim.seed);
+        options.lateLatch    = !commandLine.HasFlag("no-late-latch");
+        options.sound        = !commandLine.HasFlag("mute");
+        options.pipelined    = commandLine.HasFlag("pipelined");
+
+        // Paths stay wide, since the narrow form would go through the ANSI code page
+        std::wstring capturePath;
+        AppendWide(commandLine.GetString("capture", ""), capturePath);
+        options.capturePath = capturePath;
+
+        commandLine.CheckUnknown();
+        if (!commandLine.GetPositional().empty())
+            throw std::invalid_argument("Unexpected argument " + commandLine.GetPositional()[0]);
+        return options;
+    }
 }  // namespace
 
 int WINAPI wWinMain(_In_ HINSTANCE hInstance,
@@ -26,7 +69,6 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance,
                     _In_ LPWSTR lpCmdLine,
                     _In_ int nShowCmd) {
     UNREFERENCED_PARAMETER(hPrevInstance);
-    UNREFERENCED_PARAMETER(lpCmdLine);
     UNREFERENCED_PARAMETER(nShowCmd);
 
     if (!::XMVerifyCPUSupport())
@@ -36,7 +78,15 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance,
     if (FAILED(hr))
         return 1;
 
-    g_Game = std::make_unique<Game>();
+    GameOptions options;
+    try {
+        options = ParseCommandLine(lpCmdLine);
+    } catch (const std::exception& e) {
+        ::MessageBoxA(nullptr, e.what(), g_AppName, MB_OK | MB_ICONERROR);
+        return 1;
+    }
+
+    g_Game = std::make_unique<Game>(options);
 
     // Register class and create window
 
@@ -87,17 +137,35 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance,
 
     g_Game->Initialize(hwnd, rc.right - rc.left, rc.bottom - rc.top);
 
+    // Millisecond timer resolution, so waiting for a late-latched frame start does not
+    // oversleep by a whole scheduler quantum
+    ::timeBeginPeriod(1);
+
     // Main msg loop
     MSG msg = {};
     while (WM_QUIT != msg.message) {
         if (::PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
             ::TranslateMessage(&msg);
             ::DispatchMessage(&msg);
+        } else if (const auto wait = g_Game->GetTimeUntilFrameStart();
+                   wait > std::chrono::nanoseconds::zero()) {
+            // Keep stamping input until the frame is due; the last millisecond is spent polling,
+            // since the wait may wake up to a millisecond late
+            const auto sleep = std::chrono::duration_cast<std::chrono::milliseconds>(wait) -
+                               std::chrono::milliseconds(1);
+            if (sleep.count() > 0)
+                ::MsgWaitForMultipleObjectsEx(0,
+                                              nullptr,
+                                              static_cast<DWORD>(sleep.count()),
+                                              QS_ALLINPUT,
+                                              MWMO_INPUTAVAILABLE);
         } else {
             g_Game->Tick();
         }
     }
 
+    ::timeEndPeriod(1);
+
     g_Game.reset();
 
     ::CoUninitialize();
@@ -158,7 +226,8 @@ LRESULT WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 if (s_InSuspend && game)
                     game->OnResuming();
                 s_InSuspend = false;
-            } else if (!s_InSizeMove && game) {
+            } else if (game) {
+                // Queued, so a live resize rebuilds the surfaces at most once per frame
                 game->OnWindowSizeChanged(LOWORD(lParam), HIWORD(lParam));
             }
             break;
@@ -222,6 +291,15 @@ LRESULT WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         case WM_KEYDOWN:
             if (wParam == VK_ESCAPE) {
                 ::PostQuitMessage(0);
+            } else if (game && !(lParam & 0x40000000)) {
+                // Bit 30 is set on auto-repeat
+                game->OnKey(static_cast<uint32_t>(wParam), true);
+            }
+            return 0;
+
+        case WM_KEYUP:
+            if (game) {
+                game->OnKey(static_cast<uint32_t>(wParam), false);
             }
             return 0;
 
@@ -0,0 +1,247 @@
+//
+// GoldenFrames.cpp - Checks software-rendered frames against reference images
+//
+// Usage: PongGolden <reference dir> [--update] [--ticks=N] [--every=N] [--tolerance=N]
+//                   [--max-differing=N] [--failures=DIR] [--pack=data.pak]
+//
+// Plays a Pong and a Breakout match with the AI on both sides at a fixed tick, and every `every`
+// ticks draws the court with SoftwareRenderer and compares it to <dir>/<scenario>_<tick>.png. A
+// frame fails when more than max-differing pixels (0 by default) have a channel more than
+// `tolerance` (2 by default) away from the reference; its heatmap and the frame itself are
+// written to the failures directory (the reference directory by default) as .diff.png and
+// .actual.png. With --update the references are rewritten instead.
+//
+// The references for the default options live in golden/, and ctest runs the check against them.
+//
+// Exits with 2 if any frame failed or a reference is missing, and 1 on other errors.
+//
+
+#include "AssetPack.h"
+#include "CommandLine.h"
+#include "Effects.h"
+#include "ImageDiff.h"
+#include "MappedFile.h"
+#include "Png.h"
+#include "Sim.h"
+#include "SoftwareRenderer.h"
+#include "TextureFile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr float kTick         = 1.f / 120.f;
+    constexpr uint32_t kWidth     = 640;
+    constexpr uint32_t kHeight    = 360;
+    constexpr int kExitError      = 1;
+    constexpr int kExitRegression = 2;
+
+    /// An AI match on both paddles.
+    struct Scenario {
+        const char* name;
+        uint32_t seed;
+        bool breakout;
+    };
+
+    // The seeds are part of the references; changing one means recording them again
+    constexpr Scenario kScenarios[] = {
+      {"pong", 1, false},
+      {"breakout", 2, true},
+    };
+
+    struct GoldenOptions {
+        std::filesystem::path references;
+        bool update           = false;
+        uint32_t ticks        = 3600;
+        uint32_t every        = 60;
+        uint8_t tolerance     = 2;
+        uint64_t maxDiffering = 0;
+        std::filesystem::path failures;
+        std::string pack;
+    };
+
+    struct Totals {
+        uint32_t frames      = 0;
+        uint32_t failed      = 0;
+        uint32_t missing     = 0;
+        uint64_t pixels      = 0;
+        double renderSeconds = 0.0;
+        double diffSeconds   = 0.0;  // comparisons only, not PNG decoding
+    };
+
+    /// Converts the renderer's 0xAARRGGBB framebuffer to RGBA8.
+    void CopyFrame(const SoftwareRenderer& renderer, Image& image) {
+        const std::span<const uint32_t> pixels = renderer.GetPixels();
+        image.width                            = renderer.GetWidth();
+        image.height                           = renderer.GetHeight();
+        image.pixels.resize(pixels.size() * 4);
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            const uint32_t pixel    = pixels[i];
+            image.pixels[i * 4]     = static_cast<uint8_t>(pixel >> 16);
+            image.pixels[i * 4 + 1] = static_cast<uint8_t>(pixel >> 8);
+            image.pixels[i * 4 + 2] = static_cast<uint8_t>(pixel);
+            image.pixels[i * 4 + 3] = static_cast<uint8_t>(pixel >> 24);
+        }
+    }
+
+    void WritePng(const std::filesystem::path& path, const Image& image) {
+        const std::vector<std::byte> file = EncodePng(image);
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(file.data()),
+                     static_cast<std::streamsize>(file.size()));
+        if (!output)
+            throw std::runtime_error("Failed to write " + path.string());
+    }
+
+    /// Compares one frame with its reference, or records it with --update.
+    void CheckFrame(const GoldenOptions& options,
+                    const std::string& name,
+                    const Image& frame,
+                    Totals& totals) {
+        const std::filesystem::path reference = options.references / (name + ".png");
+        ++totals.frames;
+        if (options.update) {
+            WritePng(reference, frame);
+            return;
+        }
+        if (!std::filesystem::exists(reference)) {
+            std::printf("%-20s missing\n", name.c_str());
+            ++totals.missing;
+            return;
+        }
+
+        MappedFile file;
+        file.Open(reference);
+        const Image expected = DecodePng(file.GetData());
+        if (expected.width != frame.width || expected.height != frame.height) {
+            std::printf("%-20s FAILED: reference is %ux%u\n",
+                        name.c_str(),
+                        expected.width,
+                        expected.height);
+            ++totals.failed;
+            return;
+        }
+
+        const auto diffStart         = Clock::now();
+        const ImageDiffResult result = DiffImages(expected, frame, options.tolerance);
+        totals.diffSeconds += std::chrono::duration<double>(Clock::now() - diffStart).count();
+        totals.pixels += size_t {frame.width} * frame.height;
+        if (result.differingPixels <= options.maxDiffering)
+            return;
+
+        ++totals.failed;
+        std::printf("%-20s FAILED: %llu pixels differ, by up to %u\n",
+                    name.c_str(),
+                    static_cast<unsigned long long>(result.differingPixels),
+                    result.maxDelta);
+        std::filesystem::create_directories(options.failures);
+        WritePng(options.failures / (name + ".diff.png"),
+                 MakeDiffHeatmap(expected, frame, options.tolerance));
+        WritePng(options.failures / (name + ".actual.png"), frame);
+    }
+
+    void RunScenario(const GoldenOptions& options,
+                     const Scenario& scenario,
+                     const CourtTextures& textures,
+                     Totals& totals) {
+        SimOptions simOptions;
+        simOptions.leftAi   = true;
+        simOptions.seed     = scenario.seed;
+        simOptions.breakout = scenario.breakout;
+        Sim sim(nullptr, simOptions);
+        CourtEffects effects;
+        SoftwareRenderer renderer(kWidth, kHeight);
+        Image frame;
+        for (uint32_t tick = 1; tick <= options.ticks; ++tick) {
+            sim.Step({}, kTick);
+            effects.Emit(sim);
+            effects.Update(kTick);
+            if (tick % options.every != 0)
+                continue;
+
+            const auto renderStart = Clock::now();
+            renderer.DrawCourt(sim, &effects, textures);
+            CopyFrame(renderer, frame);
+            totals.renderSeconds +=
+              std::chrono::duration<double>(Clock::now() - renderStart).count();
+            const std::string name = std::string(scenario.name) + '_' + std::to_string(tick);
+            CheckFrame(options, name, frame, totals);
+        }
+    }
+
+    GoldenOptions ParseOptions(CommandLine& commandLine) {
+        GoldenOptions options;
+        options.update       = commandLine.HasFlag("update");
+        options.ticks        = commandLine.GetNumber("ticks", options.ticks);
+        options.every        = commandLine.GetNumber("every", options.every);
+        options.tolerance    = commandLine.GetNumber("tolerance", options.tolerance);
+        options.maxDiffering = commandLine.GetNumber("max-differing", options.maxDiffering);
+        options.failures     = commandLine.GetString("failures", "");
+        options.pack         = commandLine.GetString("pack", "");
+        commandLine.CheckUnknown();
+        if (commandLine.GetPositional().size() != 1)
+            throw std::invalid_argument("Expected one reference directory");
+        if (options.every == 0)
+            throw std::invalid_argument("--every must be at least 1");
+        options.references = commandLine.GetPositional()[0];
+        if (options.failures.empty())
+            options.failures = options.references;
+        return options;
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        CommandLine commandLine(argc, argv);
+        const GoldenOptions options = ParseOptions(commandLine);
+        if (options.update)
+            std::filesystem::create_directories(options.references);
+
+        std::optional<TextureData> paddle;
+        std::optional<TextureData> ball;
+        AssetPack pack;
+        if (!options.pack.empty()) {
+            pack.Open(options.pack);
+            paddle = LoadPackedTexture(pack, "paddle");
+            ball   = LoadPackedTexture(pack, "ball");
+        }
+        const CourtTextures textures = {paddle ? &*paddle : nullptr, ball ? &*ball : nullptr};
+
+        Totals totals;
+        for (const Scenario& scenario : kScenarios)
+            RunScenario(options, scenario, textures, totals);
+
+        std::printf("%u frames, rendered in %.1f ms\n", totals.frames, totals.renderSeconds * 1e3);
+        if (options.update) {
+            std::printf("references written to %s\n", options.references.string().c_str());
+            return 0;
+        }
+        if (totals.diffSeconds > 0.0) {
+            std::printf("compared %.1f Mpixels in %.2f ms (%.0f Mpixels/s)\n",
+                        static_cast<double>(totals.pixels) / 1e6,
+                        totals.diffSeconds * 1e3,
+                        static_cast<double>(totals.pixels) / 1e6 / totals.diffSeconds);
+        }
+        if (totals.missing)
+            std::printf("%u references missing; record them with --update\n", totals.missing);
+        if (totals.failed || totals.missing) {
+            std::printf("%u of %u frames FAILED\n", totals.failed + totals.missing, totals.frames);
+            return kExitRegression;
+        }
+        std::printf("all frames match\n");
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "PongGolden: %s\n", e.what());
+        return kExitError;
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+//
+// PackTool.cpp - Builds a PongPAK asset archive from loose files
+//
+// Usage: PongPack <output.pak> [--store | --compress] <file>...
+//
+// --store and --compress apply to the files that follow them; files may be compressed by default.
+// Stored entries can be viewed in place from the mapping, so use --store for data that is
+// uploaded or parsed as-is, such as .ptex textures and fonts.
+//
+
+#include "AssetPack.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <output.pak> [--store | --compress] <file>...\n", argv[0]);
+        return 1;
+    }
+
+    const std::filesystem::path output = argv[1];
+
+    std::vector<PackSource> sources;
+    bool allowCompression = true;
+    for (int arg = 2; arg < argc; ++arg) {
+        if (std::strcmp(argv[arg], "--store") == 0)
+            allowCompression = false;
+        else if (std::strcmp(argv[arg], "--compress") == 0)
+            allowCompression = true;
+        else
+            sources.push_back({argv[arg], allowCompression});
+    }
+
+    try {
+        WriteAssetPack(output, sources);
+
+        AssetPack pack;
+        pack.Open(output);
+        for (const auto& entry : pack.GetEntries()) {
+            const auto name = pack.GetName(entry);
+            std::printf("  %-24.*s %8llu -> %8llu%s\n",
+                        static_cast<int>(name.size()),
+                        name.data(),
+                        static_cast<unsigned long long>(entry.size),
+                        static_cast<unsigned long long>(entry.storedSize),
+                        (entry.flags & kPackEntryCompressed) ? " (lz)" : "");
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "PongPack: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
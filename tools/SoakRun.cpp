@@ -0,0 +1,478 @@
+//
+// SoakRun.cpp - Headless AI-vs-AI soak run with performance regression gating
+//
+// Usage: PongSoak [--matches=N] [--points=N] [--breakout] [--width=W] [--height=H] [--jobs=N]
+//                 [--pack=data.pak] [--out=soak.json] [--baseline=soak.json] [--tolerance=F]
+//
+// Plays matches with the AI on both sides, each until one side has `points` or ten minutes of
+// sim time have passed, as fast as the machine allows: every frame is one fixed sim tick, the
+// effects and a software render of the court. Frame times, the heap allocations made during
+// frames and the peak resident set size are printed and written to --out as JSON. Without
+// --pack the sprites are drawn as placeholder rectangles.
+//
+// With --baseline, the run is compared to an earlier --out file, and the exit code is 2 if the
+// median or 99th percentile frame time, the allocations per frame or the peak RSS exceed the
+// baseline's by more than the tolerance (a fraction, 0.15 by default). Errors exit with 1.
+//
+
+#include "AssetPack.h"
+#include "CommandLine.h"
+#include "Effects.h"
+#include "JobSystem.h"
+#include "Sim.h"
+#include "SoftwareRenderer.h"
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <Windows.h>
+    #include <malloc.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr float kTick             = 1.f / 120.f;
+    constexpr uint32_t kMaxMatchTicks = 10 * 60 * 120;
+    constexpr int kExitError          = 1;
+    constexpr int kExitRegression     = 2;
+
+    // Every heap allocation the process makes, counted by the operator new replacements below
+    std::atomic<uint64_t> g_Allocations {0};
+    std::atomic<uint64_t> g_AllocatedBytes {0};
+
+    void* AllocateCounted(const size_t size) noexcept {
+        g_Allocations.fetch_add(1, std::memory_order_relaxed);
+        g_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size ? size : 1);
+    }
+
+    void* AllocateCountedAligned(const size_t size, const std::align_val_t alignment) noexcept {
+        g_Allocations.fetch_add(1, std::memory_order_relaxed);
+        g_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        const auto align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+        return ::_aligned_malloc(size ? size : 1, align);
+#else
+        return std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+#endif
+    }
+
+    void FreeAligned(void* p) noexcept {
+#ifdef _WIN32
+        ::_aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}  // namespace
+
+// Every replaceable form is defined so that all of them are counted and each delete matches the
+// new that allocated it: the plain and array forms share malloc, the aligned ones the aligned heap
+void* operator new(const size_t size) {
+    if (void* p = AllocateCounted(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](const size_t size) {
+    return operator new(size);
+}
+
+void* operator new(const size_t size, const std::nothrow_t&) noexcept {
+    return AllocateCounted(size);
+}
+
+void* operator new[](const size_t size, const std::nothrow_t&) noexcept {
+    return AllocateCounted(size);
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment) {
+    if (void* p = AllocateCountedAligned(size, alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](const size_t size, const std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(const size_t size,
+                   const std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+    return AllocateCountedAligned(size, alignment);
+}
+
+void* operator new[](const size_t size,
+                     const std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+    return AllocateCountedAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    FreeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    FreeAligned(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    FreeAligned(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    FreeAligned(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    FreeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    FreeAligned(p);
+}
+
+namespace {
+    struct SoakOptions {
+        uint32_t matches = 10;
+        int points       = 3;
+        bool breakout    = false;
+        uint32_t width   = 1280;
+        uint32_t height  = 720;
+        uint32_t jobs    = JobSystem::GetDefaultWorkerCount();
+        std::string pack;
+        std::string out;
+        std::string baseline;
+        double tolerance = 0.15;
+    };
+
+    struct Metrics {
+        uint32_t matches           = 0;
+        uint64_t frames            = 0;
+        double wallSeconds         = 0.0;
+        double frameMean           = 0.0;  // milliseconds
+        double frameP50            = 0.0;
+        double frameP90            = 0.0;
+        double frameP99            = 0.0;
+        double frameP999           = 0.0;
+        double frameMax            = 0.0;
+        uint64_t allocations       = 0;  // made during frames, on any thread
+        uint64_t allocatedBytes    = 0;
+        double allocationsPerFrame = 0.0;
+        uint64_t peakRssKb         = 0;
+    };
+
+    /// A metric compared against the baseline; it regresses past baseline * (1 + tolerance), or
+    /// baseline + minSlack if that is more, so tiny baselines do not fail on noise.
+    struct Gate {
+        const char* key;
+        double value;
+        double minSlack;
+    };
+
+    uint64_t GetPeakRssKb() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters = {};
+        if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0;
+        return counters.PeakWorkingSetSize / 1024;
+#else
+        rusage usage = {};
+        if (::getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+    #ifdef __APPLE__
+        return static_cast<uint64_t>(usage.ru_maxrss) / 1024;
+    #else
+        return static_cast<uint64_t>(usage.ru_maxrss);
+    #endif
+#endif
+    }
+
+    /// Nearest-rank percentile of sorted values.
+    double GetPercentile(const std::vector<float>& sorted, const double percentile) {
+        const double count = static_cast<double>(sorted.size());
+        const auto rank    = static_cast<size_t>(percentile / 100.0 * count);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    Metrics RunMatches(const SoakOptions& options, const CourtTextures& textures) {
+        std::optional<JobSystem> jobs;
+        if (options.jobs)
+            jobs.emplace(options.jobs);
+        JobSystem* const pJobs = jobs ? &*jobs : nullptr;
+
+        SimOptions simOptions;
+        simOptions.leftAi   = true;
+        simOptions.breakout = options.breakout;
+        Sim sim(pJobs, simOptions);
+        CourtEffects effects;
+        SoftwareRenderer renderer(options.width, options.height);
+
+        Metrics metrics;
+        std::vector<float> frameMs;
+        frameMs.reserve(size_t {options.matches} * kMaxMatchTicks);
+
+        const auto runStart = Clock::now();
+        for (uint32_t match = 0; match < options.matches; ++match) {
+            simOptions.seed = match + 1;
+            sim.Reset(simOptions);
+
+            const size_t firstFrame = frameMs.size();
+            uint32_t ticks          = 0;
+            while (ticks < kMaxMatchTicks && sim.GetScore().left < options.points &&
+                   sim.GetScore().right < options.points) {
+                const uint64_t allocations = g_Allocations.load(std::memory_order_relaxed);
+                const uint64_t bytes       = g_AllocatedBytes.load(std::memory_order_relaxed);
+                const auto frameStart      = Clock::now();
+
+                sim.Step({}, kTick);
+                effects.Emit(sim);
+                effects.Update(kTick, pJobs);
+                renderer.DrawCourt(sim, &effects, textures);
+
+                const std::chrono::duration<float, std::milli> elapsed = Clock::now() - frameStart;
+                metrics.allocations += g_Allocations.load(std::memory_order_relaxed) - allocations;
+                metrics.allocatedBytes +=
+                  g_AllocatedBytes.load(std::memory_order_relaxed) - bytes;
+                frameMs.push_back(elapsed.count());
+                ++ticks;
+            }
+
+            const Score& score = sim.GetScore();
+            double matchMs     = 0.0;
+            for (size_t frame = firstFrame; frame < frameMs.size(); ++frame)
+                matchMs += frameMs[frame];
+            std::printf("match %3u: %d-%d in %6u frames, %.3f ms/frame\n",
+                        match + 1,
+                        score.left,
+                        score.right,
+                        ticks,
+                        ticks ? matchMs / ticks : 0.0);
+        }
+        const std::chrono::duration<double> wall = Clock::now() - runStart;
+
+        metrics.matches     = options.matches;
+        metrics.frames      = frameMs.size();
+        metrics.wallSeconds = wall.count();
+        metrics.peakRssKb   = GetPeakRssKb();
+        if (!frameMs.empty()) {
+            double total = 0.0;
+            for (const float ms : frameMs)
+                total += ms;
+            std::sort(frameMs.begin(), frameMs.end());
+            metrics.frameMean           = total / static_cast<double>(frameMs.size());
+            metrics.frameP50            = GetPercentile(frameMs, 50.0);
+            metrics.frameP90            = GetPercentile(frameMs, 90.0);
+            metrics.frameP99            = GetPercentile(frameMs, 99.0);
+            metrics.frameP999           = GetPercentile(frameMs, 99.9);
+            metrics.frameMax            = frameMs.back();
+            metrics.allocationsPerFrame =
+              static_cast<double>(metrics.allocations) / static_cast<double>(frameMs.size());
+        }
+        return metrics;
+    }
+
+    std::vector<Gate> GetGates(const Metrics& metrics) {
+        return {
+          {"frame_ms_p50", metrics.frameP50, 0.02},
+          {"frame_ms_p99", metrics.frameP99, 0.05},
+          {"allocations_per_frame", metrics.allocationsPerFrame, 0.01},
+          {"peak_rss_kb", static_cast<double>(metrics.peakRssKb), 1024.0},
+        };
+    }
+
+    void WriteMetrics(const std::string& path, const SoakOptions& options, const Metrics& m) {
+        FILE* pFile = std::fopen(path.c_str(), "w");
+        if (!pFile)
+            throw std::runtime_error("Failed to create " + path);
+        std::fprintf(pFile,
+                     "{\n"
+                     "  \"matches\": %u,\n"
+                     "  \"points\": %d,\n"
+                     "  \"breakout\": %s,\n"
+                     "  \"width\": %u,\n"
+                     "  \"height\": %u,\n"
+                     "  \"jobs\": %u,\n"
+                     "  \"frames\": %llu,\n"
+                     "  \"wall_seconds\": %.3f,\n"
+                     "  \"frame_ms_mean\": %.4f,\n"
+                     "  \"frame_ms_p50\": %.4f,\n"
+                     "  \"frame_ms_p90\": %.4f,\n"
+                     "  \"frame_ms_p99\": %.4f,\n"
+                     "  \"frame_ms_p999\": %.4f,\n"
+                     "  \"frame_ms_max\": %.4f,\n"
+                     "  \"allocations\": %llu,\n"
+                     "  \"allocated_bytes\": %llu,\n"
+                     "  \"allocations_per_frame\": %.4f,\n"
+                     "  \"peak_rss_kb\": %llu\n"
+                     "}\n",
+                     m.matches,
+                     options.points,
+                     options.breakout ? "true" : "false",
+                     options.width,
+                     options.height,
+                     options.jobs,
+                     static_cast<unsigned long long>(m.frames),
+                     m.wallSeconds,
+                     m.frameMean,
+                     m.frameP50,
+                     m.frameP90,
+                     m.frameP99,
+                     m.frameP999,
+                     m.frameMax,
+                     static_cast<unsigned long long>(m.allocations),
+                     static_cast<unsigned long long>(m.allocatedBytes),
+                     m.allocationsPerFrame,
+                     static_cast<unsigned long long>(m.peakRssKb));
+        if (std::fclose(pFile) != 0)
+            throw std::runtime_error("Failed to write " + path);
+    }
+
+    /// The number following "key": in a flat JSON object such as WriteMetrics writes.
+    std::optional<double> FindNumber(const std::string& json, const std::string& key) {
+        const size_t at = json.find('"' + key + "\":");
+        if (at == std::string::npos)
+            return std::nullopt;
+        const char* pStart = json.c_str() + at + key.size() + 3;
+        char* pEnd         = nullptr;
+        const double value = std::strtod(pStart, &pEnd);
+        return pEnd != pStart ? std::optional<double>(value) : std::nullopt;
+    }
+
+    /// Returns true if any gated metric regressed past the baseline.
+    bool CompareToBaseline(const std::string& path, const double tolerance, const Metrics& m) {
+        std::ifstream file(path);
+        if (!file)
+            throw std::runtime_error("Failed to open baseline " + path);
+        const std::string json(std::istreambuf_iterator<char>(file), {});
+
+        bool regressed = false;
+        std::printf("\n%-24s %12s %12s %12s\n", "versus baseline", "baseline", "limit", "now");
+        for (const Gate& gate : GetGates(m)) {
+            const auto baseline = FindNumber(json, gate.key);
+            if (!baseline) {
+                std::printf("%-24s %12s\n", gate.key, "missing");
+                continue;
+            }
+            const double limit = std::max(*baseline * (1.0 + tolerance), *baseline + gate.minSlack);
+            const bool failed  = gate.value > limit;
+            regressed          = regressed || failed;
+            std::printf("%-24s %12.4f %12.4f %12.4f%s\n",
+                        gate.key,
+                        *baseline,
+                        limit,
+                        gate.value,
+                        failed ? "  REGRESSED" : "");
+        }
+        return regressed;
+    }
+
+    SoakOptions ParseOptions(CommandLine& commandLine) {
+        SoakOptions options;
+        options.matches   = commandLine.GetNumber("matches", options.matches);
+        options.points    = commandLine.GetNumber("points", options.points);
+        options.breakout  = commandLine.HasFlag("breakout");
+        options.width     = commandLine.GetNumber("width", options.width);
+        options.height    = commandLine.GetNumber("height", options.height);
+        options.jobs      = commandLine.GetNumber("jobs", options.jobs);
+        options.pack      = commandLine.GetString("pack", "");
+        options.out       = commandLine.GetString("out", "");
+        options.baseline  = commandLine.GetString("baseline", "");
+        options.tolerance = commandLine.GetNumber("tolerance", options.tolerance);
+        commandLine.CheckUnknown();
+        if (!commandLine.GetPositional().empty())
+            throw std::invalid_argument("Unexpected argument " + commandLine.GetPositional()[0]);
+        return options;
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        CommandLine commandLine(argc, argv);
+        const SoakOptions options = ParseOptions(commandLine);
+
+        std::optional<TextureData> paddle;
+        std::optional<TextureData> ball;
+        AssetPack pack;
+        if (!options.pack.empty()) {
+            pack.Open(options.pack);
+            paddle = LoadPackedTexture(pack, "paddle");
+            ball   = LoadPackedTexture(pack, "ball");
+        }
+        const CourtTextures textures = {paddle ? &*paddle : nullptr, ball ? &*ball : nullptr};
+
+        const Metrics m = RunMatches(options, textures);
+        std::printf("\n%llu frames in %.1f s\n"
+                    "frame ms: mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f\n"
+                    "allocations during frames: %llu (%.1f KB), %.3f per frame\n"
+                    "peak RSS: %llu KB\n",
+                    static_cast<unsigned long long>(m.frames),
+                    m.wallSeconds,
+                    m.frameMean,
+                    m.frameP50,
+                    m.frameP90,
+                    m.frameP99,
+                    m.frameP999,
+                    m.frameMax,
+                    static_cast<unsigned long long>(m.allocations),
+                    static_cast<double>(m.allocatedBytes) / 1024.0,
+                    m.allocationsPerFrame,
+                    static_cast<unsigned long long>(m.peakRssKb));
+
+        if (!options.out.empty())
+            WriteMetrics(options.out, options, m);
+        if (!options.baseline.empty() && CompareToBaseline(options.baseline, options.tolerance, m))
+            return kExitRegression;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return kExitError;
+    }
+    return 0;
+}
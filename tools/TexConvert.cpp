@@ -0,0 +1,62 @@
+//
+// TexConvert.cpp - Converts PNG images to pre-decoded .ptex textures
+//
+// Usage: PongTexConv [--mips] <input.png> <output.ptex>
+//
+
+#include "Png.h"
+#include "TextureFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    bool generateMips = false;
+    int arg           = 1;
+    if (arg < argc && std::strcmp(argv[arg], "--mips") == 0) {
+        generateMips = true;
+        ++arg;
+    }
+
+    if (argc - arg != 2) {
+        std::fprintf(stderr, "Usage: %s [--mips] <input.png> <output.ptex>\n", argv[0]);
+        return 1;
+    }
+
+    try {
+        std::ifstream input(argv[arg], std::ios::binary);
+        if (!input)
+            throw std::runtime_error(std::string("Failed to open ") + argv[arg]);
+        const std::vector<char> png((std::istreambuf_iterator<char>(input)),
+                                    std::istreambuf_iterator<char>());
+
+        const auto texture =
+          ConvertImage(DecodePng({reinterpret_cast<const std::byte*>(png.data()), png.size()}),
+                       generateMips);
+        const auto file = WriteTexture(texture);
+
+        std::ofstream output(argv[arg + 1], std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(file.data()),
+                     static_cast<std::streamsize>(file.size()));
+        if (!output)
+            throw std::runtime_error(std::string("Failed to write ") + argv[arg + 1]);
+
+        std::printf("%s: %ux%u, %u mips, %zu bytes\n",
+                    argv[arg + 1],
+                    texture.width,
+                    texture.height,
+                    texture.mipCount,
+                    file.size());
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "PongTexConv: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
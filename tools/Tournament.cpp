@@ -0,0 +1,478 @@
+//
+// Tournament.cpp - Round-robin tournaments between AI configurations, rated by Elo
+//
+// Usage: PongTournament [--rounds=N] [--points=N] [--max-ticks=N] [--seed=N] [--threads=N]
+//                       [--configs=FILE] [--breakout] [--out=ratings.json]
+//
+// Every configuration plays every other `rounds` times on each side (100 by default), first to
+// `points` (3 by default) or a draw when level after `max-ticks` sim ticks. Both orderings of a
+// pair share the round's serve seed, so neither side is favoured by the serves.
+//
+// Matches are numbered and split evenly between the threads; a thread that runs out steals the
+// back half of another's remaining range. Each thread tallies into its own results, which are
+// summed at the end, so the ratings, and the results hash printed with them, depend only on the
+// seed and not on the thread count or on who played what.
+//
+// The configurations file has one AI per line: a name, then AiSettings' maxAxis, deadZone,
+// reach and aimSpread. Blank lines and lines starting with # are skipped. Without it, a built-in
+// set spanning the useful range of each setting plays.
+//
+// Ratings are Bradley-Terry maximum likelihood estimates on the Elo scale, averaging 0, with
+// draws counted as half a win; the interval is an approximate 95% one from each rating's
+// standard error.
+//
+
+#include "CommandLine.h"
+#include "Hash.h"
+#include "Sim.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <numeric>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int kExitError = 1;
+    constexpr float kTick    = 1.f / 120.f;
+
+    // Half a win for each side of every pair before any match is played, so that a
+    // configuration that wins or loses everything still gets a finite rating
+    constexpr double kPriorDraws = 1.0;
+
+    struct AiConfig {
+        std::string name;
+        AiSettings settings;
+    };
+
+    struct TournamentOptions {
+        uint32_t rounds   = 100;
+        int points        = 3;
+        uint32_t maxTicks = 120 * 300;
+        uint32_t seed     = 1;
+        uint32_t threads  = std::max(1u, std::thread::hardware_concurrency());
+        bool breakout     = false;
+        std::string configs;
+        std::string out;
+    };
+
+    /// Results of one ordered pairing: the first configuration on the left.
+    struct PairResult {
+        uint32_t leftWins  = 0;
+        uint32_t draws     = 0;
+        uint32_t rightWins = 0;
+    };
+
+    /// One thread's tally. Threads only ever write their own, and the vectors are separate
+    /// allocations, so the hot counters do not share cache lines.
+    struct alignas(64) Accumulator {
+        std::vector<PairResult> pairs;  // left * configCount + right
+        uint64_t matches = 0;
+        uint64_t ticks   = 0;
+        uint32_t steals  = 0;
+    };
+
+    struct Rating {
+        double elo      = 0.0;
+        double interval = 0.0;  // half width of the 95% interval
+        double wins     = 0.0;
+        double draws    = 0.0;
+        double losses   = 0.0;
+    };
+
+    /// A thread's share of the matches, [begin, end) packed into one word. The owner takes
+    /// matches from the front and thieves split off the back half, each with a compare-exchange,
+    /// so no lock is ever taken.
+    class alignas(64) MatchRange {
+    public:
+        void Set(const uint32_t begin, const uint32_t end) noexcept {
+            m_Range.store(Pack(begin, end), std::memory_order_release);
+        }
+
+        /// Owner side: takes the next match.
+        bool Pop(uint32_t& match) noexcept {
+            uint64_t range = m_Range.load(std::memory_order_acquire);
+            for (;;) {
+                const uint32_t begin = GetBegin(range);
+                const uint32_t end   = GetEnd(range);
+                if (begin >= end)
+                    return false;
+                if (m_Range.compare_exchange_weak(range, Pack(begin + 1, end))) {
+                    match = begin;
+                    return true;
+                }
+            }
+        }
+
+        /// Thief side: takes the back half of what is left, all of it if only one match is.
+        bool Steal(uint32_t& begin, uint32_t& end) noexcept {
+            uint64_t range = m_Range.load(std::memory_order_acquire);
+            for (;;) {
+                const uint32_t first = GetBegin(range);
+                const uint32_t last  = GetEnd(range);
+                if (first >= last)
+                    return false;
+                const uint32_t middle = first + (last - first) / 2;
+                if (m_Range.compare_exchange_weak(range, Pack(first, middle))) {
+                    begin = middle;
+                    end   = last;
+                    return true;
+                }
+            }
+        }
+
+    private:
+        static uint64_t Pack(const uint32_t begin, const uint32_t end) noexcept {
+            return uint64_t {begin} << 32 | end;
+        }
+        static uint32_t GetBegin(const uint64_t range) noexcept {
+            return static_cast<uint32_t>(range >> 32);
+        }
+        static uint32_t GetEnd(const uint64_t range) noexcept {
+            return static_cast<uint32_t>(range);
+        }
+
+        std::atomic<uint64_t> m_Range {0};
+    };
+
+    std::vector<AiConfig> GetDefaultConfigs() {
+        const AiSettings standard;
+        std::vector<AiConfig> configs = {
+          {"default", standard},
+          {"sluggish", standard},
+          {"quick", standard},
+          {"twitchy", standard},
+          {"short-sighted", standard},
+          {"precise", standard},
+        };
+        configs[1].settings.maxAxis   = 0.5f;
+        configs[2].settings.maxAxis   = 1.f;
+        configs[3].settings.deadZone  = 6.f;
+        configs[4].settings.reach     = kCourtWidth * 0.3f;
+        configs[5].settings.aimSpread = 0.2f;
+        return configs;
+    }
+
+    std::vector<AiConfig> LoadConfigs(const std::string& path) {
+        std::ifstream file(path);
+        if (!file)
+            throw std::runtime_error("Failed to open " + path);
+
+        std::vector<AiConfig> configs;
+        std::string line;
+        for (uint32_t lineNumber = 1; std::getline(file, line); ++lineNumber) {
+            std::istringstream fields(line);
+            AiConfig config;
+            if (!(fields >> config.name) || config.name[0] == '#')
+                continue;
+            AiSettings& s = config.settings;
+            if (!(fields >> s.maxAxis >> s.deadZone >> s.reach >> s.aimSpread) ||
+                s.deadZone <= 0.f)
+                throw std::runtime_error(path + ":" + std::to_string(lineNumber) +
+                                         ": expected name maxAxis deadZone reach aimSpread");
+            configs.push_back(std::move(config));
+        }
+        return configs;
+    }
+
+    /// The serve seed shared by both orderings of every pair in a round (SplitMix64's finalizer).
+    uint32_t GetRoundSeed(const uint32_t seed, const uint32_t round) noexcept {
+        uint64_t x = (uint64_t {seed} << 32 | round) + 0x9E3779B97F4A7C15;
+        x          = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+        x          = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+        return static_cast<uint32_t>(x ^ (x >> 31));
+    }
+
+    void PlayMatches(const TournamentOptions& options,
+                     const std::vector<AiConfig>& configs,
+                     std::vector<MatchRange>& ranges,
+                     const uint32_t self,
+                     Accumulator& accumulator) {
+        const auto configCount = static_cast<uint32_t>(configs.size());
+        const uint32_t pairs   = configCount * (configCount - 1);
+        const auto threads     = static_cast<uint32_t>(ranges.size());
+        Sim sim(nullptr);  // reset for every match
+
+        for (;;) {
+            uint32_t match;
+            if (!ranges[self].Pop(match)) {
+                // Out of work: split off part of another thread's range, nearest first
+                uint32_t begin = 0;
+                uint32_t end   = 0;
+                bool stolen    = false;
+                for (uint32_t k = 1; k < threads && !stolen; ++k)
+                    stolen = ranges[(self + k) % threads].Steal(begin, end);
+                if (!stolen)
+                    return;
+                ranges[self].Set(begin, end);
+                ++accumulator.steals;
+                continue;
+            }
+
+            // Matches run pair by pair within a round, so any slice of the range is a mix
+            const uint32_t round = match / pairs;
+            const uint32_t pair  = match % pairs;
+            const uint32_t left  = pair / (configCount - 1);
+            uint32_t right       = pair % (configCount - 1);
+            right += right >= left;
+
+            SimOptions simOptions;
+            simOptions.leftAi          = true;
+            simOptions.rightAi         = true;
+            simOptions.seed            = GetRoundSeed(options.seed, round);
+            simOptions.breakout        = options.breakout;
+            simOptions.leftAiSettings  = configs[left].settings;
+            simOptions.rightAiSettings = configs[right].settings;
+            sim.Reset(simOptions);
+
+            uint32_t ticks = 0;
+            while (ticks < options.maxTicks && sim.GetScore().left < options.points &&
+                   sim.GetScore().right < options.points) {
+                sim.Step({}, kTick);
+                ++ticks;
+            }
+
+            const Score& score = sim.GetScore();
+            PairResult& result = accumulator.pairs[size_t {left} * configCount + right];
+            if (score.left > score.right)
+                ++result.leftWins;
+            else if (score.right > score.left)
+                ++result.rightWins;
+            else
+                ++result.draws;
+            ++accumulator.matches;
+            accumulator.ticks += ticks;
+        }
+    }
+
+    /// Bradley-Terry strengths by minorization-maximization, then converted to Elo.
+    std::vector<Rating> RateConfigs(const std::vector<PairResult>& pairs, const uint32_t count) {
+        // Games and score (wins plus half the draws) between each pair, in both directions
+        std::vector<double> games(size_t {count} * count);
+        std::vector<double> scores(size_t {count} * count);
+        std::vector<Rating> ratings(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            for (uint32_t j = 0; j < count; ++j) {
+                if (i == j)
+                    continue;
+                const PairResult& home = pairs[size_t {i} * count + j];
+                const PairResult& away = pairs[size_t {j} * count + i];
+                const double wins      = home.leftWins + away.rightWins;
+                const double losses    = home.rightWins + away.leftWins;
+                const double draws     = home.draws + away.draws;
+                games[i * count + j]   = wins + losses + draws + kPriorDraws;
+                scores[i * count + j]  = wins + (draws + kPriorDraws) * 0.5;
+                ratings[i].wins += wins;
+                ratings[i].draws += draws;
+                ratings[i].losses += losses;
+            }
+        }
+
+        std::vector<double> strength(count, 1.0);
+        std::vector<double> next(count);
+        for (int iteration = 0; iteration < 10000; ++iteration) {
+            double change = 0.0;
+            for (uint32_t i = 0; i < count; ++i) {
+                double score = 0.0;
+                double denom = 0.0;
+                for (uint32_t j = 0; j < count; ++j) {
+                    if (i == j)
+                        continue;
+                    score += scores[i * count + j];
+                    denom += games[i * count + j] / (strength[i] + strength[j]);
+                }
+                next[i] = score / denom;
+            }
+
+            // Fix the geometric mean at 1, so the Elo ratings average 0
+            double logMean = 0.0;
+            for (const double s : next)
+                logMean += std::log(s);
+            logMean /= count;
+            for (uint32_t i = 0; i < count; ++i) {
+                const double s = next[i] / std::exp(logMean);
+                change         = std::max(change, std::abs(std::log(s / strength[i])));
+                strength[i]    = s;
+            }
+            if (change < 1e-12)
+                break;
+        }
+
+        // Standard errors from the diagonal of the Fisher information, in natural log units
+        const double eloPerLog = 400.0 / std::log(10.0);
+        for (uint32_t i = 0; i < count; ++i) {
+            double information = 0.0;
+            for (uint32_t j = 0; j < count; ++j) {
+                if (i == j)
+                    continue;
+                const double p = strength[i] / (strength[i] + strength[j]);
+                information += games[i * count + j] * p * (1.0 - p);
+            }
+            ratings[i].elo      = eloPerLog * std::log(strength[i]);
+            ratings[i].interval = eloPerLog * 1.96 / std::sqrt(information);
+        }
+        return ratings;
+    }
+
+    /// FNV-1a over the merged results, to compare runs with different thread counts.
+    uint64_t HashResults(const std::vector<PairResult>& pairs) {
+        uint64_t hash = Hash::kFnvOffset;
+        for (const PairResult& pair : pairs) {
+            const uint32_t values[] = {pair.leftWins, pair.draws, pair.rightWins};
+            hash                    = Hash::Fnv1a(std::as_bytes(std::span(values)), hash);
+        }
+        return hash;
+    }
+
+    void WriteRatings(const std::string& path,
+                      const std::vector<AiConfig>& configs,
+                      const std::vector<Rating>& ratings,
+                      const uint64_t matches,
+                      const uint32_t seed) {
+        FILE* pFile = std::fopen(path.c_str(), "w");
+        if (!pFile)
+            throw std::runtime_error("Failed to create " + path);
+        std::fprintf(pFile,
+                     "{\n  \"seed\": %u,\n  \"matches\": %llu,\n  \"ratings\": [\n",
+                     seed,
+                     static_cast<unsigned long long>(matches));
+        for (size_t i = 0; i < configs.size(); ++i) {
+            const Rating& r = ratings[i];
+            std::fprintf(pFile,
+                         "    {\"name\": \"%s\", \"elo\": %.1f, \"ci95\": %.1f, \"wins\": %.0f, "
+                         "\"draws\": %.0f, \"losses\": %.0f}%s\n",
+                         configs[i].name.c_str(),
+                         r.elo,
+                         r.interval,
+                         r.wins,
+                         r.draws,
+                         r.losses,
+                         i + 1 < configs.size() ? "," : "");
+        }
+        std::fprintf(pFile, "  ]\n}\n");
+        if (std::fclose(pFile) != 0)
+            throw std::runtime_error("Failed to write " + path);
+    }
+
+    TournamentOptions ParseOptions(CommandLine& commandLine) {
+        TournamentOptions options;
+        options.rounds   = commandLine.GetNumber("rounds", options.rounds);
+        options.points   = commandLine.GetNumber("points", options.points);
+        options.maxTicks = commandLine.GetNumber("max-ticks", options.maxTicks);
+        options.seed     = commandLine.GetNumber("seed", options.seed);
+        options.threads  = commandLine.GetNumber("threads", options.threads);
+        options.breakout = commandLine.HasFlag("breakout");
+        options.configs  = commandLine.GetString("configs", "");
+        options.out      = commandLine.GetString("out", "");
+        commandLine.CheckUnknown();
+        if (!commandLine.GetPositional().empty())
+            throw std::invalid_argument("Unexpected argument " + commandLine.GetPositional()[0]);
+        if (options.rounds == 0 || options.points <= 0 || options.threads == 0)
+            throw std::invalid_argument("--rounds, --points and --threads must be at least 1");
+        return options;
+    }
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        CommandLine commandLine(argc, argv);
+        const TournamentOptions options = ParseOptions(commandLine);
+        const std::vector<AiConfig> configs =
+          options.configs.empty() ? GetDefaultConfigs() : LoadConfigs(options.configs);
+        if (configs.size() < 2)
+            throw std::invalid_argument("A tournament needs at least two configurations");
+
+        const auto count     = static_cast<uint32_t>(configs.size());
+        const uint64_t total = uint64_t {options.rounds} * count * (count - 1);
+        if (total > UINT32_MAX)
+            throw std::invalid_argument("Too many matches; use fewer rounds");
+        const auto matches     = static_cast<uint32_t>(total);
+        const uint32_t threads = std::min(options.threads, matches);
+
+        std::vector<MatchRange> ranges(threads);
+        std::vector<Accumulator> accumulators(threads);
+        for (uint32_t t = 0; t < threads; ++t) {
+            ranges[t].Set(static_cast<uint32_t>(uint64_t {matches} * t / threads),
+                          static_cast<uint32_t>(uint64_t {matches} * (t + 1) / threads));
+            accumulators[t].pairs.resize(size_t {count} * count);
+        }
+
+        std::printf("%u configurations, %u matches on %u threads\n", count, matches, threads);
+        const auto start = Clock::now();
+        std::vector<std::thread> workers;
+        for (uint32_t t = 0; t < threads; ++t)
+            workers.emplace_back(
+              [&, t] { PlayMatches(options, configs, ranges, t, accumulators[t]); });
+        for (auto& worker : workers)
+            worker.join();
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::vector<PairResult> merged(size_t {count} * count);
+        uint64_t ticks  = 0;
+        uint32_t steals = 0;
+        for (const Accumulator& accumulator : accumulators) {
+            for (size_t i = 0; i < merged.size(); ++i) {
+                merged[i].leftWins += accumulator.pairs[i].leftWins;
+                merged[i].draws += accumulator.pairs[i].draws;
+                merged[i].rightWins += accumulator.pairs[i].rightWins;
+            }
+            ticks += accumulator.ticks;
+            steals += accumulator.steals;
+        }
+
+        const std::vector<Rating> ratings = RateConfigs(merged, count);
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b) {
+            return ratings[a].elo > ratings[b].elo;
+        });
+
+        std::printf("%.1f s, %.0f matches/s, %.1fM sim ticks/s, %u steals\n\n",
+                    seconds,
+                    matches / seconds,
+                    static_cast<double>(ticks) / seconds * 1e-6,
+                    steals);
+        std::printf("rank  %-16s %8s %8s %8s %8s %8s %7s\n",
+                    "config",
+                    "elo",
+                    "+/-95%",
+                    "wins",
+                    "draws",
+                    "losses",
+                    "score");
+        for (uint32_t rank = 0; rank < count; ++rank) {
+            const uint32_t i = order[rank];
+            const Rating& r  = ratings[i];
+            const double n   = r.wins + r.draws + r.losses;
+            std::printf("%4u  %-16s %8.1f %8.1f %8.0f %8.0f %8.0f %6.1f%%\n",
+                        rank + 1,
+                        configs[i].name.c_str(),
+                        r.elo,
+                        r.interval,
+                        r.wins,
+                        r.draws,
+                        r.losses,
+                        n > 0.0 ? (r.wins + r.draws * 0.5) / n * 100.0 : 0.0);
+        }
+        std::printf("\nresults hash %016llx\n",
+                    static_cast<unsigned long long>(HashResults(merged)));
+
+        if (!options.out.empty())
+            WriteRatings(options.out, configs, ratings, matches, options.seed);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "PongTournament: %s\n", e.what());
+        return kExitError;
+    }
+    return 0;
+}